@@ -0,0 +1,108 @@
+/*
+ * 电池电压检测与占空比补偿模块
+ * 功能：调度器每BATTERY_SAMPLE_PERIOD_MS读一次分压后的电池电压并做指数平滑，
+ *       供OLED和遥测显示电量；电机占空比按标称电压/实际电压放大，
+ *       电池从满电放到亏电的过程中车速保持不变，寻迹和避障参数不随电量漂移
+ */
+
+#include <stdio.h>
+
+#include "hi_adc.h"
+
+#include "robot_battery.h"
+#include "robot_l9110s.h"
+#include "robot_sched.h"
+
+#define BATTERY_ADC_CHANNEL         HI_ADC_CHANNEL_1    // GPIO4
+
+static volatile float g_battery_voltage = 0.0f;     // 平滑后的电压，0表示无效
+static volatile float g_battery_scale = 1.0f;       // 占空比补偿系数
+static int g_battery_job = -1;
+
+// 读BATTERY_SAMPLE_READS次取平均，换算为电池端电压，读失败返回-1
+static float battery_read(void)
+{
+    unsigned int sum = 0;
+    unsigned short code;
+
+    for (int i = 0; i < BATTERY_SAMPLE_READS; i++) {
+        if (hi_adc_read(BATTERY_ADC_CHANNEL, &code, HI_ADC_EQU_MODEL_4, HI_ADC_CUR_BAIS_DEFAULT, 0xF0) != 0) {
+            return -1.0f;
+        }
+        sum += code;
+    }
+    // 码字 * 1.8 * 4 / 4096 为ADC引脚电压
+    return (float)sum / BATTERY_SAMPLE_READS * 1.8f * 4 / 4096.0f * BATTERY_DIVIDER;
+}
+
+static void battery_sample(void)
+{
+    float voltage = battery_read();
+
+    if (voltage < BATTERY_MIN_VALID_V || voltage > BATTERY_MAX_VALID_V) {
+        g_battery_voltage = 0.0f;
+        g_battery_scale = 1.0f;
+        return;
+    }
+    // 第一次有效采样直接作为初值，之后指数平滑，滤掉电机电流引起的跌落
+    if (g_battery_voltage <= 0.0f) {
+        g_battery_voltage = voltage;
+    } else {
+        g_battery_voltage += BATTERY_FILTER_ALPHA * (voltage - g_battery_voltage);
+    }
+
+    float scale = BATTERY_NOMINAL_V / g_battery_voltage;
+    if (scale > BATTERY_COMP_MAX) {
+        scale = BATTERY_COMP_MAX;
+    } else if (scale < BATTERY_COMP_MIN) {
+        scale = BATTERY_COMP_MIN;
+    }
+    g_battery_scale = scale;
+}
+
+static const SchedJobConfig g_battery_config = {
+    "battery", battery_sample, BATTERY_SAMPLE_PERIOD_MS, 0, BATTERY_SAMPLE_PRIORITY, SCHED_CTX_TASK,
+    BATTERY_SAMPLE_BUDGET_US
+};
+
+void battery_start(void)
+{
+    if (g_battery_job >= 0) {
+        return;
+    }
+    g_battery_job = sched_add(&g_battery_config);
+    if (g_battery_job < 0) {
+        printf("[battery] Failed to add sched job!\n");
+        return;
+    }
+    sched_enable(g_battery_job, 1);
+}
+
+float battery_get_voltage(void)
+{
+    return g_battery_voltage;
+}
+
+int battery_get_percent(void)
+{
+    float voltage = g_battery_voltage;
+
+    if (voltage <= 0.0f) {
+        return -1;
+    }
+    int percent = (int)((voltage - BATTERY_EMPTY_V) * 100.0f / (BATTERY_FULL_V - BATTERY_EMPTY_V) + 0.5f);
+    if (percent < 0) {
+        return 0;
+    }
+    return (percent > 100) ? 100 : percent;
+}
+
+unsigned short battery_compensate(unsigned short duty)
+{
+#if BATTERY_COMPENSATE
+    float compensated = duty * g_battery_scale;
+    return (compensated > PWM_DUTY_MAX) ? PWM_DUTY_MAX : (unsigned short)(compensated + 0.5f);
+#else
+    return duty;
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef ROBOT_BATTERY_H
+#define ROBOT_BATTERY_H
+
+// 电池电压检测：电池经分压电阻接到GPIO4(ADC通道1)，调度器周期采样并做指数平滑
+#define BATTERY_DIVIDER             (3.0f)      // 分压比，20k/10k分压，满电8.4V时ADC引脚2.8V
+#define BATTERY_NOMINAL_V           (7.4f)      // 2节锂电池标称电压，占空比和车速按该电压标定
+#define BATTERY_FULL_V              (8.4f)      // 电量100%
+#define BATTERY_EMPTY_V             (6.4f)      // 电量0%
+#define BATTERY_MIN_VALID_V         (4.0f)      // 低于该值视为没有接分压电路(如USB供电)，不做补偿
+// GPIO4兼作UART0 RX，没接分压电路时空闲为3.3V高电平，折合9.9V，不能当作满电
+#define BATTERY_MAX_VALID_V         (BATTERY_FULL_V + 0.5f)     // 高于该值视为读到的不是电池，不做补偿
+#define BATTERY_FILTER_ALPHA        (0.1f)      // 平滑系数，100ms采样时时间常数约1s
+#define BATTERY_SAMPLE_READS        (4)         // 每次采样读ADC的次数，取平均
+#define BATTERY_SAMPLE_PERIOD_MS    (100)
+#define BATTERY_SAMPLE_BUDGET_US    (2000)
+#define BATTERY_SAMPLE_PRIORITY     (15)
+#define BATTERY_COMP_MAX            (1.25f)     // 补偿系数上限，防止读数异常时占空比翻倍
+#define BATTERY_COMP_MIN            (BATTERY_NOMINAL_V / BATTERY_FULL_V)    // 补偿系数下限，即满电时的系数
+#define BATTERY_COMPENSATE          (1)         // 1-按电压补偿电机占空比，0-直接输出
+
+/**
+ * @brief 注册电池采样作业并开始采样，重复调用无副作用
+ */
+void battery_start(void);
+
+/**
+ * @brief 获取平滑后的电池电压(V)
+ * @return 电压，尚未采样、没有接分压电路或读数超出合理范围时返回0
+ */
+float battery_get_voltage(void);
+
+/**
+ * @brief 获取电量百分比，按BATTERY_EMPTY_V~BATTERY_FULL_V线性估算
+ * @return 0~100，电压无效时返回-1
+ */
+int battery_get_percent(void);
+
+/**
+ * @brief 按标称电压/实际电压放大占空比，使电机两端平均电压与标定时一致
+ * @param duty 标定电压下的占空比
+ * @return 补偿后的占空比，不超过PWM_DUTY_MAX；电压无效时原样返回
+ */
+unsigned short battery_compensate(unsigned short duty);
+
+#endif // ROBOT_BATTERY_H
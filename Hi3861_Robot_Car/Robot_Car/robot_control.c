@@ -1,361 +1,830 @@
-/*
- * 鸿蒙WiFi小车控制程序
- * 功能：通过按键控制小车模式切换，支持停止、寻迹、避障、远程控制等模式
- * 包含超声波避障、红外寻迹、UDP远程控制等功能
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <memory.h>
-
-// 鸿蒙系统相关头文件
-#include "ohos_init.h"
-#include "cmsis_os2.h"
-
-// GPIO和硬件控制相关头文件
-#include "iot_gpio.h"
-#include "hi_io.h"
-#include "hi_time.h"
-#include "hi_adc.h"
-#include "iot_errno.h"
-
-// 小车控制相关头文件
-#include "robot_control.h"
-#include "robot_l9110s.h"
-#include "udp_control.h"
-
-// GPIO和硬件配置宏定义
-#define GPIO5 5                         // 按键GPIO引脚号
-#define FUNC_GPIO 0                     // GPIO功能选择
-#define ADC_TEST_LENGTH (20)            // ADC采样次数
-#define VLT_MIN (100)                   // 最小电压值
-#define OLED_FALG_ON ((unsigned char)0x01)   // OLED开启标志
-#define OLED_FALG_OFF ((unsigned char)0x00)  // OLED关闭标志
-
-// 全局变量定义
-unsigned short  g_adc_buf[ADC_TEST_LENGTH] = { 0 };        // ADC缓存数组
-unsigned short  g_gpio5_adc_buf[ADC_TEST_LENGTH] = { 0 };  // GPIO5 ADC缓存数组
-unsigned int  g_gpio5_tick = 0;                            // GPIO5按键时间戳，用于消抖
-unsigned char   g_car_control_mode = 0;                    // 小车控制模式
-unsigned char   g_car_speed_control = 0;                   // 小车速度控制
-unsigned int  g_car_control_demo_task_id = 0;              // 小车控制任务ID
-unsigned char   g_car_status = CAR_STOP_STATUS;            // 小车当前状态
-int udp_thread_created = 0;                                // UDP线程创建标志
-
-// 外部函数声明
-extern float GetDistance(void);         // 获取超声波测距距离
-extern void trace_module(void);         // 红外寻迹模块
-extern void car_backward(void);         // 小车后退
-extern void car_forward(void);          // 小车前进  
-extern void car_left(void);             // 小车左转
-extern void car_right(void);            // 小车右转
-extern void car_stop(void);             // 小车停止
-extern void engine_turn_left(void);     // 舵机左转
-extern void engine_turn_right(void);    // 舵机右转
-extern void regress_middle(void);       // 舵机归中
-extern unsigned int MOVING_STATUS;      // 小车运动状态
-
-/**
- * @brief 按键开关初始化
- * @note 配置GPIO5为输入模式，用于按键检测
- */
-void switch_init(void)
-{
-    IoTGpioInit(5);                      // 初始化GPIO5
-    hi_io_set_func(5, 0);               // 设置GPIO5功能为普通GPIO
-    IoTGpioSetDir(5, IOT_GPIO_DIR_IN);   // 设置GPIO5为输入模式
-    hi_io_set_pull(5, 1);               // 设置GPIO5上拉
-}
-
-/**
- * @brief 按键中断响应函数 - 小车模式切换
- * @note 通过按键切换小车的四种工作模式：停止->寻迹->避障->远控->停止
- *       使用时间戳进行按键消抖处理
- */
-void gpio5_isr_func_mode(void)
-{
-    printf("gpio5_isr_func_mode start\n");
-    unsigned int tick_interval = 0;
-    unsigned int current_gpio5_tick = 0; 
-
-    // 获取当前时间戳
-    current_gpio5_tick = hi_get_tick();
-    tick_interval = current_gpio5_tick - g_gpio5_tick;
-    
-    // 按键消抖处理，避免重复触发
-    if (tick_interval < KEY_INTERRUPT_PROTECT_TIME) {  
-        return NULL;
-    }
-    g_gpio5_tick = current_gpio5_tick;
-
-    // 小车模式状态机切换
-    if (g_car_status == CAR_STOP_STATUS) {                
-        g_car_status = CAR_TRACE_STATUS;                 // 切换到寻迹模式       
-        printf("trace\n");
-    } else if (g_car_status == CAR_TRACE_STATUS) {       
-        g_car_status = CAR_OBSTACLE_AVOIDANCE_STATUS;   // 切换到避障模式
-        printf("ultrasonic\n");
-    } else if (g_car_status == CAR_OBSTACLE_AVOIDANCE_STATUS) {                           
-        g_car_status = CAR_CONTROL_STATUS;                 // 切换到远程控制模式
-        printf("control\n");
-    } else if (g_car_status == CAR_CONTROL_STATUS) {    
-        g_car_status = CAR_STOP_STATUS;                    // 切换到停止模式
-        printf("stop\n");
-    }
-}
-
-/**
- * @brief 获取GPIO5电压值并处理按键事件
- * @param param 参数（未使用）
- * @return 无返回值
- * @note 通过ADC读取GPIO5电压值，根据不同电压范围执行不同操作：
- *       - 0.01V~0.3V：执行模式切换
- *       - 0.6V~1.5V：调整小车前进速度
- */
-unsigned char get_gpio5_voltage(void *param)
-{
-    int i;
-    unsigned short data;
-    unsigned int ret;
-    unsigned short vlt;
-    float voltage;
-    float vlt_max = 0;
-    float vlt_min = VLT_MIN;
-
-    hi_unref_param(param);
-    // 清空ADC缓存数组
-    memset_s(g_gpio5_adc_buf, sizeof(g_gpio5_adc_buf), 0x0, sizeof(g_gpio5_adc_buf));
-    
-    // 连续采样ADC_TEST_LENGTH次
-    for (i = 0; i < ADC_TEST_LENGTH; i++) {
-        ret = hi_adc_read(HI_ADC_CHANNEL_2, &data, HI_ADC_EQU_MODEL_4, HI_ADC_CUR_BAIS_DEFAULT, 0xF0); 
-        // ADC_Channal_2 自动识别模式，4次平均算法模式
-        if (ret != IOT_SUCCESS) {
-            printf("ADC Read Fail\n");
-            return  NULL;
-        }    
-        g_gpio5_adc_buf[i] = data;
-    }
-
-    // 计算电压值并找出最大最小值
-    for (i = 0; i < ADC_TEST_LENGTH; i++) {  
-        vlt = g_gpio5_adc_buf[i]; 
-        voltage = (float)vlt * 1.8 * 4 / 4096.0;  
-        // vlt * 1.8 * 4 / 4096.0为将码字转换为电压值
-        vlt_max = (voltage > vlt_max) ? voltage : vlt_max;
-        vlt_min = (voltage < vlt_min) ? voltage : vlt_min;
-    }
-    
-    // 根据电压范围执行不同操作
-    if (vlt_max > 0.01 && vlt_max < 0.3) {
-        // 电压范围0.01V~0.3V：执行模式切换
-        gpio5_isr_func_mode();
-    } else if(vlt_max > 0.6 && vlt_max < 1.5){
-        // 电压范围0.6V~1.5V：调整小车前进速度
-        if (SPEED_FORWARD <= 7000) {
-            SPEED_FORWARD += 1000;  // 增加速度
-        } else {
-            SPEED_FORWARD = 4000;   // 重置为初始速度
-        }
-    }
-}
-
-
-
-/**
- * @brief 按键中断监控初始化
- * @note 注册GPIO5的中断处理函数，设置为下降沿触发
- */
-void interrupt_monitor(void)
-{
-    unsigned int  ret = 0;
-    g_gpio5_tick = hi_get_tick();  // 初始化时间戳
-    // 注册GPIO5中断服务函数，下降沿触发
-    ret = IoTGpioRegisterIsrFunc(GPIO5, IOT_INT_TYPE_EDGE, IOT_GPIO_EDGE_FALL_LEVEL_LOW, get_gpio5_voltage, NULL);
-    if (ret == IOT_SUCCESS) {
-        printf(" register gpio5\r\n");
-    }
-}
-
-/**
- * @brief 舵机转向检测功能 - 确定最佳转向方向
- * @return 返回转向方向：CAR_TURN_LEFT 或 CAR_TURN_RIGHT
- * @note 通过控制舵机左右转动，测量两侧障碍物距离，选择距离更远的方向
- */
-static unsigned int engine_go_where(void)
-{
-    float left_distance = 0;
-    float right_distance = 0;
-    
-    // 舵机往左转动测量左边障碍物的距离
-    engine_turn_left();
-    hi_sleep(100);              // 等待舵机转动到位
-    left_distance = GetDistance();
-    hi_sleep(100);
-
-    // 舵机归中
-    regress_middle();
-    hi_sleep(100);
-
-    // 舵机往右转动测量右边障碍物的距离
-    engine_turn_right();
-    hi_sleep(100);              // 等待舵机转动到位
-    right_distance = GetDistance();
-    hi_sleep(100);
-
-    // 舵机归中
-    regress_middle();
-    
-    // 选择距离更远的方向作为转向方向
-    if (left_distance > right_distance) {
-        return CAR_TURN_LEFT;   // 左侧距离更远，选择左转
-    } else {
-        return CAR_TURN_RIGHT;  // 右侧距离更远，选择右转
-    }
-}
-
-/**
- * @brief 小车避障行为控制函数
- * @param distance 前方障碍物距离（厘米）
- * @note 避障逻辑：
- *       1. 距离>=20cm：继续前进
- *       2. 距离<20cm：停止->后退0.5s->测距判断->选择转向->转向0.75s->停止
- */
-static void car_where_to_go(float distance)
-{
-    if (distance < DISTANCE_BETWEEN_CAR_AND_OBSTACLE) {
-        // 距离小于安全距离，执行避障操作
-        car_stop();         // 立即停止
-        MOVING_STATUS = 0;
-        hi_sleep(500);
-        
-        car_backward();     // 后退避让
-        MOVING_STATUS = 5;
-        hi_sleep(500);
-        
-        car_stop();         // 停止后退
-        MOVING_STATUS = 0;
-        
-        // 通过舵机测距选择最佳转向方向
-        unsigned int ret = engine_go_where();
-        printf("ret is %d\r\n", ret);
-        
-        if (ret == CAR_TURN_LEFT) {
-            car_left();     // 左转避障
-            MOVING_STATUS = 2;
-            hi_sleep(750);  // 转向持续时间
-        } else if (ret == CAR_TURN_RIGHT) {
-            car_right();    // 右转避障
-            MOVING_STATUS = 1;
-            hi_sleep(750);  // 转向持续时间
-        }
-        car_stop();         // 转向完成后停止
-        MOVING_STATUS = 0;
-    } else {
-        // 距离足够，继续前进
-        car_forward();
-        MOVING_STATUS = 3;
-    } 
-}
-
-/**
- * @brief 小车避障模式控制函数
- * @note 在避障模式下持续运行，通过超声波传感器获取距离并执行避障逻辑
- *       当模式切换时自动退出并将舵机归中
- */
-void car_mode_control_func(void)
-{
-    pwm_init();                 // 初始化PWM，用于舵机控制
-    float m_distance = 0.0;
-    regress_middle();          // 舵机归中
-    
-    while (1) {
-        // 检查是否还在避障模式
-        if (g_car_status != CAR_OBSTACLE_AVOIDANCE_STATUS) {
-            printf("car_mode_control_func 1 module changed\n");
-            regress_middle();   // 退出前舵机归中
-            break;
-        }
-
-        // 获取前方物体的距离
-        m_distance = GetDistance();
-        // printf("m_distance = %f\n",m_distance);
-        
-        // 根据距离执行避障逻辑
-        car_where_to_go(m_distance);
-        hi_sleep(20);          // 短暂延时，避免CPU占用过高
-    }
-}
-
-/**
- * @brief 小车主控制任务函数
- * @param param 任务参数（未使用）
- * @return 无返回值
- * @note 主任务循环，根据g_car_status状态执行不同的控制逻辑：
- *       - CAR_STOP_STATUS: 停止状态
- *       - CAR_OBSTACLE_AVOIDANCE_STATUS: 超声波避障模式
- *       - CAR_TRACE_STATUS: 红外寻迹模式
- *       - CAR_CONTROL_STATUS: UDP远程控制模式
- */
-void *RobotCarTestTask(void* param)
-{
-    printf("switch\r\n");
-    switch_init();              // 初始化按键开关
-    interrupt_monitor();        // 初始化按键中断监控
-
-    // 在启动时创建UDP线程用于远程控制
-    if (!udp_thread_created) {
-        start_udp_thread();
-        udp_thread_created = 1;
-        printf("UDP thread started at startup\r\n");
-    }
-
-    while (1) {
-        // 根据当前状态执行相应的控制逻辑
-        switch (g_car_status) {
-            case CAR_STOP_STATUS:
-                car_stop();     // 停止状态：小车停止
-                break;
-            case CAR_OBSTACLE_AVOIDANCE_STATUS:
-                car_mode_control_func();    // 避障模式：执行超声波避障
-                break;
-            case CAR_TRACE_STATUS:
-                trace_module();             // 寻迹模式：执行红外寻迹
-                break;
-            case CAR_CONTROL_STATUS:
-                // 远控模式：不在这里执行car_stop()，避免与UDP控制指令冲突
-                // UDP控制指令会直接控制小车，这里只需要等待
-                break;
-            default:
-                break;
-        }
-        IoTWatchDogDisable();   // 关闭看门狗
-        osDelay(20);            // 任务延时20ms
-    }
-}
-
-/**
- * @brief 小车演示程序入口函数
- * @note 创建小车控制主任务，配置任务属性并启动
- */
-void RobotCarDemo(void)
-{
-    osThreadAttr_t attr;
-
-    // 配置任务属性
-    attr.name = "RobotCarTestTask";     // 任务名称
-    attr.attr_bits = 0U;               // 任务属性位
-    attr.cb_mem = NULL;                // 控制块内存
-    attr.cb_size = 0U;                 // 控制块大小
-    attr.stack_mem = NULL;             // 栈内存
-    attr.stack_size = 10240;           // 栈大小10KB
-    attr.priority = 25;                // 任务优先级
-
-    // 创建小车控制主任务
-    if (osThreadNew(RobotCarTestTask, NULL, &attr) == NULL) {
-        printf("[Ssd1306TestDemo] Falied to create RobotCarTestTask!\n");
-    }
-}
-
-// 系统启动时自动初始化小车演示程序
+/*
+ * 鸿蒙WiFi小车控制程序
+ * 功能：通过按键控制小车模式切换，支持停止、寻迹、避障、远程控制等模式
+ * 包含超声波避障、红外寻迹、UDP远程控制等功能
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+// 鸿蒙系统相关头文件
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+
+// GPIO和硬件控制相关头文件
+#include "iot_gpio.h"
+#include "hi_io.h"
+#include "hi_time.h"
+#include "hi_adc.h"
+#include "iot_errno.h"
+
+// 小车控制相关头文件
+#include "robot_battery.h"
+#include "robot_control.h"
+#include "robot_key.h"
+#include "robot_l9110s.h"
+#include "robot_scan.h"
+#include "robot_sched.h"
+#include "robot_sg90.h"
+#include "robot_ttc.h"
+#include "robot_vfh.h"
+#include "udp_control.h"
+
+// GPIO和硬件配置宏定义
+#define GPIO5 5                         // 按键GPIO引脚号
+#define FUNC_GPIO 0                     // GPIO功能选择
+#define OLED_FALG_ON ((unsigned char)0x01)   // OLED开启标志
+#define OLED_FALG_OFF ((unsigned char)0x00)  // OLED关闭标志
+#define BUTTON_EVENT_PRESS (1 << 0)         // GPIO5下降沿
+#define CAR_STATE_EVENT_CHANGED (1 << 0)    // 状态版本号变化
+#define CAR_MODE_EVENT_TRACE    (1 << 0)    // 模式作业通知模式任务执行寻迹
+#define CAR_MODE_NONE           (-1)        // 模式作业还没有进入任何模式
+
+// 全局变量定义
+unsigned char   g_car_control_mode = 0;                    // 小车控制模式
+unsigned char   g_car_speed_control = 0;                   // 小车速度控制
+unsigned int  g_car_control_demo_task_id = 0;              // 小车控制任务ID
+unsigned char   g_car_status = CAR_STOP_STATUS;            // 小车当前状态
+int udp_thread_created = 0;                                // UDP线程创建标志
+static unsigned int g_scan_valid_after = 0;                // 只采用该时刻之后的扫描数据
+static osEventFlagsId_t g_button_event = NULL;             // 按键中断通知按键任务
+static volatile unsigned int g_button_isr_count = 0;       // 按键中断次数
+static volatile unsigned int g_button_isr_max_us = 0;      // 按键中断最长执行时间(us)
+static int g_guard_job = -1;                               // 远控碰撞保护作业
+static int g_telemetry_job = -1;                           // 遥测作业
+static int g_mode_job = -1;                                // 模式调度作业
+static osEventFlagsId_t g_mode_event = NULL;               // 模式作业通知模式任务
+static int g_mode_active = CAR_MODE_NONE;                  // 模式作业当前所处的模式
+static volatile int g_trace_running = 0;                   // 寻迹正在模式任务中执行
+static volatile unsigned int g_car_state_version = 0;      // 模式、速度和运动状态的版本号
+static osEventFlagsId_t g_car_state_event = NULL;          // 版本号变化时通知显示任务
+
+// 外部函数声明
+extern float GetDistance(void);         // 获取超声波测距距离
+extern void trace_module(void);         // 红外寻迹模块
+extern void car_backward(void);         // 小车后退
+extern void car_forward(void);          // 小车前进  
+extern void car_left(void);             // 小车左转
+extern void car_right(void);            // 小车右转
+extern void car_stop(void);             // 小车停止
+extern unsigned int MOVING_STATUS;      // 小车运动状态
+
+/**
+ * @brief 按键开关初始化
+ * @note 配置GPIO5为输入模式，用于按键检测
+ */
+void switch_init(void)
+{
+    IoTGpioInit(5);                      // 初始化GPIO5
+    hi_io_set_func(5, 0);               // 设置GPIO5功能为普通GPIO
+    IoTGpioSetDir(5, IOT_GPIO_DIR_IN);   // 设置GPIO5为输入模式
+    hi_io_set_pull(5, 1);               // 设置GPIO5上拉
+}
+
+// 状态变化：版本号加一并唤醒等待的显示任务，显示任务还没开始等待时只加版本号
+static void car_state_changed(void)
+{
+    g_car_state_version++;
+    if (g_car_state_event != NULL) {
+        osEventFlagsSet(g_car_state_event, CAR_STATE_EVENT_CHANGED);
+    }
+}
+
+void car_set_status(unsigned char status)
+{
+    if (g_car_status != status) {
+        g_car_status = status;
+        car_state_changed();
+    }
+}
+
+void car_set_speed(unsigned short speed)
+{
+    if (SPEED_FORWARD != speed) {
+        SPEED_FORWARD = speed;
+        car_state_changed();
+    }
+}
+
+void car_set_moving(unsigned int moving)
+{
+    if (MOVING_STATUS != moving) {
+        MOVING_STATUS = moving;
+        car_state_changed();
+    }
+}
+
+unsigned int car_state_version(void)
+{
+    return g_car_state_version;
+}
+
+unsigned int car_state_wait(unsigned int version, unsigned int timeout)
+{
+    if (g_car_state_event == NULL) {
+        g_car_state_event = osEventFlagsNew(NULL);
+        if (g_car_state_event == NULL) {
+            osDelay(timeout);
+            return g_car_state_version;
+        }
+    }
+    // 先清标志再比较，比较之后的变化一定会留下标志，不会漏掉
+    osEventFlagsClear(g_car_state_event, CAR_STATE_EVENT_CHANGED);
+    if (g_car_state_version == version) {
+        osEventFlagsWait(g_car_state_event, CAR_STATE_EVENT_CHANGED, osFlagsWaitAny, timeout);
+    }
+    return g_car_state_version;
+}
+
+// 模式键单击/双击时的循环顺序：停止->寻迹->避障->远控->停止，按住选择模式时也按该顺序计数
+static const unsigned char g_car_mode_cycle[] = {
+    CAR_STOP_STATUS, CAR_TRACE_STATUS, CAR_OBSTACLE_AVOIDANCE_STATUS, CAR_CONTROL_STATUS
+};
+static const char *g_car_mode_names[] = {"stop", "ultrasonic", "trace", "control"};  // 按CarStatus索引
+static int g_key_select = 0;        // 长按模式键后持续按住的次数，松开时直接进入对应模式，只在按键任务中访问
+
+/**
+ * @brief 直接进入循环顺序中的第index个模式，由按键任务调用
+ */
+static void car_select_mode(int index)
+{
+    int count = (int)sizeof(g_car_mode_cycle);
+
+    car_set_status(g_car_mode_cycle[index % count]);
+    printf("%s\n", g_car_mode_names[g_car_status]);
+}
+
+/**
+ * @brief 按循环顺序切换小车模式，由按键任务调用
+ * @param step 1-切换到下一个模式，-1-切换到上一个模式
+ */
+static void car_step_mode(int step)
+{
+    int count = (int)sizeof(g_car_mode_cycle);
+    int index = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (g_car_mode_cycle[i] == g_car_status) {
+            index = i;
+            break;
+        }
+    }
+    car_select_mode((index + step + count) % count);
+}
+
+/**
+ * @brief 紧急停车：立即停车并切换到停止模式，当前模式在下一次检查时退出
+ */
+static void car_emergency_stop(void)
+{
+    car_set_status(CAR_STOP_STATUS);
+    car_stop();
+    car_set_moving(0);
+    printf("emergency stop\n");
+}
+
+/**
+ * @brief 调整前进速度，限制在CAR_SPEED_MIN到PWM_DUTY_MAX之间
+ * @param step 1-加速一档，-1-减速一档
+ */
+static void car_step_speed(int step)
+{
+    int speed = (int)SPEED_FORWARD + step * CAR_SPEED_STEP;
+
+    if (speed > PWM_DUTY_MAX) {
+        speed = PWM_DUTY_MAX;
+    } else if (speed < CAR_SPEED_MIN) {
+        speed = CAR_SPEED_MIN;
+    }
+    car_set_speed((unsigned short)speed);
+    printf("speed %u\n", SPEED_FORWARD);
+}
+
+/**
+ * @brief 执行按键手势对应的操作
+ * @note 模式键：单击下一个模式，双击上一个模式；调速键：单击加速，双击减速；
+ *       任一键长按紧急停车；长按模式键后继续按住，每KEY_HOLD_STEP_MS依次选中寻迹、避障、远控、停止，
+ *       松开时直接进入选中的模式
+ */
+static void car_key_event(const KeyEvent *event)
+{
+    switch (event->type) {
+        case KEY_EVENT_CLICK:
+            if (event->key == KEY_ID_MODE) {
+                car_step_mode(1);
+            } else {
+                car_step_speed(1);
+            }
+            break;
+        case KEY_EVENT_DOUBLE:
+            if (event->key == KEY_ID_MODE) {
+                car_step_mode(-1);
+            } else {
+                car_step_speed(-1);
+            }
+            break;
+        case KEY_EVENT_LONG:
+            car_emergency_stop();
+            g_key_select = 0;
+            break;
+        case KEY_EVENT_HOLD:
+            if (event->key == KEY_ID_MODE) {
+                g_key_select++;
+                printf("select %s\n", g_car_mode_names[g_car_mode_cycle[g_key_select % sizeof(g_car_mode_cycle)]]);
+            }
+            break;
+        case KEY_EVENT_RELEASE:
+            if (event->key == KEY_ID_MODE && g_key_select > 0) {
+                car_select_mode(g_key_select);
+                g_key_select = 0;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief 按键中断服务函数
+ * @note 中断中只通知按键任务并统计自身耗时，ADC采样、打印和模式切换都在任务中完成，
+ *       避免长时间关中断影响1ms调度节拍和WiFi协议栈
+ */
+static void gpio5_isr(char *arg)
+{
+    unsigned long long begin = hi_get_us();
+
+    (void)arg;
+    osEventFlagsSet(g_button_event, BUTTON_EVENT_PRESS);
+    g_button_isr_count++;
+
+    unsigned int elapsed = (unsigned int)(hi_get_us() - begin);
+    if (elapsed > g_button_isr_max_us) {
+        g_button_isr_max_us = elapsed;
+    }
+}
+
+/**
+ * @brief 按键任务：空闲时等待按键中断，按住或等待双击期间每KEY_POLL_MS采样一次，
+ *       由手势状态机产生事件并执行对应操作
+ */
+static void button_task(void *arg)
+{
+    KeyEvent events[KEY_EVENTS_MAX];
+    unsigned int samples = 0;
+
+    (void)arg;
+    key_gesture_reset();
+    while (1) {
+        // tick为10ms
+        osEventFlagsWait(g_button_event, BUTTON_EVENT_PRESS, osFlagsWaitAny,
+                         key_gesture_busy() ? KEY_POLL_MS / 10 : osWaitForever);
+        KeyId key = key_sample(&samples);
+        int count = key_gesture_update(key, hi_get_milli_seconds(), events);
+        for (int i = 0; i < count; i++) {
+            if (events[i].type == KEY_EVENT_PRESS) {
+                printf("[button] %s pressed, %u samples, isr %u times, max %u us\n", key_name(events[i].key),
+                       samples, g_button_isr_count, g_button_isr_max_us);
+            }
+            car_key_event(&events[i]);
+        }
+    }
+}
+
+/**
+ * @brief 按键中断监控初始化
+ * @note 创建按键任务，注册GPIO5的中断处理函数，设置为下降沿触发
+ */
+void interrupt_monitor(void)
+{
+    unsigned int  ret = 0;
+    osThreadAttr_t attr;
+
+    g_button_event = osEventFlagsNew(NULL);
+    if (g_button_event == NULL) {
+        printf("[button] Failed to create event!\n");
+        return;
+    }
+
+    attr.name = "ButtonTask";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = BUTTON_TASK_STACK_SIZE;
+    attr.priority = BUTTON_TASK_PRIORITY;
+
+    if (osThreadNew(button_task, NULL, &attr) == NULL) {
+        printf("[button] Failed to create ButtonTask!\n");
+        return;
+    }
+
+    // 注册GPIO5中断服务函数，下降沿触发
+    ret = IoTGpioRegisterIsrFunc(GPIO5, IOT_INT_TYPE_EDGE, IOT_GPIO_EDGE_FALL_LEVEL_LOW, gpio5_isr, NULL);
+    if (ret == IOT_SUCCESS) {
+        printf(" register gpio5\r\n");
+    }
+}
+
+// 避障状态机的状态，由周期tick推进，状态间按时间切换
+typedef enum {
+    AVOID_CRUISE = 0,   // 前进，按碰撞时间判断是否刹车
+    AVOID_BRAKE,        // 停车
+    AVOID_REVERSE,      // 后退避让
+    AVOID_SCAN,         // 等待两侧扫描数据，选择转向方向
+    AVOID_TURN,         // 原地转向
+    AVOID_RESUME        // 停车等待正前方新数据，然后恢复前进
+} AvoidState;
+
+static AvoidState g_avoid_state = AVOID_RESUME;
+static unsigned int g_avoid_state_ms = 0;       // 进入当前状态的时刻
+static unsigned int g_avoid_max_latency = 0;    // 相邻两次检查模式的最大间隔，即最坏反应时间(ms)
+static float g_avoid_max_closing = 0.0f;        // 本次避障估计到的最大接近速度(cm/s)
+static unsigned int g_avoid_lookahead_ticks = 0;    // 本次避障中按接近速度预估而降低了占空比的tick数
+static unsigned int g_avoid_slow_distance = AVOID_SLOW_DISTANCE;
+static unsigned int g_avoid_stop_distance = AVOID_STOP_DISTANCE;
+static unsigned short g_avoid_duty = 0;         // 当前前进占空比，停车或后退、原地转向时为0
+static float g_avoid_travel_cm = 0.0f;          // 按占空比标定车速累计的前进距离(cm)
+static unsigned int g_avoid_start_ms = 0;       // 进入避障模式的时刻
+static unsigned int g_avoid_last_check = 0;     // 上一次检查模式的时刻
+
+static void avoid_enter(AvoidState state, unsigned int now)
+{
+    g_avoid_state = state;
+    g_avoid_state_ms = now;
+}
+
+int car_set_cruise_band(unsigned int slow_distance, unsigned int stop_distance)
+{
+    if (stop_distance == 0 || stop_distance >= slow_distance) {
+        return -1;
+    }
+    g_avoid_slow_distance = slow_distance;
+    g_avoid_stop_distance = stop_distance;
+    return 0;
+}
+
+// 减速带内占空比从AVOID_MIN_DUTY线性升到SPEED_FORWARD，进入停车带返回0
+static unsigned short avoid_band_duty(float distance)
+{
+    if (distance >= (float)g_avoid_slow_distance || SPEED_FORWARD <= AVOID_MIN_DUTY) {
+        return SPEED_FORWARD;
+    }
+    if (distance <= (float)g_avoid_stop_distance) {
+        return 0;
+    }
+    float ratio = (distance - g_avoid_stop_distance) / (float)(g_avoid_slow_distance - g_avoid_stop_distance);
+    return (unsigned short)(AVOID_MIN_DUTY + (SPEED_FORWARD - AVOID_MIN_DUTY) * ratio);
+}
+
+/**
+ * @brief 根据前方距离和接近速度计算巡航占空比
+ * @param distance 扫描图中正前方锥内的最近距离(cm)
+ * @return 前进占空比，0表示已进入停车带
+ * @note 接近速度是0度分区估计的，只用来外推0度方向的滤波距离：
+ *       减去接近速度在AVOID_LOOKAHEAD_MS内走过的距离后，比锥内最近距离更近时改用它；
+ *       锥内最近的可能是侧前方的障碍物，不按0度的接近速度外推
+ */
+static unsigned short avoid_cruise_duty(float distance)
+{
+    float filtered = ttc_get_distance();
+    float closing = ttc_get_closing_speed();
+    float nearest = distance;
+
+    if (filtered > 0) {
+        if (filtered < nearest) {
+            nearest = filtered;
+        }
+        if (closing > 0) {
+            filtered -= closing * AVOID_LOOKAHEAD_MS / 1000.0f;
+        }
+        if (filtered < distance) {
+            distance = filtered;
+        }
+    }
+
+    unsigned short duty = avoid_band_duty(distance);
+    if (duty < avoid_band_duty(nearest)) {
+        g_avoid_lookahead_ticks++;
+    }
+    return duty;
+}
+
+unsigned int car_avoid_max_latency(void)
+{
+    return g_avoid_max_latency;
+}
+
+float car_avoid_max_closing(void)
+{
+    return g_avoid_max_closing;
+}
+
+unsigned int car_avoid_lookahead_ticks(void)
+{
+    return g_avoid_lookahead_ticks;
+}
+
+/**
+ * @brief 根据扫描图选择转向方向
+ * @param timeout 为1时即使两侧数据不全也给出结果
+ * @return CAR_TURN_LEFT 或 CAR_TURN_RIGHT，数据不全且未超时时返回-1
+ * @note 选择可通行距离更远的一侧，两侧都没有数据时默认右转
+ */
+static int avoid_choose_turn(int timeout)
+{
+    float left_distance = scan_max_distance(SCAN_FORWARD_CONE, SERVO_ANGLE_MAX, CAR_SCAN_SIDE_MAX_AGE);
+    float right_distance = scan_max_distance(-SERVO_ANGLE_MAX, -SCAN_FORWARD_CONE, CAR_SCAN_SIDE_MAX_AGE);
+
+    if ((left_distance < 0 || right_distance < 0) && !timeout) {
+        return -1;
+    }
+    return (left_distance > right_distance) ? CAR_TURN_LEFT : CAR_TURN_RIGHT;
+}
+
+/**
+ * @brief 读取扫描图中正前方最近障碍物的距离，0度分区刷新时送入碰撞时间估计
+ * @return 正前方±SCAN_FORWARD_CONE内的最近距离(cm)，暂无新数据时返回-1
+ * @note 锥内各分区方位不同、测距时刻相差可达CAR_SCAN_FORWARD_MAX_AGE，
+ *       相邻两次最小值之差混有方位变化，不能当作接近速度，
+ *       所以碰撞时间估计只用0度分区，锥内最小值只用于距离判断；
+ *       0度分区要等舵机往返一趟才重测，样本间隔按扫描实测的重访间隔放宽，否则每个样本都会重新开始估计；
+ *       扫描配置没有0度分区时不做碰撞时间估计，只按距离减速和停车
+ */
+static float car_scan_forward(void)
+{
+    static unsigned int last_stamp = 0;
+    unsigned int stamp = 0;
+    unsigned int max_age = hi_get_milli_seconds() - g_scan_valid_after;
+
+    if (max_age > CAR_SCAN_FORWARD_MAX_AGE) {
+        max_age = CAR_SCAN_FORWARD_MAX_AGE;
+    }
+    float ahead = scan_min_distance(0, 0, max_age, &stamp);
+    if (ahead >= 0 && stamp != last_stamp) {
+        unsigned int timeout = scan_revisit_ms(0) * CAR_SCAN_TTC_MARGIN_PCT / 100;
+        ttc_update(ahead, stamp, (timeout > TTC_SAMPLE_TIMEOUT_MS) ? timeout : TTC_SAMPLE_TIMEOUT_MS);
+        last_stamp = stamp;
+        if (ttc_get_closing_speed() > g_avoid_max_closing) {
+            g_avoid_max_closing = ttc_get_closing_speed();
+        }
+    }
+    return scan_min_distance(-SCAN_FORWARD_CONE, SCAN_FORWARD_CONE, max_age, NULL);
+}
+
+/**
+ * @brief 按VFH规划结果边走边转
+ * @param now 当前时刻(ms)
+ * @param duty 直行时的前进占空比
+ * @return 0-已按规划方向行驶，-1-没有足够宽的可通行扇区
+ * @note 转向前测得的分区数据不再代表当前车头方向，按过期处理
+ */
+static int avoid_steer(unsigned int now, unsigned short duty)
+{
+    ScanBin bins[SCAN_MAX_BINS];
+    VfhResult plan;
+    unsigned int count = scan_get_map(bins, SCAN_MAX_BINS);
+
+    for (unsigned int i = 0; i < count; i++) {
+        if ((int)(bins[i].timestamp - g_scan_valid_after) < 0) {
+            bins[i].timestamp = 0;
+        }
+    }
+    if (vfh_plan(bins, count, now, SERVO_ANGLE_MIDDLE, duty, &plan) != 0) {
+        return -1;
+    }
+
+    car_drive(plan.left_duty, plan.right_duty);
+    g_avoid_duty = (unsigned short)((plan.left_duty + plan.right_duty) / 2);
+    if (plan.steer > VFH_STEER_STRAIGHT) {
+        car_set_moving(2);
+        ttc_reset();        // 边走边转时0度分区的前后样本不在同一方向，重新估计接近速度
+    } else if (plan.steer < -VFH_STEER_STRAIGHT) {
+        car_set_moving(1);
+        ttc_reset();
+    } else {
+        car_set_moving(3);
+    }
+    return 0;
+}
+
+/**
+ * @brief 避障状态机tick，每AVOID_TICK_MS调用一次，不阻塞
+ * @param now 当前时刻(ms)
+ * @note 避障逻辑：
+ *       CRUISE：按前方距离和接近速度调节占空比，越近越慢；
+ *               进入停车带或按当前占空比的碰撞时间需要刹车时进入BRAKE；
+ *               启用VFH时沿最接近正前方的可通行扇区边走边转，
+ *               扫描图已刷新但找不到可通行扇区时同样进入BRAKE
+ *       BRAKE(0.5s) -> REVERSE(0.5s) -> SCAN(读取两侧扫描数据) -> TURN(0.75s) -> RESUME
+ *       RESUME：等到正前方有转向后的新数据再回到CRUISE
+ */
+static void avoid_tick(unsigned int now)
+{
+    unsigned int elapsed = now - g_avoid_state_ms;
+    float distance = car_scan_forward();
+    unsigned short duty;
+    int turn;
+
+    // 按上一个tick的占空比累计前进距离，用于统计通过速度
+    g_avoid_travel_cm += ttc_speed_from_duty(g_avoid_duty) * AVOID_TICK_MS / 1000.0f;
+    g_avoid_duty = 0;
+
+    switch (g_avoid_state) {
+        case AVOID_CRUISE:
+            if (distance < 0) {
+                // 正前方没有新数据，原地等待
+                car_stop();
+                car_set_moving(0);
+                break;
+            }
+            duty = avoid_cruise_duty(distance);
+            if (duty == 0 || ttc_should_brake(duty, now)) {
+                car_stop();         // 已被堵住，立即停止
+                car_set_moving(0);
+                avoid_enter(AVOID_BRAKE, now);
+                break;
+            }
+#if CAR_AVOID_USE_VFH
+            if (avoid_steer(now, duty) == 0) {
+                break;
+            }
+            if (now - g_scan_valid_after >= VFH_MAP_MAX_AGE) {
+                // 扫描图已完整刷新仍被堵住，退回停车-后退-扫描流程
+                car_stop();
+                car_set_moving(0);
+                avoid_enter(AVOID_BRAKE, now);
+                break;
+            }
+#endif
+            car_drive(duty, duty);  // 距离足够，按调节后的占空比前进
+            g_avoid_duty = duty;
+            car_set_moving(3);
+            break;
+        case AVOID_BRAKE:
+            if (elapsed >= AVOID_BRAKE_MS) {
+                car_backward();     // 后退避让
+                car_set_moving(5);
+                avoid_enter(AVOID_REVERSE, now);
+            }
+            break;
+        case AVOID_REVERSE:
+            if (elapsed >= AVOID_REVERSE_MS) {
+                car_stop();         // 停止后退
+                car_set_moving(0);
+                avoid_enter(AVOID_SCAN, now);
+            }
+            break;
+        case AVOID_SCAN:
+            turn = avoid_choose_turn(elapsed >= AVOID_SCAN_TIMEOUT_MS);
+            if (turn == CAR_TURN_LEFT) {
+                car_left();         // 左转避障
+                car_set_moving(2);
+                avoid_enter(AVOID_TURN, now);
+            } else if (turn == CAR_TURN_RIGHT) {
+                car_right();        // 右转避障
+                car_set_moving(1);
+                avoid_enter(AVOID_TURN, now);
+            }
+            break;
+        case AVOID_TURN:
+            if (elapsed >= AVOID_TURN_MS) {
+                car_stop();         // 转向完成后停止
+                car_set_moving(0);
+                ttc_reset();        // 车头朝向已改变，重新估计接近速度
+                vfh_reset();
+                g_scan_valid_after = now;
+                avoid_enter(AVOID_RESUME, now);
+            }
+            break;
+        case AVOID_RESUME:
+            if (distance >= 0) {
+                avoid_enter(AVOID_CRUISE, now);
+            }
+            break;
+        default:
+            avoid_enter(AVOID_RESUME, now);
+            break;
+    }
+}
+
+/**
+ * @brief 进入避障模式：重置估计和统计，舵机开始连续扫描
+ * @param now 当前时刻(ms)
+ */
+static void avoid_begin(unsigned int now)
+{
+    pwm_init();                 // 初始化PWM，用于电机控制
+    ttc_reset();
+    vfh_reset();
+    g_scan_valid_after = now;
+    g_avoid_max_latency = 0;
+    g_avoid_max_closing = 0.0f;
+    g_avoid_lookahead_ticks = 0;
+    g_avoid_duty = 0;
+    g_avoid_travel_cm = 0.0f;
+    g_avoid_start_ms = now;
+    g_avoid_last_check = now;
+    avoid_enter(AVOID_RESUME, now);   // 等到正前方有数据再前进
+    scan_start();               // 舵机开始连续扫描
+}
+
+/**
+ * @brief 离开避障模式：立即停车并停止扫描，舵机归中不等待到位
+ * @param now 当前时刻(ms)
+ * @note 打印最坏反应时间，即相邻两次检查模式之间的最大间隔，
+ *       以及按占空比标定车速估算的平均通过速度(m/min)
+ */
+static void avoid_end(unsigned int now)
+{
+    car_stop();
+    car_set_moving(0);
+    scan_stop();
+    servo_set_angle(SERVO_ANGLE_MIDDLE);   // 退出前舵机归中
+    printf("[avoid] mode changed, worst reaction %u ms\n", g_avoid_max_latency);
+    if (now != g_avoid_start_ms) {
+        // cm/ms -> m/min：乘以60000/100
+        printf("[avoid] travelled %.0f cm in %u ms, %.2f m/min\n",
+               g_avoid_travel_cm, now - g_avoid_start_ms, g_avoid_travel_cm * 600.0f / (now - g_avoid_start_ms));
+    }
+}
+
+/**
+ * @brief 远控模式前进时的碰撞保护
+ * @note 调度器每CAR_GUARD_PERIOD_MS执行一次，只在远控模式下启用；
+ *       只在前进时测距，按碰撞时间判断是否需要刹车；
+ *       刹车后等待新的UDP指令，不自动恢复前进
+ */
+static void car_control_guard(void)
+{
+    if (MOVING_STATUS != 3) {
+        ttc_reset();
+        return;
+    }
+
+    unsigned int now = hi_get_milli_seconds();
+    ttc_update(GetDistance(), now, TTC_SAMPLE_TIMEOUT_MS);
+    if (ttc_should_brake(SPEED_FORWARD, now)) {
+        car_stop();
+        car_set_moving(4);
+        ttc_reset();
+        printf("[control] Brake: obstacle ahead\r\n");
+    }
+}
+
+/**
+ * @brief 向最近一次发来指令的上位机发送模式、运动状态、前方距离和电池电压
+ * @note 电池电压无效(未接分压电路)时battery为0，percent为-1
+ */
+static void car_telemetry(void)
+{
+    char text[128];
+
+    snprintf(text, sizeof(text), "{\"mode\":%u,\"moving\":%u,\"distance\":%.1f,\"battery\":%.2f,\"percent\":%d}",
+             g_car_status, MOVING_STATUS, ttc_get_distance(), battery_get_voltage(), battery_get_percent());
+    udp_report(text);
+}
+
+// 离开模式：避障停车并停止扫描，远控停用碰撞保护；寻迹已在模式任务中自行退出
+static void car_mode_leave(int mode, unsigned int now)
+{
+    if (mode == CAR_OBSTACLE_AVOIDANCE_STATUS) {
+        avoid_end(now);
+    } else if (mode == CAR_CONTROL_STATUS) {
+        sched_enable(g_guard_job, 0);
+    }
+}
+
+// 进入模式：碰撞保护只在远控模式下启用，进入前重置碰撞时间估计，避免与其他模式共用
+static void car_mode_enter(int mode, unsigned int now)
+{
+    if (mode == CAR_OBSTACLE_AVOIDANCE_STATUS) {
+        avoid_begin(now);
+    } else if (mode == CAR_CONTROL_STATUS) {
+        ttc_reset();
+        sched_enable(g_guard_job, 1);
+    }
+}
+
+/**
+ * @brief 模式调度作业，调度器每AVOID_TICK_MS执行一次，不阻塞
+ * @note 根据g_car_status离开旧模式、进入新模式，然后执行当前模式的周期工作：
+ *       - CAR_STOP_STATUS: 停止状态，保持停车
+ *       - CAR_OBSTACLE_AVOIDANCE_STATUS: 推进避障状态机，模式切换在下一次执行时生效
+ *       - CAR_TRACE_STATUS: 寻迹由红外跳变事件驱动、要阻塞等待，通知模式任务执行，
+ *                           寻迹返回前本作业不做任何事
+ *       - CAR_CONTROL_STATUS: UDP控制指令直接控制小车，前进时的碰撞保护由guard作业完成
+ */
+static void car_mode_job(void)
+{
+    unsigned int now = hi_get_milli_seconds();
+    int status = g_car_status;
+
+    if (g_trace_running) {
+        return;
+    }
+    if (g_mode_active == CAR_OBSTACLE_AVOIDANCE_STATUS) {
+        if (now - g_avoid_last_check > g_avoid_max_latency) {
+            g_avoid_max_latency = now - g_avoid_last_check;
+        }
+        g_avoid_last_check = now;
+    }
+    if (status != g_mode_active) {
+        car_mode_leave(g_mode_active, now);
+        car_mode_enter(status, now);
+        g_mode_active = status;
+    }
+
+    switch (status) {
+        case CAR_STOP_STATUS:
+            car_stop();
+            break;
+        case CAR_OBSTACLE_AVOIDANCE_STATUS:
+            avoid_tick(now);
+            break;
+        case CAR_TRACE_STATUS:
+            // 寻迹退出后模式又切回寻迹时同样重新开始
+            g_trace_running = 1;
+            osEventFlagsSet(g_mode_event, CAR_MODE_EVENT_TRACE);
+            break;
+        default:
+            break;
+    }
+}
+
+static const SchedJobConfig g_mode_config = {
+    "mode", car_mode_job, AVOID_TICK_MS, 0, CAR_MODE_PRIORITY, SCHED_CTX_TASK, CAR_MODE_BUDGET_US
+};
+static const SchedJobConfig g_guard_config = {
+    "guard", car_control_guard, CAR_GUARD_PERIOD_MS, 0, CAR_GUARD_PRIORITY, SCHED_CTX_TASK, CAR_GUARD_BUDGET_US
+};
+static const SchedJobConfig g_telemetry_config = {
+    "telemetry", car_telemetry, CAR_TELEMETRY_PERIOD_MS, CAR_TELEMETRY_PHASE_MS, CAR_TELEMETRY_PRIORITY,
+    SCHED_CTX_TASK, CAR_TELEMETRY_BUDGET_US
+};
+
+/**
+ * @brief 小车主控制任务函数
+ * @param param 任务参数（未使用）
+ * @return 无返回值
+ * @note 模式切换和避障由调度器的mode作业按AVOID_TICK_MS执行，本任务只等待mode作业的通知执行寻迹：
+ *       寻迹在红外跳变事件上阻塞等待，不能放在调度器的工作任务中；寻迹退出后交还给mode作业
+ */
+void *RobotCarTestTask(void* param)
+{
+    printf("switch\r\n");
+    switch_init();              // 初始化按键开关
+    interrupt_monitor();        // 初始化按键中断监控
+
+    // 在启动时创建UDP线程用于远程控制
+    if (!udp_thread_created) {
+        start_udp_thread();
+        udp_thread_created = 1;
+        printf("UDP thread started at startup\r\n");
+    }
+    IoTWatchDogDisable();       // 关闭看门狗
+
+    g_mode_event = osEventFlagsNew(NULL);
+    if (g_mode_event == NULL) {
+        printf("[control] Failed to create mode event!\n");
+        return NULL;
+    }
+    g_guard_job = sched_add(&g_guard_config);
+    g_telemetry_job = sched_add(&g_telemetry_config);
+    g_mode_job = sched_add(&g_mode_config);
+    sched_enable(g_telemetry_job, 1);
+    sched_enable(g_mode_job, 1);
+    battery_start();
+
+    while (1) {
+        osEventFlagsWait(g_mode_event, CAR_MODE_EVENT_TRACE, osFlagsWaitAny, osWaitForever);
+        trace_module();             // 寻迹模式：执行红外寻迹，模式切换后返回
+        g_trace_running = 0;
+    }
+}
+
+/**
+ * @brief 小车演示程序入口函数
+ * @note 创建小车控制主任务，配置任务属性并启动
+ */
+void RobotCarDemo(void)
+{
+    osThreadAttr_t attr;
+
+    // 配置任务属性
+    attr.name = "RobotCarTestTask";     // 任务名称
+    attr.attr_bits = 0U;               // 任务属性位
+    attr.cb_mem = NULL;                // 控制块内存
+    attr.cb_size = 0U;                 // 控制块大小
+    attr.stack_mem = NULL;             // 栈内存
+    attr.stack_size = 10240;           // 栈大小10KB
+    attr.priority = 25;                // 任务优先级
+
+    // 创建小车控制主任务
+    if (osThreadNew((osThreadFunc_t)RobotCarTestTask, NULL, &attr) == NULL) {
+        printf("[Ssd1306TestDemo] Falied to create RobotCarTestTask!\n");
+    }
+}
+
+// 系统启动时自动初始化小车演示程序
 APP_FEATURE_INIT(RobotCarDemo);
\ No newline at end of file
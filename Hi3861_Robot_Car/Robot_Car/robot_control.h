@@ -1,23 +1,112 @@
-#ifndef __APP_DEMO_ROBOT_CAR_H__
-#define __APP_DEMO_ROBOT_CAR_H__
-
-
-#define     CAR_CONTROL_DEMO_TASK_STAK_SIZE   (1024*10)
-#define     CAR_CONTROL_DEMO_TASK_PRIORITY    (25)
-#define     DISTANCE_BETWEEN_CAR_AND_OBSTACLE (20)
-#define     KEY_INTERRUPT_PROTECT_TIME        (30)
-#define     CAR_TURN_LEFT                     (0)
-#define     CAR_TURN_RIGHT                    (1)
-
-typedef enum {
-    CAR_STOP_STATUS = 0,
-    CAR_OBSTACLE_AVOIDANCE_STATUS, 
-    CAR_TRACE_STATUS,
-    CAR_CONTROL_STATUS
-} CarStatus;
-
-
-void switch_init(void);
-void interrupt_monitor(void);
-void car_mode_control_func(void);
+#ifndef __APP_DEMO_ROBOT_CAR_H__
+#define __APP_DEMO_ROBOT_CAR_H__
+
+
+#define     CAR_CONTROL_DEMO_TASK_STAK_SIZE   (1024*10)
+#define     CAR_CONTROL_DEMO_TASK_PRIORITY    (25)
+#define     DISTANCE_BETWEEN_CAR_AND_OBSTACLE (20)    // 刹车后恢复前进所需的最小距离(cm)
+#define     BUTTON_TASK_STACK_SIZE            (2048)    // 按键任务：中断只发事件，ADC采样和手势解码在任务中完成
+#define     BUTTON_TASK_PRIORITY              (25)
+#define     CAR_SPEED_STEP                    (1000)    // 调速键每档的前进占空比变化
+#define     CAR_SPEED_MIN                     (4000)    // 调速键能调到的最低前进占空比
+#define     CAR_SCAN_FORWARD_MAX_AGE          (1000)    // 避障时正前方扫描数据的有效期(ms)
+#define     CAR_SCAN_SIDE_MAX_AGE             (3000)    // 选择转向时两侧扫描数据的有效期(ms)
+#define     CAR_SCAN_TTC_MARGIN_PCT           (150)     // 0度分区样本间隔超过其重访间隔的该百分比时，碰撞时间估计重新开始
+
+// 避障状态机时间参数(ms)
+#define     AVOID_TICK_MS                     (20)      // 状态机推进周期
+#define     AVOID_BRAKE_MS                    (500)     // 刹车后停顿时间
+#define     AVOID_REVERSE_MS                  (500)     // 后退时间
+#define     AVOID_SCAN_TIMEOUT_MS             (1000)    // 等待两侧扫描数据的最长时间
+#define     AVOID_TURN_MS                     (750)     // 转向持续时间
+#define     CAR_AVOID_USE_VFH                 (1)       // 1-前进时按VFH边走边转，0-只直行
+
+// 避障巡航调速参数：前方距离在减速带内时占空比随距离线性下降，进入停车带后视为被堵住
+#define     AVOID_SLOW_DISTANCE               (60)      // 减速带上沿(cm)，大于该距离全速前进
+#define     AVOID_STOP_DISTANCE               (15)      // 停车带上沿(cm)，小于该距离停车并后退转向
+#define     AVOID_MIN_DUTY                    (4000)    // 减速带内的最低前进占空比，低于该值电机带不动车
+#define     AVOID_LOOKAHEAD_MS                (300)     // 按接近速度向前预估的时间，接近越快越早减速
+#define     TRACE_USE_PD                      (1)       // 1-寻迹按估计偏移做PD差速控制，0-左转/右转/直行三态控制
+#define     TRACE_CONTROL_TICKS               (2)       // PD寻迹在两次红外跳变之间按外推偏移更新差速的周期(tick)
+
+// 调度作业参数
+#define     CAR_MODE_BUDGET_US                (5000)    // 模式调度和避障状态机推进不阻塞，只有离开避障时要等扫描任务测完当前分区
+#define     CAR_MODE_PRIORITY                 (30)      // 高于测距和遥测，模式切换和避障转向不被耽误
+#define     CAR_GUARD_PERIOD_MS               (50)      // 远控碰撞保护测距周期
+#define     CAR_GUARD_BUDGET_US               (30000)   // 超声波回响超时时间
+#define     CAR_GUARD_PRIORITY                (20)
+#define     CAR_TELEMETRY_PERIOD_MS           (1000)    // 向上位机发送运行状态的周期
+#define     CAR_TELEMETRY_PHASE_MS            (500)     // 与测距错开
+#define     CAR_TELEMETRY_BUDGET_US           (5000)
+#define     CAR_TELEMETRY_PRIORITY            (10)
+#define     CAR_TURN_LEFT                     (0)
+#define     CAR_TURN_RIGHT                    (1)
+
+typedef enum {
+    CAR_STOP_STATUS = 0,
+    CAR_OBSTACLE_AVOIDANCE_STATUS, 
+    CAR_TRACE_STATUS,
+    CAR_CONTROL_STATUS
+} CarStatus;
+
+
+void switch_init(void);
+void interrupt_monitor(void);
+
+/**
+ * @brief 设置避障巡航的减速带和停车带
+ * @param slow_distance 减速带上沿(cm)
+ * @param stop_distance 停车带上沿(cm)，需小于slow_distance
+ * @return 0-成功，-1-参数无效
+ */
+int car_set_cruise_band(unsigned int slow_distance, unsigned int stop_distance);
+
+/**
+ * @brief 获取最近一次避障模式中的最坏反应时间
+ * @return 相邻两次检查模式之间的最大间隔(ms)，模式切换最迟在这么久后生效
+ */
+unsigned int car_avoid_max_latency(void);
+
+/**
+ * @brief 获取最近一次避障模式中估计到的最大接近速度
+ * @return 0度分区碰撞时间估计给出的最大接近速度(cm/s)，没有估计出接近速度时返回0
+ */
+float car_avoid_max_closing(void);
+
+/**
+ * @brief 获取最近一次避障模式中按接近速度预估而降低了占空比的次数
+ * @return 预估后的占空比低于只按当前距离计算的占空比的巡航tick数
+ */
+unsigned int car_avoid_lookahead_ticks(void);
+
+/**
+ * @brief 切换小车模式，模式变化时状态版本号加一
+ * @param status CarStatus
+ */
+void car_set_status(unsigned char status);
+
+/**
+ * @brief 设置前进速度，速度变化时状态版本号加一
+ * @param speed 前进占空比
+ */
+void car_set_speed(unsigned short speed);
+
+/**
+ * @brief 设置运动状态，状态变化时状态版本号加一，寻迹和避障每个控制周期都会调用
+ * @param moving 0-停止，1-右转，2-左转，3-前进，4-遇到障碍物，5-后退
+ */
+void car_set_moving(unsigned int moving);
+
+/**
+ * @brief 获取状态版本号，模式、前进速度和运动状态任一变化都会加一
+ */
+unsigned int car_state_version(void);
+
+/**
+ * @brief 等待状态版本号变化，只能由一个任务调用
+ * @param version 调用者已经处理过的版本号
+ * @param timeout 最长等待时间(tick)
+ * @return 当前版本号，超时返回时可能仍等于version
+ */
+unsigned int car_state_wait(unsigned int version, unsigned int timeout);
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+ * 红外寻迹传感器滤波模块
+ * 功能：每个传感器保存最近若干次采样的位历史，用popcount统计窗口内的压线样本数，
+ *       按多数表决加迟滞得到稳定的压线状态，单个噪声采样不会改变判定
+ * 每次采样只有移位、与和popcount几条指令，可以在1ms定时器回调中调用
+ */
+
+#include "robot_ir.h"
+
+static unsigned int g_ir_window_mask = (1u << IR_DEFAULT_WINDOW) - 1;
+static unsigned int g_ir_on_count = IR_DEFAULT_ON_COUNT;
+static unsigned int g_ir_off_count = IR_DEFAULT_OFF_COUNT;
+
+int ir_filter_config(unsigned int window, unsigned int on_count, unsigned int off_count)
+{
+    if (window == 0 || window > IR_WINDOW_MAX || on_count > window || off_count >= on_count) {
+        return -1;
+    }
+    g_ir_window_mask = (window >= IR_WINDOW_MAX) ? 0xFFFFFFFFu : (1u << window) - 1;
+    g_ir_on_count = on_count;
+    g_ir_off_count = off_count;
+    return 0;
+}
+
+void ir_channel_reset(IrChannel *channel, int black, unsigned int now_ms)
+{
+    channel->history = black ? 0xFFFFFFFFu : 0;
+    channel->black = black ? 1 : 0;
+    channel->edge_ms = now_ms;
+}
+
+int ir_channel_update(IrChannel *channel, int black, unsigned int now_ms)
+{
+    unsigned int history = (channel->history << 1) | (black ? 1u : 0u);
+    unsigned int count = __builtin_popcount(history & g_ir_window_mask);
+    int next = channel->black;
+
+    channel->history = history;
+    if (count >= g_ir_on_count) {
+        next = 1;
+    } else if (count <= g_ir_off_count) {
+        next = 0;
+    }
+    if (next == channel->black) {
+        return 0;
+    }
+
+    // 最新采样起连续与新状态相同的采样数，跳变发生在其中第一个采样
+    unsigned int same = next ? ~history : history;
+    unsigned int run = (same == 0) ? IR_WINDOW_MAX : (unsigned int)__builtin_ctz(same);
+    if (run == 0) {
+        run = 1;    // 最新采样与新状态不同，按当前时刻计
+    }
+    channel->black = (unsigned char)next;
+    channel->edge_ms = now_ms - (run - 1) * IR_SAMPLE_PERIOD_MS;
+    return 1;
+}
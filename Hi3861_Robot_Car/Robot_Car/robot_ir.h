@@ -0,0 +1,43 @@
+#ifndef ROBOT_IR_H
+#define ROBOT_IR_H
+
+// 滤波参数：保留最近window个采样，窗口内压线样本数达到on_count判为压线，
+// 降到off_count及以下判为未压线，两者之间保持原状态(迟滞)
+#define IR_WINDOW_MAX           (32)        // 历史位数上限
+#define IR_DEFAULT_WINDOW       (5)
+#define IR_DEFAULT_ON_COUNT     (4)
+#define IR_DEFAULT_OFF_COUNT    (1)
+#define IR_SAMPLE_PERIOD_MS     (1)         // 采样周期，用于回推跳变时刻
+
+// 单个红外传感器的滤波状态
+typedef struct {
+    unsigned int history;       // 采样历史移位寄存器，bit0为最新采样，1表示压线
+    unsigned char black;        // 滤波后状态，1表示压线
+    unsigned int edge_ms;       // 滤波状态最近一次跳变的时刻(ms)
+} IrChannel;
+
+/**
+ * @brief 配置滤波窗口和判定阈值，所有通道共用
+ * @param window 窗口采样数，1~IR_WINDOW_MAX
+ * @param on_count 判为压线所需的压线样本数
+ * @param off_count 压线样本数不超过该值时判为未压线，需小于on_count
+ * @return 0-成功，-1-参数无效
+ */
+int ir_filter_config(unsigned int window, unsigned int on_count, unsigned int off_count);
+
+/**
+ * @brief 按给定状态填满采样历史，进入寻迹模式时调用
+ */
+void ir_channel_reset(IrChannel *channel, int black, unsigned int now_ms);
+
+/**
+ * @brief 移入一个原始采样并更新滤波状态
+ * @param channel 传感器通道
+ * @param black 原始采样是否压线
+ * @param now_ms 采样时刻(ms)
+ * @return 1-滤波状态发生跳变，0-未变化
+ * @note 跳变时刻回推到窗口内连续同值采样的第一个，抵消滤波引入的延迟
+ */
+int ir_channel_update(IrChannel *channel, int black, unsigned int now_ms);
+
+#endif // ROBOT_IR_H
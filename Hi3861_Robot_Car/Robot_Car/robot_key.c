@@ -0,0 +1,179 @@
+/*
+ * 分压按键解码模块
+ * 功能：GPIO5上的多个按键通过电阻分压接到同一路ADC，按编译期档位表把码字映射为按键；
+ *       采样读数连续几次落在同一档位即提前结束，不再固定读20次；
+ *       按住和松开由周期轮询得到，在此基础上产生按下、松开、单击、双击、长按和持续按住事件
+ */
+
+#include <stddef.h>
+
+#include "hi_adc.h"
+
+#include "robot_key.h"
+
+// 一个按键对应的码字范围，闭区间
+typedef struct {
+    unsigned short min_code;
+    unsigned short max_code;
+    KeyId key;
+} KeyBand;
+
+// 档位之间留出间隔，落在间隔里的读数(按下或松开的瞬间)视为不稳定
+static const KeyBand g_key_bands[] = {
+    {KEY_CODE(10), KEY_CODE(300), KEY_ID_MODE},
+    {KEY_CODE(600), KEY_CODE(1500), KEY_ID_SPEED},
+};
+
+#define KEY_BAND_COUNT          (sizeof(g_key_bands) / sizeof(g_key_bands[0]))
+
+typedef enum {
+    KEY_STATE_IDLE = 0,
+    KEY_STATE_DOWN,             // 按住
+    KEY_STATE_WAIT_DOUBLE       // 已松开，等待是否双击
+} KeyState;
+
+static KeyState g_key_state = KEY_STATE_IDLE;
+static KeyId g_key_current = KEY_ID_NONE;
+static unsigned int g_key_down_ms = 0;          // 按下时刻
+static unsigned int g_key_away_ms = 0;          // 读数离开档位的时刻
+static int g_key_away = 0;
+static int g_key_long = 0;                      // 本次按住已触发长按
+static unsigned int g_key_hold_ms = 0;          // 下一次持续按住事件距按下的时间
+static int g_key_second = 0;                    // 本次按下是双击的第二下
+
+static KeyId key_band(unsigned short code)
+{
+    for (unsigned int i = 0; i < KEY_BAND_COUNT; i++) {
+        if (code >= g_key_bands[i].min_code && code <= g_key_bands[i].max_code) {
+            return g_key_bands[i].key;
+        }
+    }
+    return KEY_ID_NONE;
+}
+
+KeyId key_sample(unsigned int *samples)
+{
+    KeyId last = KEY_ID_NONE;
+    unsigned int stable = 0;
+    unsigned int count = 0;
+    unsigned short code;
+
+    while (count < KEY_SAMPLE_MAX && stable < KEY_SAMPLE_STABLE) {
+        // ADC_Channal_2 自动识别模式，4次平均算法模式
+        if (hi_adc_read(HI_ADC_CHANNEL_2, &code, HI_ADC_EQU_MODEL_4, HI_ADC_CUR_BAIS_DEFAULT, 0xF0) != 0) {
+            stable = 0;
+            break;
+        }
+        count++;
+        KeyId key = key_band(code);
+        stable = (count > 1 && key == last) ? stable + 1 : 1;
+        last = key;
+    }
+    if (samples != NULL) {
+        *samples = count;
+    }
+    return (stable >= KEY_SAMPLE_STABLE) ? last : KEY_ID_NONE;
+}
+
+void key_gesture_reset(void)
+{
+    g_key_state = KEY_STATE_IDLE;
+    g_key_current = KEY_ID_NONE;
+    g_key_away = 0;
+    g_key_long = 0;
+    g_key_second = 0;
+}
+
+static int key_emit(KeyEvent *events, int count, KeyId key, KeyEventType type)
+{
+    events[count].key = key;
+    events[count].type = type;
+    return count + 1;
+}
+
+static int key_press(KeyEvent *events, int count, KeyId key, unsigned int now_ms, int second)
+{
+    g_key_state = KEY_STATE_DOWN;
+    g_key_current = key;
+    g_key_down_ms = now_ms;
+    g_key_away = 0;
+    g_key_long = 0;
+    g_key_second = second;
+    return key_emit(events, count, key, KEY_EVENT_PRESS);
+}
+
+int key_gesture_update(KeyId key, unsigned int now_ms, KeyEvent *events)
+{
+    int count = 0;
+
+    switch (g_key_state) {
+        case KEY_STATE_IDLE:
+            if (key != KEY_ID_NONE) {
+                count = key_press(events, count, key, now_ms, 0);
+            }
+            break;
+        case KEY_STATE_DOWN:
+            if (key == g_key_current) {
+                g_key_away = 0;
+                if (!g_key_long && now_ms - g_key_down_ms >= KEY_LONG_MS) {
+                    g_key_long = 1;
+                    g_key_hold_ms = KEY_LONG_MS + KEY_HOLD_STEP_MS;
+                    count = key_emit(events, count, g_key_current, KEY_EVENT_LONG);
+                } else if (g_key_long && now_ms - g_key_down_ms >= g_key_hold_ms) {
+                    g_key_hold_ms += KEY_HOLD_STEP_MS;
+                    count = key_emit(events, count, g_key_current, KEY_EVENT_HOLD);
+                }
+                break;
+            }
+            if (!g_key_away) {
+                g_key_away = 1;
+                g_key_away_ms = now_ms;
+            }
+            if (now_ms - g_key_away_ms < KEY_RELEASE_MS) {
+                break;
+            }
+            count = key_emit(events, count, g_key_current, KEY_EVENT_RELEASE);
+            if (g_key_long) {
+                g_key_state = KEY_STATE_IDLE;
+            } else if (g_key_second) {
+                count = key_emit(events, count, g_key_current, KEY_EVENT_DOUBLE);
+                g_key_state = KEY_STATE_IDLE;
+            } else {
+                g_key_state = KEY_STATE_WAIT_DOUBLE;    // 双击等待期从读数离开档位时算起
+            }
+            break;
+        case KEY_STATE_WAIT_DOUBLE:
+            if (key == g_key_current) {
+                count = key_press(events, count, key, now_ms, 1);
+            } else if (key != KEY_ID_NONE) {
+                // 等待期内按了另一个键，前一个键按单击结算
+                count = key_emit(events, count, g_key_current, KEY_EVENT_CLICK);
+                count = key_press(events, count, key, now_ms, 0);
+            } else if (now_ms - g_key_away_ms >= KEY_DOUBLE_MS) {
+                count = key_emit(events, count, g_key_current, KEY_EVENT_CLICK);
+                g_key_state = KEY_STATE_IDLE;
+            }
+            break;
+        default:
+            key_gesture_reset();
+            break;
+    }
+    return count;
+}
+
+int key_gesture_busy(void)
+{
+    return g_key_state != KEY_STATE_IDLE;
+}
+
+const char *key_name(KeyId key)
+{
+    switch (key) {
+        case KEY_ID_MODE:
+            return "MODE";
+        case KEY_ID_SPEED:
+            return "SPEED";
+        default:
+            return "NONE";
+    }
+}
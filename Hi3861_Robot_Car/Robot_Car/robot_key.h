@@ -0,0 +1,73 @@
+#ifndef ROBOT_KEY_H
+#define ROBOT_KEY_H
+
+// 按键分压网络：各按键经不同电阻把GPIO5(ADC通道2)拉到不同电压，未按下时为3.3V上拉
+// 码字 = 电压 * 4096 / (1.8 * 4)，档位表见robot_key.c
+#define KEY_CODE(mv)            ((mv) * 4096 / 7200)
+
+// 采样参数
+#define KEY_SAMPLE_MAX          (20)        // 单次采样最多读ADC的次数
+#define KEY_SAMPLE_STABLE       (3)         // 连续落在同一档位的次数，达到即提前结束
+
+// 手势参数(ms)
+#define KEY_POLL_MS             (20)        // 按住或等待双击期间的轮询周期
+#define KEY_RELEASE_MS          (30)        // 读数离开档位持续该时间才算松开，滤掉抖动
+#define KEY_LONG_MS             (800)       // 按住超过该时间触发长按
+#define KEY_DOUBLE_MS           (300)       // 松开后该时间内再次按下同一键视为双击
+#define KEY_HOLD_STEP_MS        (1000)      // 长按后继续按住，每过该时间产生一次持续按住事件
+
+typedef enum {
+    KEY_ID_NONE = 0,        // 未按下或读数不稳定
+    KEY_ID_MODE,            // 模式键，约0.01V~0.3V
+    KEY_ID_SPEED,           // 调速键，约0.6V~1.5V
+    KEY_ID_COUNT
+} KeyId;
+
+typedef enum {
+    KEY_EVENT_PRESS = 0,    // 按下
+    KEY_EVENT_RELEASE,      // 松开
+    KEY_EVENT_CLICK,        // 单击：松开后双击等待期内没有再次按下，且未触发长按
+    KEY_EVENT_DOUBLE,       // 双击：第二次松开时产生，不再产生单击
+    KEY_EVENT_LONG,         // 长按：按住期间产生一次，松开后不再产生单击
+    KEY_EVENT_HOLD          // 持续按住：长按后每KEY_HOLD_STEP_MS产生一次
+} KeyEventType;
+
+typedef struct {
+    KeyId key;
+    KeyEventType type;
+} KeyEvent;
+
+#define KEY_EVENTS_MAX          (3)         // 一次key_gesture_update()最多产生的事件数
+
+/**
+ * @brief 采样一次按键电平，读数连续KEY_SAMPLE_STABLE次落在同一档位即返回
+ * @param samples 输出实际读ADC的次数，可为NULL
+ * @return 按下的按键，未按下、读数不稳定或ADC失败时返回KEY_ID_NONE
+ */
+KeyId key_sample(unsigned int *samples);
+
+/**
+ * @brief 复位手势状态
+ */
+void key_gesture_reset(void);
+
+/**
+ * @brief 用一次采样结果推进手势状态机
+ * @param key 本次采样到的按键
+ * @param now_ms 采样时刻
+ * @param events 输出事件，至少KEY_EVENTS_MAX个
+ * @return 产生的事件数
+ */
+int key_gesture_update(KeyId key, unsigned int now_ms, KeyEvent *events);
+
+/**
+ * @brief 查询是否需要继续轮询，按键按住或等待双击时返回1，空闲时只需等待按键中断
+ */
+int key_gesture_busy(void);
+
+/**
+ * @brief 按键名称，用于日志
+ */
+const char *key_name(KeyId key);
+
+#endif // ROBOT_KEY_H
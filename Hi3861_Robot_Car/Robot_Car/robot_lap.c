@@ -0,0 +1,179 @@
+/*
+ * 圈速学习模块
+ * 功能：闭合赛道上连续跑圈时，第一圈把左右修正按里程分段累计成转角记下来，
+ *       转角很小的连续段就是直道，之后各圈按记录的赛道提前加速和降速
+ * 里程和转角由左右轮占空比按标定表换算车速后积分得到，每过一次圈标清零；
+ * 记录按段号环形查找，圈标前后的段首尾相接
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "robot_lap.h"
+#include "robot_ttc.h"
+#include "udp_control.h"
+
+#define LAP_WHEEL_TRACK         (13.0f)     // 左右轮间距(cm)
+#define LAP_RAD2DEG             (57.2958f)
+
+static signed char g_lap_turn[LAP_BIN_MAX];    // 各段净转角(度)，正值为左转
+static unsigned int g_lap_bins = 0;             // 已学习赛道的段数，0表示尚未学习
+static volatile int g_lap_forget = 0;           // UDP线程请求清除赛道，由寻迹任务在圈标处执行
+
+static unsigned int g_lap_target = 0;
+static unsigned int g_lap_marks = 0;        // 本次寻迹压过圈标的次数
+static int g_lap_recording = 0;             // 当前圈在记录转角
+static int g_lap_overflow = 0;
+static unsigned int g_lap_start_ms = 0;
+static unsigned int g_lap_odometry_ms = 0;
+static float g_lap_distance = 0.0f;         // 本圈里程(cm)
+static float g_lap_heading = 0.0f;          // 当前段内累计转角(rad)
+
+int lap_set_target(unsigned int laps)
+{
+    if (laps > LAP_MAX_TARGET) {
+        return -1;
+    }
+    g_lap_target = laps;
+    return 0;
+}
+
+void lap_forget(void)
+{
+    g_lap_forget = 1;
+}
+
+// 执行清除请求，只在寻迹任务中调用，lap_speed()读到的段数不会中途变成0
+static void lap_apply_forget(void)
+{
+    if (g_lap_forget) {
+        g_lap_forget = 0;
+        g_lap_bins = 0;
+        g_lap_recording = 0;
+    }
+}
+
+void lap_begin(unsigned int now_ms)
+{
+    lap_apply_forget();
+    g_lap_marks = 0;
+    g_lap_recording = 0;
+    g_lap_distance = 0.0f;
+    g_lap_heading = 0.0f;
+    g_lap_odometry_ms = now_ms;
+}
+
+static float lap_wheel_speed(int duty)
+{
+    float speed = ttc_speed_from_duty((unsigned short)((duty < 0) ? -duty : duty));
+    return (duty < 0) ? -speed : speed;
+}
+
+// 保存一段的净转角
+static void lap_store_bin(unsigned int bin)
+{
+    float degrees = g_lap_heading * LAP_RAD2DEG;
+
+    if (bin >= LAP_BIN_MAX) {
+        g_lap_overflow = 1;
+        return;
+    }
+    if (degrees > 127.0f) {
+        degrees = 127.0f;
+    } else if (degrees < -127.0f) {
+        degrees = -127.0f;
+    }
+    g_lap_turn[bin] = (signed char)lroundf(degrees);
+}
+
+void lap_odometry(unsigned int now_ms, int left_duty, int right_duty)
+{
+    float dt = (now_ms - g_lap_odometry_ms) / 1000.0f;
+    float left = lap_wheel_speed(left_duty);
+    float right = lap_wheel_speed(right_duty);
+    unsigned int bin = (unsigned int)(g_lap_distance / LAP_BIN_CM);
+
+    g_lap_odometry_ms = now_ms;
+    g_lap_distance += (left + right) / 2.0f * dt;
+    g_lap_heading += (right - left) / LAP_WHEEL_TRACK * dt;
+
+    // 跨过段边界时结算上一段
+    if ((unsigned int)(g_lap_distance / LAP_BIN_CM) != bin) {
+        if (g_lap_recording) {
+            lap_store_bin(bin);
+        }
+        g_lap_heading = 0.0f;
+    }
+}
+
+// 结算一圈：学习圈有效时保存赛道，并通过UDP报告圈速
+static void lap_finish(unsigned int now_ms)
+{
+    char report[96];
+    unsigned int lap_ms = now_ms - g_lap_start_ms;
+
+    if (g_lap_recording) {
+        unsigned int bins = (unsigned int)(g_lap_distance / LAP_BIN_CM);
+        if (!g_lap_overflow && g_lap_distance >= LAP_MIN_LENGTH_CM) {
+            g_lap_bins = bins;
+            printf("[lap] learned %u bins, %.0f cm\n", g_lap_bins, g_lap_distance);
+        } else {
+            printf("[lap] learning discarded\n");
+        }
+    }
+    snprintf(report, sizeof(report), "{\"lap\":%u,\"time_ms\":%u,\"distance_cm\":%.0f,\"learning\":%d}",
+             g_lap_marks, lap_ms, g_lap_distance, g_lap_recording);
+    printf("[lap] %s\n", report);
+    udp_report(report);
+}
+
+int lap_mark(unsigned int now_ms)
+{
+    if (g_lap_target == 0) {
+        return LAP_MARK_STOP;
+    }
+    lap_apply_forget();
+    if (g_lap_marks > 0) {
+        lap_finish(now_ms);
+    }
+    g_lap_marks++;
+    if (g_lap_marks > g_lap_target) {
+        return LAP_MARK_FINISH;
+    }
+
+    // 开始新的一圈，没有已学习的赛道时本圈记录转角
+    g_lap_start_ms = now_ms;
+    g_lap_distance = 0.0f;
+    g_lap_heading = 0.0f;
+    g_lap_recording = (g_lap_bins == 0);
+    g_lap_overflow = 0;
+    return LAP_MARK_CONTINUE;
+}
+
+static int lap_is_curve(int bin, int bins)
+{
+    int index = bin % bins;
+
+    if (index < 0) {
+        index += bins;
+    }
+    return g_lap_turn[index] >= LAP_CURVE_DEG || g_lap_turn[index] <= -LAP_CURVE_DEG;
+}
+
+unsigned short lap_speed(unsigned short base_duty)
+{
+    int bins = (int)g_lap_bins;
+
+    if (g_lap_marks == 0 || g_lap_recording || bins == 0 || base_duty >= LAP_FAST_DUTY) {
+        return base_duty;
+    }
+
+    // 前后若干段都是直道时加速
+    int bin = (int)(g_lap_distance / LAP_BIN_CM);
+    for (int i = bin - LAP_SETTLE_BINS; i <= bin + LAP_BRAKE_BINS; i++) {
+        if (lap_is_curve(i, bins)) {
+            return base_duty;
+        }
+    }
+    return LAP_FAST_DUTY;
+}
@@ -0,0 +1,56 @@
+#ifndef ROBOT_LAP_H
+#define ROBOT_LAP_H
+
+// 圈速学习：以终点横线为圈标，第一圈按里程分段记录每段内左右修正累计的转角，
+// 之后各圈在连续直道段上加速，并在下一个弯道段前提前降速
+#define LAP_BIN_CM              (20)        // 每段里程(cm)
+#define LAP_BIN_MAX             (64)        // 段数上限，一圈最长12.8m，超出时本圈学习作废
+#define LAP_CURVE_DEG           (15)        // 段内净转角超过该值视为弯道
+#define LAP_SETTLE_BINS         (1)         // 出弯后按基础速度再走的段数
+#define LAP_BRAKE_BINS          (1)         // 弯道前提前降速的段数
+#define LAP_FAST_DUTY           (8000)      // 直道占空比
+#define LAP_MIN_LENGTH_CM       (100)       // 短于该里程的一圈视为误触发，不保存
+#define LAP_MAX_TARGET          (99)
+
+// lap_mark()的返回值
+#define LAP_MARK_CONTINUE       (0)         // 继续跑下一圈，直行通过横线
+#define LAP_MARK_STOP           (1)         // 未开启圈速学习，按普通停车线处理
+#define LAP_MARK_FINISH         (2)         // 已跑完设定圈数，停车直到退出寻迹模式
+
+/**
+ * @brief 设置连续跑的圈数
+ * @param laps 0-关闭圈速学习，遇到横线即停车；N-第一次压过横线后再跑N圈
+ * @return 0-成功，-1-参数无效
+ */
+int lap_set_target(unsigned int laps);
+
+/**
+ * @brief 请求清除已学习的赛道，可在任意线程调用
+ * @note 寻迹任务在下一次进入寻迹模式或压过圈标时执行，本圈按原赛道跑完
+ */
+void lap_forget(void);
+
+/**
+ * @brief 进入寻迹模式时调用，清空本次的圈数和里程，已学习的赛道保留
+ */
+void lap_begin(unsigned int now_ms);
+
+/**
+ * @brief 按本控制周期的左右轮占空比累计里程和转角，学习圈内按段记录
+ */
+void lap_odometry(unsigned int now_ms, int left_duty, int right_duty);
+
+/**
+ * @brief 压过圈标横线时调用，结算上一圈并开始新的一圈
+ * @return LAP_MARK_CONTINUE/LAP_MARK_STOP/LAP_MARK_FINISH
+ * @note 每圈结束时通过UDP向最近一次发指令的客户端发送圈速
+ */
+int lap_mark(unsigned int now_ms);
+
+/**
+ * @brief 按已学习的赛道给出当前位置的前进占空比
+ * @param base_duty 基础占空比，未学习或学习圈内原样返回
+ */
+unsigned short lap_speed(unsigned short base_duty);
+
+#endif // ROBOT_LAP_H
@@ -0,0 +1,192 @@
+/*
+ * 黑线位置估计与PD寻迹控制模块
+ * 功能：两个红外传感器只能给出开关量，本模块把它们的跳变时刻当作测量：
+ *       每次跳变都说明黑线边缘恰好经过某个已知位置，据此修正横向偏移和偏移变化率；
+ *       两次跳变之间按左右轮速度外推，得到连续的偏移估计，再由PD控制输出差速占空比
+ *
+ * 坐标：偏移为黑线中心相对车头中线的横向位置(cm)，正值表示黑线在左侧
+ * 区域：根据两个传感器的读数把偏移分为5段
+ *       LOST_RIGHT | RIGHT(右传感器压线) | CENTER(都未压线) | LEFT(左传感器压线) | LOST_LEFT
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "robot_line.h"
+#include "robot_l9110s.h"
+#include "robot_ttc.h"
+
+#define LINE_SENSOR_AHEAD       (7.0f)      // 红外传感器在车轴前方的距离(cm)
+#define LINE_WHEEL_TRACK        (13.0f)     // 左右轮间距(cm)
+
+// 黑线中心处于以下位置时恰好有一侧边缘经过传感器
+#define LINE_EDGE_INNER         (LINE_SENSOR_SPACING / 2 - LINE_TAPE_WIDTH / 2)
+#define LINE_EDGE_OUTER         (LINE_SENSOR_SPACING / 2 + LINE_TAPE_WIDTH / 2)
+
+typedef enum {
+    LINE_ZONE_LOST_RIGHT = -2,
+    LINE_ZONE_RIGHT = -1,
+    LINE_ZONE_CENTER = 0,
+    LINE_ZONE_LEFT = 1,
+    LINE_ZONE_LOST_LEFT = 2
+} LineZone;
+
+static int g_line_zone = LINE_ZONE_CENTER;
+static float g_line_offset = 0.0f;          // 偏移估计(cm)
+static float g_line_rate = 0.0f;            // 车头与黑线夹角引起的偏移变化率(cm/s)
+static unsigned int g_line_predict_ms = 0;  // 上次外推时刻
+static int g_line_predict_valid = 0;
+static unsigned int g_line_edge_ms = 0;     // 上次跳变时刻
+static int g_line_edge_valid = 0;
+static int g_line_left_duty = 0;            // 最近一次输出，用于外推
+static int g_line_right_duty = 0;
+
+static float line_clampf(float value, float lo, float hi)
+{
+    if (value < lo) {
+        return lo;
+    }
+    return (value > hi) ? hi : value;
+}
+
+static float line_wheel_speed(int duty)
+{
+    float speed = ttc_speed_from_duty((unsigned short)((duty < 0) ? -duty : duty));
+    return (duty < 0) ? -speed : speed;
+}
+
+void line_reset(void)
+{
+    g_line_zone = LINE_ZONE_CENTER;
+    g_line_offset = 0.0f;
+    g_line_rate = 0.0f;
+    g_line_predict_ms = 0;
+    g_line_predict_valid = 0;
+    g_line_edge_ms = 0;
+    g_line_edge_valid = 0;
+    g_line_left_duty = 0;
+    g_line_right_duty = 0;
+}
+
+// 把偏移限制在当前区域对应的区间内
+static void line_clamp_zone(void)
+{
+    switch (g_line_zone) {
+        case LINE_ZONE_CENTER:
+            g_line_offset = line_clampf(g_line_offset, -LINE_EDGE_INNER, LINE_EDGE_INNER);
+            break;
+        case LINE_ZONE_LEFT:
+            g_line_offset = line_clampf(g_line_offset, LINE_EDGE_INNER, LINE_EDGE_OUTER);
+            break;
+        case LINE_ZONE_RIGHT:
+            g_line_offset = line_clampf(g_line_offset, -LINE_EDGE_OUTER, -LINE_EDGE_INNER);
+            break;
+        case LINE_ZONE_LOST_LEFT:
+            g_line_offset = LINE_OFFSET_LOST;
+            g_line_rate = 0.0f;
+            break;
+        default:
+            g_line_offset = -LINE_OFFSET_LOST;
+            g_line_rate = 0.0f;
+            break;
+    }
+}
+
+// 按上次输出的左右轮速度外推到now_ms
+// 车头转动使传感器处的黑线立即反向移动；车头与黑线的夹角只在跳变时修正，
+// 弯道中车身转向与黑线弯曲大致抵消，外推时不改变变化率
+static void line_predict(unsigned int now_ms)
+{
+    if (!g_line_predict_valid) {
+        g_line_predict_ms = now_ms;
+        g_line_predict_valid = 1;
+        return;
+    }
+
+    float dt = (now_ms - g_line_predict_ms) / 1000.0f;
+    float left = line_wheel_speed(g_line_left_duty);
+    float right = line_wheel_speed(g_line_right_duty);
+    float w = (right - left) / LINE_WHEEL_TRACK;
+
+    g_line_offset += (g_line_rate - w * LINE_SENSOR_AHEAD) * dt;
+    g_line_predict_ms = now_ms;
+    line_clamp_zone();
+}
+
+void line_observe(int left_black, int right_black, unsigned int now_ms)
+{
+    int zone = g_line_zone;
+
+    line_predict(now_ms);
+    if (left_black && right_black) {
+        return;     // 横线
+    }
+
+    if (left_black) {
+        zone = LINE_ZONE_LEFT;
+    } else if (right_black) {
+        zone = LINE_ZONE_RIGHT;
+    } else if (g_line_zone == LINE_ZONE_LEFT) {
+        // 离开传感器时按预测位置判断黑线是回到中间还是从外侧丢失
+        zone = (g_line_offset > LINE_SENSOR_SPACING / 2) ? LINE_ZONE_LOST_LEFT : LINE_ZONE_CENTER;
+    } else if (g_line_zone == LINE_ZONE_RIGHT) {
+        zone = (g_line_offset < -LINE_SENSOR_SPACING / 2) ? LINE_ZONE_LOST_RIGHT : LINE_ZONE_CENTER;
+    }
+    if (zone == g_line_zone) {
+        return;
+    }
+
+    if (abs(zone - g_line_zone) == 1) {
+        // 相邻区域之间的边界位置已知，用残差修正变化率，偏移直接取边界
+        int outer = (zone == LINE_ZONE_LOST_LEFT || zone == LINE_ZONE_LOST_RIGHT ||
+                     g_line_zone == LINE_ZONE_LOST_LEFT || g_line_zone == LINE_ZONE_LOST_RIGHT);
+        float boundary = outer ? LINE_EDGE_OUTER : LINE_EDGE_INNER;
+        if (zone + g_line_zone < 0) {
+            boundary = -boundary;
+        }
+        // 两次跳变间隔太短多半是传感器在胶带边缘抖动，不用来修正变化率
+        if (g_line_edge_valid && now_ms - g_line_edge_ms >= LINE_EDGE_MIN_MS) {
+            float dt = (now_ms - g_line_edge_ms) / 1000.0f;
+            g_line_rate = line_clampf(g_line_rate + LINE_FILTER_BETA * (boundary - g_line_offset) / dt,
+                                      -LINE_RATE_MAX, LINE_RATE_MAX);
+        }
+        g_line_offset = boundary;
+    } else {
+        // 跳过了中间区域，说明估计已不可信，取新区域中点重新开始
+        g_line_offset = (zone > 0) ? LINE_SENSOR_SPACING / 2 : -LINE_SENSOR_SPACING / 2;
+        g_line_rate = 0.0f;
+    }
+
+    g_line_zone = zone;
+    g_line_edge_ms = now_ms;
+    g_line_edge_valid = 1;
+    line_clamp_zone();
+}
+
+float line_get_offset(unsigned int now_ms)
+{
+    line_predict(now_ms);
+    return g_line_offset;
+}
+
+float line_get_rate(void)
+{
+    return g_line_rate;
+}
+
+void line_control(unsigned int now_ms, unsigned short base_duty, int *left_duty, int *right_duty)
+{
+    float offset = line_get_offset(now_ms);
+    float base = base_duty * (1.0f - LINE_SLOWDOWN * fabsf(offset));
+
+    if (base < LINE_MIN_DUTY) {
+        base = (base_duty < LINE_MIN_DUTY) ? base_duty : LINE_MIN_DUTY;
+    }
+
+    // 黑线在左侧时右轮加速、左轮减速
+    float diff = LINE_KP * offset + LINE_KD * g_line_rate;
+    g_line_left_duty = (int)line_clampf(base - diff, -PWM_DUTY_MAX, PWM_DUTY_MAX);
+    g_line_right_duty = (int)line_clampf(base + diff, -PWM_DUTY_MAX, PWM_DUTY_MAX);
+    *left_duty = g_line_left_duty;
+    *right_duty = g_line_right_duty;
+}
@@ -0,0 +1,54 @@
+#ifndef ROBOT_LINE_H
+#define ROBOT_LINE_H
+
+// 传感器和黑线几何参数(cm)
+#define LINE_SENSOR_SPACING     (3.0f)      // 左右红外传感器间距
+#define LINE_TAPE_WIDTH         (2.0f)      // 黑线宽度
+#define LINE_OFFSET_LOST        (3.5f)      // 黑线从外侧离开传感器后假定的偏移
+
+// 估计器参数：在传感器跳变时刻用已知的边界位置修正偏移和偏移变化率
+#define LINE_FILTER_BETA        (0.5f)      // 变化率修正增益
+#define LINE_RATE_MAX           (60.0f)     // 变化率上限(cm/s)
+#define LINE_EDGE_MIN_MS        (30)        // 与上次跳变间隔短于该值时不修正变化率
+
+// PD控制参数，输出为左右轮占空比差
+#define LINE_KP                 (4500.0f)   // 每cm偏移的占空比差
+#define LINE_KD                 (50.0f)     // 每cm/s变化率的占空比差
+#define LINE_SLOWDOWN           (0.12f)     // 每cm偏移降低的前进占空比比例
+#define LINE_MIN_DUTY           (4000)      // 弯道中的最低前进占空比
+
+/**
+ * @brief 清空估计状态，进入寻迹模式时调用
+ */
+void line_reset(void);
+
+/**
+ * @brief 输入一次红外传感器跳变
+ * @param left_black 左侧传感器是否压线
+ * @param right_black 右侧传感器是否压线
+ * @param now_ms 跳变时刻(ms)
+ * @note 两侧同时压线(横线)不提供偏移信息，只推进预测
+ */
+void line_observe(int left_black, int right_black, unsigned int now_ms);
+
+/**
+ * @brief 获取预测的黑线横向偏移(cm)，正值表示黑线在车头左侧
+ */
+float line_get_offset(unsigned int now_ms);
+
+/**
+ * @brief 获取偏移变化率(cm/s)
+ */
+float line_get_rate(void);
+
+/**
+ * @brief PD控制：根据预测偏移计算左右轮占空比
+ * @param now_ms 当前时刻(ms)
+ * @param base_duty 直道前进占空比
+ * @param left_duty 输出左轮占空比
+ * @param right_duty 输出右轮占空比
+ * @note 偏移越大前进占空比越低，脱线时内侧轮可以反转
+ */
+void line_control(unsigned int now_ms, unsigned short base_duty, int *left_duty, int *right_duty);
+
+#endif // ROBOT_LINE_H
@@ -0,0 +1,275 @@
+/*
+ * 舵机扫描测距模块
+ * 功能：舵机在可配置的角度范围内连续往返转动，每转到一个分区就测一次距离，
+ *       结果保存为 {角度, 距离, 时间戳} 极坐标图，供各模式随时读取
+ * 扫描期间舵机和超声波模块由扫描任务独占
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+#include "hi_time.h"
+
+#include "robot_scan.h"
+#include "robot_sg90.h"
+
+#define SCAN_EVENT_START    (1 << 0)
+
+extern float GetDistance(void);
+
+static ScanBin g_scan_map[SCAN_MAX_BINS];
+static unsigned int g_scan_bins = SCAN_DEFAULT_BINS;
+static int g_scan_min_angle = SCAN_DEFAULT_MIN_ANGLE;
+static int g_scan_max_angle = SCAN_DEFAULT_MAX_ANGLE;
+
+static unsigned int g_scan_index = 0;       // 下一个要测距的分区
+static int g_scan_direction = 1;            // 扫描方向，1-角度增大，-1-角度减小
+static unsigned int g_scan_step_ms = 0;     // 每步转动加测距的平均耗时，0表示还没有测过
+static volatile int g_scan_running = 0;     // 扫描开关
+static volatile int g_scan_busy = 0;        // 扫描任务正在测距
+static int g_scan_task_created = 0;
+
+static osMutexId_t g_scan_mutex = NULL;
+static osEventFlagsId_t g_scan_event = NULL;
+
+// 按当前配置重新计算各分区角度并清空数据，调用前需持有互斥锁
+// 扫描从最接近正前方的分区开始，尽快得到前方距离
+static void scan_layout(void)
+{
+    int best = SERVO_ANGLE_MAX * 2;
+
+    memset(g_scan_map, 0, sizeof(g_scan_map));
+    g_scan_index = 0;
+    for (unsigned int i = 0; i < g_scan_bins; i++) {
+        int angle = g_scan_min_angle;
+        if (g_scan_bins > 1) {
+            angle += (g_scan_max_angle - g_scan_min_angle) * (int)i / (int)(g_scan_bins - 1);
+        }
+        g_scan_map[i].angle = (short)angle;
+        if (abs(angle) < best) {
+            best = abs(angle);
+            g_scan_index = i;
+        }
+    }
+    g_scan_direction = 1;
+}
+
+// 转到下一个分区并测距
+static void scan_step(void)
+{
+    unsigned int begin = hi_get_milli_seconds();
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    unsigned int index = g_scan_index;
+    int angle = g_scan_map[index].angle;
+    osMutexRelease(g_scan_mutex);
+
+    servo_set_angle(angle);
+    servo_wait_settled();
+    float distance = GetDistance();
+    unsigned int now = hi_get_milli_seconds();
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    // 测距失败或测距期间配置已被修改时丢弃本次结果
+    if (distance > 0 && index < g_scan_bins && g_scan_map[index].angle == angle) {
+        g_scan_map[index].distance = distance;
+        g_scan_map[index].timestamp = (now != 0) ? now : 1;
+    }
+    // 每步耗时取滑动平均，舵机转角和回波时间不同，各步之间有差异
+    unsigned int elapsed = now - begin;
+    g_scan_step_ms = (g_scan_step_ms == 0) ? elapsed : (g_scan_step_ms * 3 + elapsed + 2) / 4;
+    // 到达端点后反向，往返扫描
+    if (g_scan_bins > 1) {
+        if ((g_scan_direction > 0 && g_scan_index + 1 >= g_scan_bins) ||
+            (g_scan_direction < 0 && g_scan_index == 0)) {
+            g_scan_direction = -g_scan_direction;
+        }
+        g_scan_index += g_scan_direction;
+    }
+    osMutexRelease(g_scan_mutex);
+}
+
+static void scan_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        // 先置忙再检查开关，保证scan_stop()返回后不会再有测距
+        g_scan_busy = 1;
+        if (!g_scan_running) {
+            g_scan_busy = 0;
+            osEventFlagsWait(g_scan_event, SCAN_EVENT_START, osFlagsWaitAny, osWaitForever);
+            continue;
+        }
+        scan_step();
+    }
+}
+
+static void scan_init(void)
+{
+    osThreadAttr_t attr;
+
+    if (g_scan_task_created) {
+        return;
+    }
+
+    g_scan_mutex = osMutexNew(NULL);
+    g_scan_event = osEventFlagsNew(NULL);
+    if (g_scan_mutex == NULL || g_scan_event == NULL) {
+        printf("[scan] Failed to create mutex or event!\n");
+        return;
+    }
+    scan_layout();
+
+    attr.name = "ScanTask";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = SCAN_TASK_STACK_SIZE;
+    attr.priority = SCAN_TASK_PRIORITY;
+
+    if (osThreadNew(scan_task, NULL, &attr) == NULL) {
+        printf("[scan] Failed to create ScanTask!\n");
+        return;
+    }
+    g_scan_task_created = 1;
+}
+
+int scan_config(int min_angle, int max_angle, unsigned int bins)
+{
+    if (bins == 0 || bins > SCAN_MAX_BINS || min_angle > max_angle ||
+        min_angle < -SERVO_ANGLE_MAX || max_angle > SERVO_ANGLE_MAX) {
+        return -1;
+    }
+
+    scan_init();
+    if (!g_scan_task_created) {
+        return -1;
+    }
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    g_scan_min_angle = min_angle;
+    g_scan_max_angle = max_angle;
+    g_scan_bins = bins;
+    scan_layout();
+    osMutexRelease(g_scan_mutex);
+    return 0;
+}
+
+void scan_start(void)
+{
+    scan_init();
+    if (!g_scan_task_created || g_scan_running) {
+        return;
+    }
+    g_scan_running = 1;
+    osEventFlagsSet(g_scan_event, SCAN_EVENT_START);
+}
+
+void scan_stop(void)
+{
+    g_scan_running = 0;
+    while (g_scan_busy) {
+        osDelay(1);
+    }
+}
+
+int scan_is_running(void)
+{
+    return g_scan_running;
+}
+
+unsigned int scan_get_map(ScanBin *bins, unsigned int max_bins)
+{
+    if (!g_scan_task_created || bins == NULL) {
+        return 0;
+    }
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    unsigned int count = (g_scan_bins < max_bins) ? g_scan_bins : max_bins;
+    memcpy(bins, g_scan_map, count * sizeof(ScanBin));
+    osMutexRelease(g_scan_mutex);
+    return count;
+}
+
+unsigned int scan_revisit_ms(int angle)
+{
+    unsigned int nearest = 0;
+    int best = SERVO_ANGLE_MAX * 2;
+
+    if (!g_scan_task_created) {
+        return 0;
+    }
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    for (unsigned int i = 0; i < g_scan_bins; i++) {
+        if (abs(g_scan_map[i].angle - angle) < best) {
+            best = abs(g_scan_map[i].angle - angle);
+            nearest = i;
+        }
+    }
+    // 离哪一端远，从这一侧折返回来的间隔就长
+    unsigned int farthest = (nearest > g_scan_bins - 1 - nearest) ? nearest : g_scan_bins - 1 - nearest;
+    unsigned int steps = (g_scan_bins > 1) ? farthest * 2 : 1;
+    unsigned int revisit = steps * g_scan_step_ms;
+    osMutexRelease(g_scan_mutex);
+    return revisit;
+}
+
+// 判断分区是否在角度范围内且数据足够新
+static int scan_bin_usable(const ScanBin *bin, int from_angle, int to_angle,
+                           unsigned int max_age_ms, unsigned int now)
+{
+    return bin->timestamp != 0 && bin->angle >= from_angle && bin->angle <= to_angle &&
+           now - bin->timestamp <= max_age_ms;
+}
+
+float scan_min_distance(int from_angle, int to_angle, unsigned int max_age_ms, unsigned int *timestamp)
+{
+    float result = -1.0f;
+    unsigned int now = hi_get_milli_seconds();
+
+    if (!g_scan_task_created) {
+        return result;
+    }
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    for (unsigned int i = 0; i < g_scan_bins; i++) {
+        const ScanBin *bin = &g_scan_map[i];
+        if (!scan_bin_usable(bin, from_angle, to_angle, max_age_ms, now)) {
+            continue;
+        }
+        if (result < 0 || bin->distance < result) {
+            result = bin->distance;
+            if (timestamp != NULL) {
+                *timestamp = bin->timestamp;
+            }
+        }
+    }
+    osMutexRelease(g_scan_mutex);
+    return result;
+}
+
+float scan_max_distance(int from_angle, int to_angle, unsigned int max_age_ms)
+{
+    float result = -1.0f;
+    unsigned int now = hi_get_milli_seconds();
+
+    if (!g_scan_task_created) {
+        return result;
+    }
+
+    osMutexAcquire(g_scan_mutex, osWaitForever);
+    for (unsigned int i = 0; i < g_scan_bins; i++) {
+        const ScanBin *bin = &g_scan_map[i];
+        if (scan_bin_usable(bin, from_angle, to_angle, max_age_ms, now) && bin->distance > result) {
+            result = bin->distance;
+        }
+    }
+    osMutexRelease(g_scan_mutex);
+    return result;
+}
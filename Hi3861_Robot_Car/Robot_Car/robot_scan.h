@@ -0,0 +1,78 @@
+#ifndef ROBOT_SCAN_H
+#define ROBOT_SCAN_H
+
+// 扫描参数
+#define SCAN_MAX_BINS           (37)        // 极坐标图最大分区数，±90度范围内最细5度一格
+#define SCAN_DEFAULT_MIN_ANGLE  (-60)       // 默认扫描范围(度)，正值向左
+#define SCAN_DEFAULT_MAX_ANGLE  (60)
+#define SCAN_DEFAULT_BINS       (7)         // 默认分区数，每20度一个测距点
+#define SCAN_FORWARD_CONE       (20)        // 视为正前方的角度范围(±度)
+
+// 扫描任务参数
+#define SCAN_TASK_STACK_SIZE    (2048)
+#define SCAN_TASK_PRIORITY      (25)
+
+// 极坐标图中的一个分区
+typedef struct {
+    short angle;                // 舵机角度(度)
+    float distance;             // 测得距离(cm)
+    unsigned int timestamp;     // 测距时刻(ms)，0表示尚无数据
+} ScanBin;
+
+/**
+ * @brief 配置扫描范围和分区数，已有数据被清空
+ * @param min_angle 扫描起始角度
+ * @param max_angle 扫描结束角度
+ * @param bins 分区数，1~SCAN_MAX_BINS
+ * @return 0-成功，-1-参数无效
+ */
+int scan_config(int min_angle, int max_angle, unsigned int bins);
+
+/**
+ * @brief 开始连续扫描，舵机在扫描范围内往返转动并在每个分区测距
+ */
+void scan_start(void);
+
+/**
+ * @brief 停止扫描，等待当前分区测距完成后返回
+ */
+void scan_stop(void);
+
+/**
+ * @brief 查询是否正在扫描
+ */
+int scan_is_running(void);
+
+/**
+ * @brief 复制一份极坐标图
+ * @param bins 输出缓冲区
+ * @param max_bins 缓冲区可容纳的分区数
+ * @return 实际复制的分区数
+ */
+unsigned int scan_get_map(ScanBin *bins, unsigned int max_bins);
+
+/**
+ * @brief 查询最接近指定角度的分区两次测距之间的最长间隔
+ * @param angle 舵机角度(度)
+ * @return 往返扫描时该分区的最长重访间隔(ms)，按实测的平均每步耗时计算；还没有完成过测距时返回0
+ * @note 往返扫描中端点分区每次往返只测一次，中间分区两次测距的间隔交替变化，这里取较长的一个
+ */
+unsigned int scan_revisit_ms(int angle);
+
+/**
+ * @brief 查询指定角度范围内最近障碍物的距离
+ * @param from_angle 起始角度
+ * @param to_angle 结束角度
+ * @param max_age_ms 只使用该时间内测得的数据
+ * @param timestamp 输出对应样本的测距时刻，可为NULL
+ * @return 最近距离(cm)，范围内没有有效数据时返回-1
+ */
+float scan_min_distance(int from_angle, int to_angle, unsigned int max_age_ms, unsigned int *timestamp);
+
+/**
+ * @brief 查询指定角度范围内最远的可通行距离
+ * @return 最远距离(cm)，范围内没有有效数据时返回-1
+ */
+float scan_max_distance(int from_angle, int to_angle, unsigned int max_age_ms);
+
+#endif // ROBOT_SCAN_H
@@ -0,0 +1,240 @@
+/*
+ * 节拍调度模块
+ * 功能：所有周期性工作都注册为作业，由一个1ms硬件定时器统一按周期和相位释放：
+ *       节拍上下文作业在定时器回调中直接执行，任务上下文作业交给一个工作任务按优先级依次执行；
+ *       每个作业统计执行时间，超出预算计超时，上一次释放还没执行完又被释放计漏执行
+ * 作业表只增不减，作业之间的开关通过sched_enable()切换，不再各自创建定时器和任务
+ * 任务侧对作业表的增加、开关和统计读取都在g_sched_mutex内进行；定时器回调和工作任务不能阻塞，
+ * 只读取已发布的作业数，作业数在表项填好后才增加，因此它们看到的表项总是完整的
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "hi_timer.h"
+
+#include "robot_sched.h"
+
+#define SCHED_EVENT_RELEASE     (1 << 0)
+
+typedef struct {
+    const SchedJobConfig *config;
+    volatile int enabled;
+    volatile int released;          // 已释放，等待工作任务执行
+    volatile int running;
+    unsigned int runs;
+    unsigned int overruns;          // 执行时间超出预算的次数
+    unsigned int misses;            // 释放时上一次还没执行完的次数
+    unsigned int max_us;
+    unsigned long long total_us;
+} SchedJob;
+
+static SchedJob g_sched_jobs[SCHED_MAX_JOBS];
+static volatile int g_sched_count = 0;
+static volatile unsigned int g_sched_tick = 0;
+static unsigned long long g_sched_start_us = 0;
+static int g_sched_ready = 0;
+
+static osMutexId_t g_sched_mutex = NULL;
+static osEventFlagsId_t g_sched_event = NULL;
+static unsigned int g_sched_timer = 0;
+
+// 执行一次作业并计时
+static void sched_run(SchedJob *job)
+{
+    unsigned long long begin = hi_get_us();
+    job->config->func();
+    unsigned int elapsed = (unsigned int)(hi_get_us() - begin);
+
+    job->runs++;
+    job->total_us += elapsed;
+    if (elapsed > job->max_us) {
+        job->max_us = elapsed;
+    }
+    if (elapsed > job->config->budget_us) {
+        job->overruns++;
+    }
+}
+
+// 硬件节拍：释放到期的作业，节拍上下文作业就地执行
+static void sched_tick(unsigned int arg)
+{
+    unsigned int tick = ++g_sched_tick;
+    int count = g_sched_count;
+    int wake = 0;
+
+    (void)arg;
+    for (int i = 0; i < count; i++) {
+        SchedJob *job = &g_sched_jobs[i];
+        const SchedJobConfig *config = job->config;
+        // 节拍未到相位前不释放，避免无符号减法回绕后误判
+        if (!job->enabled || tick < config->phase_ms || (tick - config->phase_ms) % config->period_ms != 0) {
+            continue;
+        }
+        if (config->context == SCHED_CTX_TICK) {
+            job->running = 1;
+            sched_run(job);
+            job->running = 0;
+            continue;
+        }
+        if (job->released || job->running) {
+            job->misses++;
+            continue;
+        }
+        job->released = 1;
+        wake = 1;
+    }
+    if (wake) {
+        osEventFlagsSet(g_sched_event, SCHED_EVENT_RELEASE);
+    }
+}
+
+// 取出优先级最高的已释放作业，没有时返回NULL
+static SchedJob *sched_next(void)
+{
+    SchedJob *best = NULL;
+    int count = g_sched_count;
+
+    for (int i = 0; i < count; i++) {
+        SchedJob *job = &g_sched_jobs[i];
+        if (job->released && (best == NULL || job->config->priority > best->config->priority)) {
+            best = job;
+        }
+    }
+    return best;
+}
+
+static void sched_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        osEventFlagsWait(g_sched_event, SCHED_EVENT_RELEASE, osFlagsWaitAny, osWaitForever);
+
+        SchedJob *job;
+        while ((job = sched_next()) != NULL) {
+            // 先置忙再检查开关，保证sched_enable()停用返回后不会再执行
+            job->running = 1;
+            job->released = 0;
+            if (job->enabled) {
+                sched_run(job);
+            }
+            job->running = 0;
+        }
+    }
+}
+
+static void sched_init(void)
+{
+    osThreadAttr_t attr;
+
+    if (g_sched_ready) {
+        return;
+    }
+
+    g_sched_mutex = osMutexNew(NULL);
+    g_sched_event = osEventFlagsNew(NULL);
+    if (g_sched_mutex == NULL || g_sched_event == NULL) {
+        printf("[sched] Failed to create mutex or event!\n");
+        return;
+    }
+
+    attr.name = "SchedTask";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = SCHED_TASK_STACK_SIZE;
+    attr.priority = SCHED_TASK_PRIORITY;
+
+    if (osThreadNew(sched_task, NULL, &attr) == NULL) {
+        printf("[sched] Failed to create SchedTask!\n");
+        return;
+    }
+
+    g_sched_start_us = hi_get_us();
+    hi_timer_create(&g_sched_timer);
+    hi_timer_start(g_sched_timer, HI_TIMER_TYPE_PERIOD, SCHED_TICK_MS, sched_tick, 0);
+    g_sched_ready = 1;
+}
+
+int sched_add(const SchedJobConfig *config)
+{
+    int id;
+
+    if (config == NULL || config->func == NULL || config->period_ms == 0) {
+        return -1;
+    }
+
+    sched_init();
+    if (!g_sched_ready) {
+        return -1;
+    }
+
+    osMutexAcquire(g_sched_mutex, osWaitForever);
+    id = g_sched_count;
+    if (id >= SCHED_MAX_JOBS) {
+        osMutexRelease(g_sched_mutex);
+        printf("[sched] job table full, %s not added\n", config->name);
+        return -1;
+    }
+    // 先填好表项再增加计数，定时器回调只会看到完整的作业
+    memset(&g_sched_jobs[id], 0, sizeof(SchedJob));
+    g_sched_jobs[id].config = config;
+    g_sched_count = id + 1;
+    osMutexRelease(g_sched_mutex);
+    return id;
+}
+
+void sched_enable(int id, int enable)
+{
+    if (!g_sched_ready) {
+        return;
+    }
+
+    osMutexAcquire(g_sched_mutex, osWaitForever);
+    if (id < 0 || id >= g_sched_count) {
+        osMutexRelease(g_sched_mutex);
+        return;
+    }
+    SchedJob *job = &g_sched_jobs[id];
+    job->enabled = enable ? 1 : 0;
+    if (!enable) {
+        job->released = 0;
+    }
+    osMutexRelease(g_sched_mutex);
+
+    // 等待时不持锁，其他任务照常增加或开关作业
+    while (!enable && job->running) {
+        osDelay(1);
+    }
+}
+
+void sched_report(void)
+{
+    if (!g_sched_ready) {
+        return;
+    }
+
+    osMutexAcquire(g_sched_mutex, osWaitForever);
+    unsigned long long elapsed_us = hi_get_us() - g_sched_start_us;
+    int count = g_sched_count;
+
+    printf("[sched] %-10s %4s %6s %5s %4s %6s %8s %6s %6s %5s %5s %6s\n", "job", "ctx", "period", "phase",
+           "prio", "budget", "runs", "avg", "max", "over", "miss", "load");
+    for (int i = 0; i < count; i++) {
+        SchedJob *job = &g_sched_jobs[i];
+        const SchedJobConfig *config = job->config;
+        unsigned int avg_us = (job->runs > 0) ? (unsigned int)(job->total_us / job->runs) : 0;
+        double load = (elapsed_us > 0) ? job->total_us * 100.0 / elapsed_us : 0.0;
+
+        printf("[sched] %-10s %4s %6u %5u %4u %6u %8u %6u %6u %5u %5u %5.2f%%\n", config->name,
+               (config->context == SCHED_CTX_TICK) ? "tick" : "task", config->period_ms, config->phase_ms,
+               config->priority, config->budget_us, job->runs, avg_us, job->max_us, job->overruns,
+               job->misses, load);
+    }
+    osMutexRelease(g_sched_mutex);
+}
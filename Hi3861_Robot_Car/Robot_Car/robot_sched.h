@@ -0,0 +1,46 @@
+#ifndef ROBOT_SCHED_H
+#define ROBOT_SCHED_H
+
+// 调度器参数
+#define SCHED_MAX_JOBS          (12)        // 作业表容量，不超过事件标志可用位数
+#define SCHED_TICK_MS           (1)         // 硬件定时器节拍(ms)，作业周期和相位都以节拍为单位
+#define SCHED_TASK_STACK_SIZE   (4096)      // 任务上下文作业共用一个工作任务，栈按最大的作业分配
+#define SCHED_TASK_PRIORITY     (24)        // 低于模式任务，测距和遥测不耽误寻迹转向
+
+// 作业执行上下文
+typedef enum {
+    SCHED_CTX_TICK = 0,     // 在定时器回调中直接执行，只能做不阻塞的短作业，如采样红外
+    SCHED_CTX_TASK          // 由工作任务执行，可以阻塞或忙等，如测距、刷屏、发送遥测
+} SchedContext;
+
+// 作业描述，注册后不再修改
+typedef struct {
+    const char *name;
+    void (*func)(void);
+    unsigned int period_ms;     // 释放周期
+    unsigned int phase_ms;      // 相位，节拍数满足(tick - phase) % period == 0时释放，用来错开同周期的作业
+    unsigned char priority;     // 同时待执行时数值大的先执行，只对任务上下文作业有意义
+    unsigned char context;      // SchedContext
+    unsigned int budget_us;     // 单次执行时间预算，超出计一次超时
+} SchedJobConfig;
+
+/**
+ * @brief 注册一个作业，注册后处于停用状态
+ * @param config 作业描述，需在整个运行期间有效
+ * @return 作业编号，失败返回-1
+ */
+int sched_add(const SchedJobConfig *config);
+
+/**
+ * @brief 启用或停用作业
+ * @param id sched_add()返回的作业编号
+ * @param enable 1-启用，0-停用；停用时等待正在执行的本作业完成后返回，不能在作业自身中停用
+ */
+void sched_enable(int id, int enable);
+
+/**
+ * @brief 打印各作业的执行次数、平均/最长执行时间、超时和漏执行次数
+ */
+void sched_report(void);
+
+#endif // ROBOT_SCHED_H
@@ -1,59 +1,215 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <memory.h>
-
-#include "ohos_init.h"
-#include "cmsis_os2.h"
-#include "iot_gpio.h"
-#include "hi_io.h"
-#include "hi_time.h"
-
-//查阅机器人板原理图可知，SG90舵机通过GPIO2与3861连接
-//SG90舵机的控制需要MCU产生一个周期为20ms的脉冲信号，以0.5ms到2.5ms的高电平来控制舵机转动的角度
-#define GPIO2 2
-
-//输出20000微秒的脉冲信号(x微秒高电平,20000-x微秒低电平)
-void set_angle( unsigned int duty) {
-    IoTGpioSetDir(GPIO2, IOT_GPIO_DIR_OUT);//设置GPIO2为输出模式
-
-    //GPIO2输出x微秒高电平
-    IoTGpioSetOutputVal(GPIO2, IOT_GPIO_VALUE1);
-    hi_udelay(duty);
-
-    //GPIO2输出20000-x微秒低电平
-    IoTGpioSetOutputVal(GPIO2, IOT_GPIO_VALUE0);
-    hi_udelay(20000 - duty);
-}
-
-/*
-1、依据角度与脉冲的关系，设置高电平时间为1000微秒
-2、发送10次脉冲信号，控制舵机向左旋转45度
-*/
-void engine_turn_left(void)
-{
-    for (int i = 0; i <10; i++) {
-        set_angle(1000);
-    }
-}
-
-/*t
-1、依据角度与脉冲的关系，设置高电平时间为2000微秒
-2、发送10次脉冲信号，控制舵机向右旋转45度
-*/
-void engine_turn_right(void)
-{
-    for (int i = 0; i <10; i++) {
-        set_angle(2000);
-    }
-}
-
-/*
-1、依据角度与脉冲的关系，设置高电平时间为1500微秒
-2、发送10次脉冲信号，控制舵机居中
-*/
-void regress_middle(void)
-{
-    for (int i = 0; i <10; i++) {
-        set_angle(1500);
-    }
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+#include "iot_gpio.h"
+#include "hi_io.h"
+#include "hi_time.h"
+#include "hi_hrtimer.h"
+
+#include "robot_sg90.h"
+
+//查阅机器人板原理图可知，SG90舵机通过GPIO2与3861连接
+//SG90舵机的控制需要MCU产生一个周期为20ms的脉冲信号，以0.5ms到2.5ms的高电平来控制舵机转动的角度
+//PWM的分频系数只有16位，无法分出50Hz，所以用高精度硬件定时器在后台翻转GPIO2产生脉冲
+#define GPIO2 2
+#define GPIO_FUNC 0
+
+// 标定表：-90、-45、0、+45、+90度对应的脉宽，默认值为SG90标称值
+// 每个舵机的中位和端点不同，装车后用servo_set_calibration()写入实测值
+static unsigned short g_servo_cal[SERVO_CAL_POINTS] = {2500, 2000, 1500, 1000, 500};
+
+static unsigned int g_servo_timer_id = 0;
+static volatile int g_servo_initialized = 0;
+static volatile int g_servo_angle = SERVO_ANGLE_MIDDLE;            // 目标角度
+static volatile unsigned int g_servo_pulse_us = 0;                 // 目标脉宽
+static volatile unsigned int g_servo_active_us = 0;                // 当前周期正在输出的脉宽
+static volatile int g_servo_level_high = 0;
+
+// 转动时间模型：记录本次转动的起点、终点和时间，按线性插值估计当前位置
+static float g_servo_slew_rate = SERVO_SLEW_RATE_DEFAULT;
+static int g_servo_position_known = 0;                             // 上电后位置未知
+static int g_servo_move_from = SERVO_ANGLE_MIDDLE;
+static unsigned int g_servo_move_start_ms = 0;
+static unsigned int g_servo_move_time_ms = 0;
+
+// 角度转换为脉宽：在标定表相邻两点间线性插值
+static unsigned int servo_angle_to_us(int deg)
+{
+    int offset = deg + SERVO_ANGLE_MAX;
+    int index = offset / SERVO_CAL_STEP;
+
+    if (index >= SERVO_CAL_POINTS - 1) {
+        return g_servo_cal[SERVO_CAL_POINTS - 1];
+    }
+    int lo = g_servo_cal[index];
+    int hi = g_servo_cal[index + 1];
+    return (unsigned int)(lo + (hi - lo) * (offset - index * SERVO_CAL_STEP) / SERVO_CAL_STEP);
+}
+
+int servo_set_calibration(const unsigned short table[SERVO_CAL_POINTS])
+{
+    int direction = (table[SERVO_CAL_POINTS - 1] > table[0]) ? 1 : -1;
+
+    for (int i = 0; i < SERVO_CAL_POINTS; i++) {
+        if (table[i] < SERVO_PULSE_MIN_US || table[i] > SERVO_PULSE_MAX_US) {
+            return -1;
+        }
+        if (i > 0 && ((int)table[i] - (int)table[i - 1]) * direction <= 0) {
+            return -1;
+        }
+    }
+
+    memcpy(g_servo_cal, table, sizeof(g_servo_cal));
+    // 按新标定重新输出当前目标角度
+    g_servo_pulse_us = servo_angle_to_us(g_servo_angle);
+    return 0;
+}
+
+void servo_get_calibration(unsigned short table[SERVO_CAL_POINTS])
+{
+    memcpy(table, g_servo_cal, sizeof(g_servo_cal));
+}
+
+//硬件定时器回调(中断上下文)：交替输出高电平和低电平，每个周期开始时锁存目标脉宽
+static void servo_timer_callback(unsigned int arg)
+{
+    hi_unref_param(arg);
+
+    if (!g_servo_level_high) {
+        g_servo_active_us = g_servo_pulse_us;
+        IoTGpioSetOutputVal(GPIO2, IOT_GPIO_VALUE1);
+        g_servo_level_high = 1;
+        hi_hrtimer_start(g_servo_timer_id, g_servo_active_us, servo_timer_callback, 0);
+    } else {
+        IoTGpioSetOutputVal(GPIO2, IOT_GPIO_VALUE0);
+        g_servo_level_high = 0;
+        hi_hrtimer_start(g_servo_timer_id, SERVO_PERIOD_US - g_servo_active_us, servo_timer_callback, 0);
+    }
+}
+
+void servo_init(void)
+{
+    if (g_servo_initialized) {
+        return;
+    }
+
+    IoTGpioInit(GPIO2);
+    hi_io_set_func(GPIO2, GPIO_FUNC);
+    IoTGpioSetDir(GPIO2, IOT_GPIO_DIR_OUT);//设置GPIO2为输出模式
+    IoTGpioSetOutputVal(GPIO2, IOT_GPIO_VALUE0);
+
+    if (hi_hrtimer_create(&g_servo_timer_id) != 0) {
+        printf("servo hrtimer create failed\r\n");
+        return;
+    }
+    g_servo_pulse_us = servo_angle_to_us(g_servo_angle);
+    g_servo_initialized = 1;
+    g_servo_level_high = 0;
+    hi_hrtimer_start(g_servo_timer_id, SERVO_PERIOD_US, servo_timer_callback, 0);
+}
+
+void servo_set_angle(int deg)
+{
+    if (deg > SERVO_ANGLE_MAX) {
+        deg = SERVO_ANGLE_MAX;
+    } else if (deg < -SERVO_ANGLE_MAX) {
+        deg = -SERVO_ANGLE_MAX;
+    }
+
+    int first = !g_servo_initialized;
+    servo_init();
+
+    unsigned int pulse_us = servo_angle_to_us(deg);
+    if (!first && pulse_us == g_servo_pulse_us) {
+        return;
+    }
+
+    // 从当前估计位置出发计算本次转动所需时间，位置未知时按最大行程估计
+    int travel = SERVO_ANGLE_MAX * 2;
+    if (g_servo_position_known) {
+        travel = abs(deg - servo_get_position());
+    }
+    g_servo_move_from = g_servo_position_known ? servo_get_position() : deg;
+    g_servo_move_start_ms = hi_get_milli_seconds();
+    g_servo_move_time_ms = (unsigned int)(travel / g_servo_slew_rate) + SERVO_DEAD_TIME_MS;
+    g_servo_position_known = 1;
+
+    g_servo_pulse_us = pulse_us;
+    g_servo_angle = deg;
+}
+
+int servo_get_angle(void)
+{
+    return g_servo_angle;
+}
+
+int servo_get_position(void)
+{
+    unsigned int elapsed = hi_get_milli_seconds() - g_servo_move_start_ms;
+
+    if (!g_servo_position_known || elapsed >= g_servo_move_time_ms) {
+        return g_servo_angle;
+    }
+    return g_servo_move_from +
+           (g_servo_angle - g_servo_move_from) * (int)elapsed / (int)g_servo_move_time_ms;
+}
+
+unsigned int servo_settle_time(void)
+{
+    unsigned int elapsed = hi_get_milli_seconds() - g_servo_move_start_ms;
+
+    if (!g_servo_initialized || elapsed >= g_servo_move_time_ms) {
+        return 0;
+    }
+    return g_servo_move_time_ms - elapsed;
+}
+
+int servo_is_settled(void)
+{
+    return servo_settle_time() == 0;
+}
+
+void servo_wait_settled(void)
+{
+    unsigned int remain = servo_settle_time();
+
+    if (remain > 0) {
+        hi_sleep(remain);
+    }
+}
+
+void servo_set_slew_rate(float deg_per_ms)
+{
+    if (deg_per_ms > 0.0f) {
+        g_servo_slew_rate = deg_per_ms;
+    }
+}
+
+float servo_get_slew_rate(void)
+{
+    return g_servo_slew_rate;
+}
+
+//舵机向左旋转45度
+void engine_turn_left(void)
+{
+    servo_set_angle(SERVO_ANGLE_LEFT);
+    servo_wait_settled();
+}
+
+//舵机向右旋转45度
+void engine_turn_right(void)
+{
+    servo_set_angle(SERVO_ANGLE_RIGHT);
+    servo_wait_settled();
+}
+
+//舵机居中
+void regress_middle(void)
+{
+    servo_set_angle(SERVO_ANGLE_MIDDLE);
+    servo_wait_settled();
+}
@@ -0,0 +1,90 @@
+#ifndef ROBOT_SG90_H
+#define ROBOT_SG90_H
+
+// 舵机角度定义(度)，正值向左，负值向右
+#define SERVO_ANGLE_LEFT        (45)
+#define SERVO_ANGLE_MIDDLE      (0)
+#define SERVO_ANGLE_RIGHT       (-45)
+#define SERVO_ANGLE_MAX         (90)
+
+// 脉冲参数
+#define SERVO_PERIOD_US         (20000)     // 脉冲周期20ms
+
+// 单体标定表：在-90、-45、0、+45、+90度五个点记录实际脉宽(微秒)，中间角度线性插值
+#define SERVO_CAL_POINTS        (5)
+#define SERVO_CAL_STEP          (45)        // 标定点角度间隔(度)
+#define SERVO_PULSE_MIN_US      (400)       // 标定值允许范围
+#define SERVO_PULSE_MAX_US      (2600)
+
+// 转动时间模型：到位时间 = 转动角度 / 转速 + 固定延迟
+// SG90标称0.1s/60度(4.8V)，默认值留有余量，可用servo_set_slew_rate()按实测标定
+#define SERVO_SLEW_RATE_DEFAULT (0.4f)      // 转速(度/ms)
+#define SERVO_DEAD_TIME_MS      (30)        // 新脉宽生效(最多一个周期)+舵机响应延迟
+
+/**
+ * @brief 初始化舵机GPIO和硬件定时器，开始在后台输出脉冲
+ * @note 首次调用servo_set_angle()时会自动初始化
+ */
+void servo_init(void);
+
+/**
+ * @brief 设置舵机目标角度，立即返回
+ * @param deg 目标角度，范围-90~+90，正值向左
+ */
+void servo_set_angle(int deg);
+
+/**
+ * @brief 设置本舵机的标定表
+ * @param table 依次为-90、-45、0、+45、+90度对应的脉宽(微秒)，需单调变化
+ * @return 0-成功，-1-标定值超出范围或不单调
+ */
+int servo_set_calibration(const unsigned short table[SERVO_CAL_POINTS]);
+
+/**
+ * @brief 读取当前标定表
+ */
+void servo_get_calibration(unsigned short table[SERVO_CAL_POINTS]);
+
+/**
+ * @brief 获取最近一次设置的目标角度
+ */
+int servo_get_angle(void);
+
+/**
+ * @brief 按转动时间模型估计舵机当前所在角度
+ */
+int servo_get_position(void);
+
+/**
+ * @brief 查询舵机是否已转到目标角度
+ * @return 1-已到位，0-仍在转动
+ */
+int servo_is_settled(void);
+
+/**
+ * @brief 获取距离预计到位还需的时间(ms)，已到位时返回0
+ */
+unsigned int servo_settle_time(void);
+
+/**
+ * @brief 等待舵机到位，按预计到位时间休眠，等待期间让出CPU
+ */
+void servo_wait_settled(void);
+
+/**
+ * @brief 设置转动时间模型的转速
+ * @param deg_per_ms 转速(度/ms)，需大于0
+ */
+void servo_set_slew_rate(float deg_per_ms);
+
+/**
+ * @brief 获取转动时间模型的转速(度/ms)
+ */
+float servo_get_slew_rate(void);
+
+// 兼容原有接口：转到指定位置并等待到位
+void engine_turn_left(void);
+void engine_turn_right(void);
+void regress_middle(void);
+
+#endif // ROBOT_SG90_H
@@ -0,0 +1,170 @@
+/*
+ * 碰撞时间(TTC)估计模块
+ * 功能：根据连续的超声波测距样本估计接近速度和碰撞时间，
+ *       结合当前占空比对应的刹车距离决定是否需要刹车
+ * 避障、寻迹、远控三种模式共用同一套估计和刹车判定
+ */
+
+#include <stdio.h>
+
+#include "robot_ttc.h"
+
+// 占空比 -> 车速/刹车距离 对照表
+// g_stop_model_default是未标定的默认值：按TT减速电机空载转速估算，没有任何一项在实车上测量过，
+// 刹车判定和避障通过速度统计都依赖它，实车上可能偏早或偏晚刹车；
+// 标定方法：以固定占空比直行，测量稳定车速，再记录car_stop()后的滑行距离，
+// 测得后替换本表并把TTC_STOP_MODEL_CALIBRATED改为1，更换电机或电池后需重新测量
+typedef struct {
+    unsigned short duty;    // 前进占空比
+    float speed;            // 稳定车速(cm/s)
+    float stop_distance;    // car_stop()后的滑行距离(cm)
+} TtcStopModel;
+
+static const TtcStopModel g_stop_model_default[] = {
+    {0,    0.0f,  0.0f},
+    {4000, 22.0f, 2.0f},
+    {5000, 31.0f, 3.5f},
+    {6000, 40.0f, 5.5f},
+    {7000, 48.0f, 8.0f},
+    {8000, 55.0f, 11.0f},
+};
+
+static const TtcStopModel *const g_stop_model = g_stop_model_default;
+#define TTC_MODEL_SIZE (sizeof(g_stop_model_default) / sizeof(g_stop_model_default[0]))
+
+static float g_ttc_distance = 0.0f;       // 滤波后距离(cm)
+static float g_ttc_velocity = 0.0f;       // 距离变化率(cm/s)，靠近时为负
+static unsigned int g_ttc_last_ms = 0;    // 上次样本时刻
+static unsigned int g_ttc_samples = 0;    // 当前序列中的有效样本数
+
+void ttc_reset(void)
+{
+#if !TTC_STOP_MODEL_CALIBRATED
+    static int warned = 0;
+    if (!warned) {
+        printf("[ttc] stop model is an uncalibrated default, braking distances are estimates\n");
+        warned = 1;
+    }
+#endif
+    g_ttc_distance = 0.0f;
+    g_ttc_velocity = 0.0f;
+    g_ttc_last_ms = 0;
+    g_ttc_samples = 0;
+}
+
+void ttc_update(float distance, unsigned int now_ms, unsigned int timeout_ms)
+{
+    unsigned int dt_ms = now_ms - g_ttc_last_ms;
+
+    // 超出量程的回波视为前方无障碍物，丢弃已有的估计
+    if (distance <= 0.0f || distance > TTC_DISTANCE_MAX) {
+        ttc_reset();
+        return;
+    }
+
+    if (g_ttc_samples == 0 || dt_ms > timeout_ms) {
+        g_ttc_distance = distance;
+        g_ttc_velocity = 0.0f;
+        g_ttc_samples = 1;
+        g_ttc_last_ms = now_ms;
+        return;
+    }
+    if (dt_ms == 0) {
+        return;
+    }
+
+    // α-β滤波：先按上次速度外推，再用测量残差修正距离和速度
+    float dt = dt_ms / 1000.0f;
+    float predicted = g_ttc_distance + g_ttc_velocity * dt;
+    float residual = distance - predicted;
+    g_ttc_distance = predicted + TTC_FILTER_ALPHA * residual;
+    g_ttc_velocity += TTC_FILTER_BETA * residual / dt;
+
+    g_ttc_last_ms = now_ms;
+    if (g_ttc_samples < 0xFFFF) {
+        g_ttc_samples++;
+    }
+}
+
+float ttc_get_distance(void)
+{
+    return g_ttc_distance;
+}
+
+float ttc_get_closing_speed(void)
+{
+    return -g_ttc_velocity;
+}
+
+float ttc_get_time_to_collision(void)
+{
+    float closing = ttc_get_closing_speed();
+    if (g_ttc_samples < 2 || closing <= 0.0f) {
+        return TTC_INFINITE;
+    }
+    return g_ttc_distance / closing;
+}
+
+// 在对照表中按占空比线性插值，field为0取车速，为1取刹车距离
+static float ttc_model_lookup(unsigned short duty, int field)
+{
+    const TtcStopModel *lo = &g_stop_model[0];
+    const TtcStopModel *hi = &g_stop_model[TTC_MODEL_SIZE - 1];
+
+    if (duty >= hi->duty) {
+        return field ? hi->stop_distance : hi->speed;
+    }
+    for (unsigned int i = 1; i < TTC_MODEL_SIZE; i++) {
+        if (duty <= g_stop_model[i].duty) {
+            lo = &g_stop_model[i - 1];
+            hi = &g_stop_model[i];
+            break;
+        }
+    }
+
+    float t = (float)(duty - lo->duty) / (float)(hi->duty - lo->duty);
+    float a = field ? lo->stop_distance : lo->speed;
+    float b = field ? hi->stop_distance : hi->speed;
+    return a + (b - a) * t;
+}
+
+float ttc_speed_from_duty(unsigned short duty)
+{
+    return ttc_model_lookup(duty, 0);
+}
+
+float ttc_stopping_distance(unsigned short duty)
+{
+    return ttc_model_lookup(duty, 1);
+}
+
+int ttc_should_brake(unsigned short duty, unsigned int now_ms)
+{
+    if (g_ttc_samples == 0) {
+        return 0;
+    }
+
+    // 样本不足以估计速度时，按静止障碍物处理，接近速度取对照表车速
+    float closing = ttc_get_closing_speed();
+    if (g_ttc_samples < 2) {
+        closing = ttc_speed_from_duty(duty);
+    }
+
+    // 距离外推到当前时刻：上次样本之后车还在靠近，远离时不外推
+    float distance = g_ttc_distance;
+    if (closing > 0.0f) {
+        distance -= closing * (now_ms - g_ttc_last_ms) / 1000.0f;
+    }
+
+    float stop_distance = ttc_stopping_distance(duty) + TTC_MIN_CLEARANCE;
+    if (distance <= stop_distance) {
+        return 1;
+    }
+    if (closing <= 0.0f) {
+        return 0;
+    }
+
+    // TTC <= 反应时间 + 刹车所需时间
+    float ttc = distance / closing;
+    return ttc <= TTC_REACTION_TIME + stop_distance / closing;
+}
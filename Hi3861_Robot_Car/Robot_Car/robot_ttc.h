@@ -0,0 +1,63 @@
+#ifndef ROBOT_TTC_H
+#define ROBOT_TTC_H
+
+// α-β滤波器参数：由相邻两次测距估计距离和接近速度
+#define TTC_FILTER_ALPHA        (0.6f)      // 距离修正增益
+#define TTC_FILTER_BETA         (0.2f)      // 速度修正增益
+#define TTC_SAMPLE_TIMEOUT_MS   (500)       // 固定周期测距时的样本间隔上限，间隔超过它时重新开始估计
+#define TTC_DISTANCE_MAX        (400.0f)    // HC-SR04有效量程上限(cm)，超出视为无效样本
+
+// 刹车判定参数
+#define TTC_REACTION_TIME       (0.08f)     // 测距+控制链路的反应时间(s)
+#define TTC_MIN_CLEARANCE       (5.0f)      // 刹停后与障碍物保留的最小间隙(cm)
+#define TTC_INFINITE            (99.0f)     // 不在接近时返回的碰撞时间(s)
+#define TTC_STOP_MODEL_CALIBRATED (0)       // 0-占空比对照表是未经实测的默认值；在实车上测得并替换后改为1
+
+/**
+ * @brief 清空估计状态，小车改变运动方向或切换模式后调用
+ */
+void ttc_reset(void);
+
+/**
+ * @brief 输入一次测距样本
+ * @param distance 超声波测得的前方距离(cm)
+ * @param now_ms 采样时刻(ms)
+ * @param timeout_ms 与上一个样本的间隔超过该值时重新开始估计，按测距来源的实际样本间隔给出
+ */
+void ttc_update(float distance, unsigned int now_ms, unsigned int timeout_ms);
+
+/**
+ * @brief 获取滤波后的前方距离(cm)
+ */
+float ttc_get_distance(void);
+
+/**
+ * @brief 获取接近速度(cm/s)，正值表示正在靠近障碍物
+ */
+float ttc_get_closing_speed(void);
+
+/**
+ * @brief 获取碰撞时间(s)，未在接近时返回TTC_INFINITE
+ */
+float ttc_get_time_to_collision(void);
+
+/**
+ * @brief 根据前进占空比查对照表得到车速(cm/s)
+ */
+float ttc_speed_from_duty(unsigned short duty);
+
+/**
+ * @brief 根据前进占空比查对照表得到刹车距离(cm)
+ */
+float ttc_stopping_distance(unsigned short duty);
+
+/**
+ * @brief 判断以当前占空比前进时是否需要立即刹车
+ * @param duty 当前前进占空比
+ * @param now_ms 当前时刻(ms)，距离按接近速度从上次样本外推到该时刻
+ * @return 1-需要刹车，0-可以继续前进
+ * @note 碰撞时间小于 反应时间 + 刹车距离/接近速度 时返回1
+ */
+int ttc_should_brake(unsigned short duty, unsigned int now_ms);
+
+#endif // ROBOT_TTC_H
@@ -0,0 +1,100 @@
+/*
+ * 向量场直方图(VFH)避障规划模块
+ * 功能：把舵机扫描得到的极坐标距离图转换为二值障碍直方图，
+ *       在足够宽的可通行扇区中选择最接近期望方向的一个，
+ *       输出左右轮差速占空比，使小车边走边转绕开障碍物
+ */
+
+#include <stdlib.h>
+
+#include "robot_vfh.h"
+#include "robot_l9110s.h"
+
+// 各分区的障碍状态，带滞回，避免距离在阈值附近抖动时方向来回跳变
+static unsigned char g_vfh_blocked[SCAN_MAX_BINS];
+
+void vfh_reset(void)
+{
+    for (unsigned int i = 0; i < SCAN_MAX_BINS; i++) {
+        g_vfh_blocked[i] = 0;
+    }
+}
+
+// 更新单个分区的障碍状态，数据过期的分区按有障碍处理
+static int vfh_bin_blocked(const ScanBin *bin, unsigned int index, unsigned int now)
+{
+    if (bin->timestamp == 0 || now - bin->timestamp > VFH_MAP_MAX_AGE) {
+        g_vfh_blocked[index] = 1;
+    } else if (bin->distance < VFH_BLOCKED_DISTANCE) {
+        g_vfh_blocked[index] = 1;
+    } else if (bin->distance > VFH_CLEAR_DISTANCE) {
+        g_vfh_blocked[index] = 0;
+    }
+    return g_vfh_blocked[index];
+}
+
+static int vfh_clamp(int value, int lo, int hi)
+{
+    if (value < lo) {
+        return lo;
+    }
+    return (value > hi) ? hi : value;
+}
+
+int vfh_plan(const ScanBin *bins, unsigned int count, unsigned int now,
+             int goal, unsigned short base_duty, VfhResult *result)
+{
+    int best_cost = -1;
+    int best_steer = 0;
+    int best_width = 0;
+    int start = -1;
+
+    if (count < 2 || count > SCAN_MAX_BINS) {
+        return -1;
+    }
+    int step = bins[1].angle - bins[0].angle;
+    int half = VFH_MIN_SECTOR / 2;
+
+    // 一次遍历找出所有连续可通行扇区，多遍历一个位置用于收尾最后一个扇区
+    for (unsigned int i = 0; i <= count; i++) {
+        int blocked = (i == count) ? 1 : vfh_bin_blocked(&bins[i], i, now);
+        if (!blocked) {
+            if (start < 0) {
+                start = (int)i;
+            }
+            continue;
+        }
+        if (start < 0) {
+            continue;
+        }
+
+        int edge_lo = bins[start].angle - step / 2;
+        int edge_hi = bins[i - 1].angle + step / 2;
+        int width = edge_hi - edge_lo;
+        start = -1;
+        if (width < VFH_MIN_SECTOR) {
+            continue;
+        }
+
+        // 扇区内离两侧边界至少半个车身宽度的方向中，取最接近期望方向的一个
+        int steer = vfh_clamp(goal, edge_lo + half, edge_hi - half);
+        int cost = abs(steer - goal);
+        if (best_cost < 0 || cost < best_cost || (cost == best_cost && width > best_width)) {
+            best_cost = cost;
+            best_steer = steer;
+            best_width = width;
+        }
+    }
+
+    if (best_cost < 0) {
+        return -1;
+    }
+
+    // 向左转时左轮减速、右轮加速，转向角达到VFH_STEER_FULL时内侧轮停转
+    int diff = (int)base_duty * vfh_clamp(best_steer, -VFH_STEER_FULL, VFH_STEER_FULL) / VFH_STEER_FULL;
+    result->steer = best_steer;
+    result->width = best_width;
+    result->left_duty = vfh_clamp(base_duty - diff, 0, PWM_DUTY_MAX);
+    result->right_duty = vfh_clamp(base_duty + diff, 0, PWM_DUTY_MAX);
+    return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef ROBOT_VFH_H
+#define ROBOT_VFH_H
+
+#include "robot_scan.h"
+
+// 向量场直方图(VFH)参数
+#define VFH_BLOCKED_DISTANCE    (40.0f)     // 分区距离小于该值视为有障碍(cm)
+#define VFH_CLEAR_DISTANCE      (50.0f)     // 有障碍的分区距离大于该值才重新视为可通行(cm)
+#define VFH_MIN_SECTOR          (30)        // 车身通过所需的最小可通行扇区宽度(度)
+#define VFH_MAP_MAX_AGE         (1500)      // 只采用该时间内测得的分区数据(ms)
+#define VFH_STEER_FULL          (90)        // 转向角达到该值时内侧轮停转(度)
+#define VFH_STEER_STRAIGHT      (10)        // 转向角小于该值时视为直行(度)
+
+// 规划结果
+typedef struct {
+    int steer;          // 目标方向(度)，正值向左
+    int width;          // 所选可通行扇区宽度(度)
+    int left_duty;      // 左轮占空比
+    int right_duty;     // 右轮占空比
+} VfhResult;
+
+/**
+ * @brief 清空直方图的滞回状态，进入避障模式或转向后调用
+ */
+void vfh_reset(void);
+
+/**
+ * @brief 根据极坐标扫描图选择行驶方向并计算差速占空比
+ * @param bins 扫描图分区，按角度升序排列
+ * @param count 分区数
+ * @param now 当前时刻(ms)，用于判断分区数据是否过期
+ * @param goal 期望行驶方向(度)
+ * @param base_duty 直行时的前进占空比
+ * @param result 输出规划结果
+ * @return 0-找到可通行扇区，-1-没有足够宽的可通行扇区
+ * @note 计算量与分区数成正比，每个tick耗时有上限
+ */
+int vfh_plan(const ScanBin *bins, unsigned int count, unsigned int now,
+             int goal, unsigned short base_duty, VfhResult *result);
+
+#endif // ROBOT_VFH_H
@@ -0,0 +1,105 @@
+/*
+ * OLED保留模式控件模块
+ * 功能：状态界面由标签、数值、进度条和图标控件组成，每个控件有固定的包围盒并绑定一个数据源；
+ *       每次更新只读一遍数据源，值没有变化的控件不再绘制，画面静止时一帧几乎不花时间；
+ *       重绘的控件先清除包围盒再画，与它重叠的上层控件随后一起重画
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "robot_widget.h"
+
+// 包围盒是否相交
+static int widget_overlap(const Widget *a, const Widget *b)
+{
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+// 在包围盒内画一行文字，只画完整放得下的字符
+static void widget_text(const Widget *widget, const char *text)
+{
+    unsigned int width = widget->font->FontWidth;
+    unsigned int len = strlen(text);
+    unsigned int x = widget->x;
+
+    if (len > widget->w / width) {
+        len = widget->w / width;
+    }
+    if (widget->align == WIDGET_ALIGN_CENTER) {
+        x += (widget->w - len * width) / 2;
+    }
+    ssd1306_SetCursor(x, widget->y);
+    for (unsigned int i = 0; i < len; i++) {
+        ssd1306_DrawChar(text[i], *widget->font, White);
+    }
+}
+
+static void widget_draw(const Widget *widget, int value)
+{
+    char text[WIDGET_TEXT_MAX];
+    unsigned int fill;
+
+    ssd1306_FillRect(widget->x, widget->y, widget->x + widget->w - 1, widget->y + widget->h - 1, Black);
+    switch (widget->type) {
+        case WIDGET_LABEL:
+            if (value >= 0 && value < widget->limit) {
+                widget_text(widget, widget->texts[value]);
+            }
+            break;
+        case WIDGET_VALUE:
+            snprintf(text, sizeof(text), widget->format, value);
+            widget_text(widget, text);
+            break;
+        case WIDGET_BAR:
+            if (value <= 0 || widget->limit <= 0) {
+                break;
+            }
+            fill = (value >= widget->limit) ? widget->w : (unsigned int)value * widget->w / widget->limit;
+            if (fill > 0) {
+                ssd1306_FillRect(widget->x, widget->y, widget->x + fill - 1, widget->y + widget->h - 1, White);
+            }
+            break;
+        case WIDGET_ICON:
+            widget->draw(widget, value);
+            break;
+        default:
+            break;
+    }
+}
+
+void widget_invalidate(Widget *widgets, int count)
+{
+    for (int i = 0; i < count; i++) {
+        widgets[i].valid = 0;
+    }
+}
+
+int widget_update(Widget *widgets, int count)
+{
+    unsigned int redrawn = 0;      // 本次重绘过的控件，按位
+    int drawn = 0;
+
+    if (count > WIDGET_MAX_COUNT) {
+        count = WIDGET_MAX_COUNT;
+    }
+    for (int i = 0; i < count; i++) {
+        Widget *widget = &widgets[i];
+        int value = widget->source();
+        int redraw = !widget->valid || value != widget->value;
+
+        // 下层控件重绘时清除了包围盒，压在上面的部分要补画
+        for (int j = 0; j < i && !redraw; j++) {
+            redraw = ((redrawn >> j) & 1) && widget_overlap(&widgets[j], widget);
+        }
+        if (!redraw) {
+            continue;
+        }
+        widget_draw(widget, value);
+        widget->value = value;
+        widget->valid = 1;
+        redrawn |= 1u << i;
+        drawn++;
+    }
+    return drawn;
+}
@@ -0,0 +1,59 @@
+#ifndef ROBOT_WIDGET_H
+#define ROBOT_WIDGET_H
+
+#include "ssd1306.h"
+
+// 控件参数
+#define WIDGET_MAX_COUNT        (32)        // 一次widget_update()处理的控件数上限，按位记录本次重绘的控件
+#define WIDGET_TEXT_MAX         (24)        // VALUE控件格式化后的最大长度(含结尾0)
+
+// 控件类型
+typedef enum {
+    WIDGET_LABEL = 0,       // 按数据源的值从文本表中取一条显示，超出表范围时留空
+    WIDGET_VALUE,           // 按格式串显示数据源的值
+    WIDGET_BAR,             // 按数据源的值占满格值的比例从左向右填充
+    WIDGET_ICON             // 由绘制函数按数据源的值画图标
+} WidgetType;
+
+// 文字对齐方式，只对LABEL和VALUE有意义
+typedef enum {
+    WIDGET_ALIGN_LEFT = 0,
+    WIDGET_ALIGN_CENTER
+} WidgetAlign;
+
+typedef struct Widget Widget;
+
+// 控件描述，前几项注册后不再修改，最后两项由widget_update()维护
+// 包围盒是控件独占的区域，重绘时先清成黑色；表中靠后的控件画在上层
+struct Widget {
+    unsigned char type;         // WidgetType
+    unsigned char align;        // WidgetAlign
+    unsigned char x, y;         // 包围盒左上角
+    unsigned char w, h;         // 包围盒宽高
+    int (*source)(void);        // 绑定的数据源，每次更新调用一次
+    FontDef *font;              // LABEL/VALUE的字体
+    const char *const *texts;   // LABEL的文本表，按值索引
+    const char *format;         // VALUE的格式串，参数为int
+    int limit;                  // LABEL: 文本表条数；BAR: 满格对应的值
+    void (*draw)(const Widget *widget, int value);  // ICON的绘制函数，在包围盒内作画
+    int value;                  // 上次绘制时数据源的值
+    int valid;                  // 0-还没画过或已失效，下次更新必定重绘
+};
+
+/**
+ * @brief 使控件全部失效，整屏重画背景后调用，下次widget_update()重绘所有控件
+ * @param widgets 控件表
+ * @param count 控件数
+ */
+void widget_invalidate(Widget *widgets, int count);
+
+/**
+ * @brief 读取各控件的数据源，只重绘值变化或已失效的控件，以及被它们清除过区域的上层控件
+ * @note 只写显存，由调用者决定是否ssd1306_Present()；驱动只把内容真正变化的字节记为脏
+ * @param widgets 控件表
+ * @param count 控件数，不超过WIDGET_MAX_COUNT
+ * @return 本次重绘的控件数，0表示画面不变
+ */
+int widget_update(Widget *widgets, int count);
+
+#endif // ROBOT_WIDGET_H
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""
+Convert the row-major fonts in ssd1306_fonts.c to page strips.
+
+Every glyph becomes ceil(height / 8) bytes per column, columns left to
+right, the top page first, bit 0 the top row of the page. That is the
+layout of the SSD1306 GDDRAM, so ssd1306_DrawChar() can copy a glyph
+into the screenbuffer a byte at a time.
+
+Usage: python3 gen_font_strips.py [ssd1306_fonts.c] [ssd1306_font_strips.c]
+Run it again after editing ssd1306_fonts.c and commit both files.
+"""
+
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+ARRAY_RE = re.compile(r'static const uint16_t (\w+) \[\] = \{(.*?)\};', re.S)
+FONTDEF_RE = re.compile(r'FontDef (Font_(\w+)) = \{(\d+),\s*(\d+),\s*(\w+)')
+FIRST_CHAR = 32
+
+
+def parse_rows(body):
+    """All glyph rows of a font, comments dropped."""
+    rows = []
+    for line in body.splitlines():
+        values = line.split('//')[0]
+        rows.extend(int(v, 16) for v in re.findall(r'0x[0-9a-fA-F]+', values))
+    return rows
+
+
+def to_strips(rows, width, height):
+    """Glyph rows (bit 15 = left column) to column-major page strips."""
+    pages = (height + 7) // 8
+    strips = []
+    for x in range(width):
+        for page in range(pages):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and rows[y] & (0x8000 >> x):
+                    byte |= 1 << bit
+            strips.append(byte)
+    return strips
+
+
+def generate(source):
+    arrays = {name: parse_rows(body) for name, body in ARRAY_RE.findall(source)}
+    out = [
+        '/* Generated by gen_font_strips.py from ssd1306_fonts.c, do not edit. */',
+        '',
+        '/*',
+        ' * Glyphs as column-major page strips: ceil(height / 8) bytes per column,',
+        ' * top page first, bit 0 is the top row of the page (SSD1306 GDDRAM layout).',
+        ' */',
+        '',
+        '#include "ssd1306_fonts.h"',
+    ]
+    for _, size, width, height, array in FONTDEF_RE.findall(source):
+        width = int(width)
+        height = int(height)
+        glyphs = arrays[array]
+        count = len(glyphs) // height
+        out.append('')
+        out.append('#ifdef SSD1306_INCLUDE_FONT_%s' % size)
+        out.append('const uint8_t %sStrips[] = {' % array)
+        for i in range(count):
+            strips = to_strips(glyphs[i * height:(i + 1) * height], width, height)
+            text = ', '.join('0x%02X' % b for b in strips)
+            out.append("%s,  // '%s'" % (text, chr(FIRST_CHAR + i)))
+        out.append('};')
+        out.append('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    src = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, 'ssd1306_fonts.c')
+    dst = sys.argv[2] if len(sys.argv) > 2 else os.path.join(HERE, 'ssd1306_font_strips.c')
+    with open(src) as f:
+        text = generate(f.read())
+    with open(dst, 'w') as f:
+        f.write(text)
+
+
+if __name__ == '__main__':
+    main()
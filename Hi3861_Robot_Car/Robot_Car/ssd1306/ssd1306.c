@@ -17,6 +17,13 @@
 #define SSD1306_CTRL_DATA 0x40
 #define SSD1306_MASK_CONT (0x1<<7)
 
+// Bytes an update window costs besides its pixel data:
+// I2C address, 6 addressing commands with their control bytes, data control byte
+#define SSD1306_WINDOW_OVERHEAD 14
+
+// Longest command sequence sent in one transaction
+#define SSD1306_CMD_BATCH_MAX 32
+
 typedef struct {
     /** Pointer to the buffer storing data to send */
     unsigned char *sendBuf;
@@ -74,26 +81,38 @@ static uint32_t ssd1306_SendData(uint8_t* data, size_t size)
     return IOT_SUCCESS;
 }
 
-static uint32_t ssd1306_WiteByte(uint8_t regAddr, uint8_t byte)
-{
-    uint8_t buffer[] = {regAddr, byte};
-    return ssd1306_SendData(buffer, sizeof(buffer));
+// Send a sequence of commands in one I2C transaction: a single control byte
+// without the continuation flag marks every following byte as a command
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+    uint8_t data[SSD1306_CMD_BATCH_MAX + 1];
+
+    while (count > 0) {
+        size_t n = (count > SSD1306_CMD_BATCH_MAX) ? SSD1306_CMD_BATCH_MAX : count;
+        data[0] = SSD1306_CTRL_CMD;
+        memcpy(&data[1], cmds, n);
+        ssd1306_SendData(data, n + 1);
+        cmds += n;
+        count -= n;
+    }
 }
 
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
-    ssd1306_WiteByte(SSD1306_CTRL_CMD, byte);
+    ssd1306_WriteCommands(&byte, 1);
 }
 
-// Send data
+// Send data, one transaction per SSD1306_WIDTH bytes
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
-    uint8_t data[SSD1306_WIDTH * 2] = {0};
-    for (size_t i = 0; i < buff_size; i++) {
-        data[i*2] = SSD1306_CTRL_DATA | SSD1306_MASK_CONT;
-        data[i*2+1] = buffer[i];
+    uint8_t data[SSD1306_WIDTH + 1];
+
+    while (buff_size > 0) {
+        size_t n = (buff_size > SSD1306_WIDTH) ? SSD1306_WIDTH : buff_size;
+        data[0] = SSD1306_CTRL_DATA;
+        memcpy(&data[1], buffer, n);
+        ssd1306_SendData(data, n + 1);
+        buffer += n;
+        buff_size -= n;
     }
-    data[(buff_size - 1) * 2] = SSD1306_CTRL_DATA;
-    ssd1306_SendData(data, sizeof(data));
 }
 
 #elif defined(SSD1306_USE_SPI)
@@ -117,6 +136,14 @@ void ssd1306_WriteCommand(uint8_t byte) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
 }
 
+// Send a sequence of commands
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count) {
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
+    HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_RESET); // command
+    HAL_SPI_Transmit(&SSD1306_SPI_PORT, (uint8_t *) cmds, count, HAL_MAX_DELAY);
+    HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
+}
+
 // Send data
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
@@ -130,17 +157,109 @@ void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
 #endif
 
 
-// Screenbuffer
+// Screenbuffer, the back buffer all drawing goes to
 static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
 
+// Front buffer, the last frame handed over by ssd1306_Present()
+static uint8_t SSD1306_Front[SSD1306_BUFFER_SIZE];
+
+// Copy of what the panel RAM shows once the running flush completes,
+// only the flush path touches it
+static uint8_t SSD1306_Panel[SSD1306_BUFFER_SIZE];
+static uint8_t SSD1306_PanelValid;
+
+// Dirty column window of every page, a page is clean when min > max.
+// Back: columns changed by drawing since the last present; span fills mark
+// the whole span without comparing.
+// Front: columns presented but not flushed yet; the flush trims them
+// against SSD1306_Panel, so clearing and redrawing the same content after
+// ssd1306_Fill() costs no I2C traffic.
+static uint8_t SSD1306_DirtyMin[SSD1306_PAGES];
+static uint8_t SSD1306_DirtyMax[SSD1306_PAGES];
+static uint8_t SSD1306_FrontMin[SSD1306_PAGES];
+static uint8_t SSD1306_FrontMax[SSD1306_PAGES];
+
+// Frame handover between ssd1306_Present() and the flush
+static osMutexId_t SSD1306_FrameMutex;      // guards the front buffer, its windows and the pending flag
+static osMutexId_t SSD1306_BusMutex;        // one flush at a time
+static osEventFlagsId_t SSD1306_FlushEvent;
+static uint8_t SSD1306_FramePending;        // a presented frame waits for the flush
+static uint32_t SSD1306_PresentCycles;      // system timer count when it was presented
+
+#define SSD1306_FLUSH_EVENT 0x1
+
+// Update statistics
+static SSD1306_Stats_t SSD1306_Stats;
+
 // Screen object
 static SSD1306_t SSD1306;
 
+static void ssd1306_MarkDirty(uint8_t *min, uint8_t *max, uint32_t page, uint8_t x1, uint8_t x2) {
+    if (x1 < min[page]) {
+        min[page] = x1;
+    }
+    if (x2 > max[page]) {
+        max[page] = x2;
+    }
+}
+
+static void ssd1306_CleanPage(uint8_t *min, uint8_t *max, uint32_t page) {
+    min[page] = 0xFF;
+    max[page] = 0;
+}
+
+// Write one buffer byte, marking its page dirty only if the value changes
+static void ssd1306_SetByte(uint32_t index, uint8_t value) {
+    if (SSD1306_Buffer[index] != value) {
+        uint8_t x = index % SSD1306_WIDTH;
+        SSD1306_Buffer[index] = value;
+        ssd1306_MarkDirty(SSD1306_DirtyMin, SSD1306_DirtyMax, index / SSD1306_WIDTH, x, x);
+    }
+}
+
+// Shrink the front window of a page to the columns that differ from the panel
+static void ssd1306_TrimPage(uint32_t page) {
+    const uint8_t *front = &SSD1306_Front[page * SSD1306_WIDTH];
+    const uint8_t *panel = &SSD1306_Panel[page * SSD1306_WIDTH];
+    int32_t min = SSD1306_FrontMin[page];
+    int32_t max = SSD1306_FrontMax[page];
+
+    while (min <= max && front[min] == panel[min]) {
+        min++;
+    }
+    while (max >= min && front[max] == panel[max]) {
+        max--;
+    }
+    if (min > max) {
+        ssd1306_CleanPage(SSD1306_FrontMin, SSD1306_FrontMax, page);
+    } else {
+        SSD1306_FrontMin[page] = min;
+        SSD1306_FrontMax[page] = max;
+    }
+}
+
+static uint32_t ssd1306_CyclesToUs(uint32_t cycles) {
+    return (uint32_t)((uint64_t)cycles * 1000000 / osKernelGetSysTimerFreq());
+}
+
+// Mark the whole screen dirty, the next flush sends the full frame
+void ssd1306_InvalidateScreen(void) {
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++) {
+        SSD1306_DirtyMin[page] = 0;
+        SSD1306_DirtyMax[page] = SSD1306_WIDTH - 1;
+    }
+    osMutexAcquire(SSD1306_FrameMutex, osWaitForever);
+    SSD1306_PanelValid = 0;
+    osMutexRelease(SSD1306_FrameMutex);
+}
+
 /* Fills the Screenbuffer with values from a given buffer of a fixed length */
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     SSD1306_Error_t ret = SSD1306_ERR;
     if (len <= SSD1306_BUFFER_SIZE) {
-        memcpy(SSD1306_Buffer,buf,len);
+        for (uint32_t i = 0; i < len; i++) {
+            ssd1306_SetByte(i, buf[i]);
+        }
         ret = SSD1306_OK;
     }
     return ret;
@@ -148,97 +267,109 @@ SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
 
 // Initialize the oled screen
 void ssd1306_Init(void) {
+    if (SSD1306_FrameMutex == NULL) {
+        SSD1306_FrameMutex = osMutexNew(NULL);
+        SSD1306_BusMutex = osMutexNew(NULL);
+        SSD1306_FlushEvent = osEventFlagsNew(NULL);
+    }
+
     // Reset OLED
     ssd1306_Reset();
 
     // Wait for the screen to boot
     HAL_Delay(100);
 
-    // Init OLED
-    ssd1306_SetDisplayOn(0); //display off
+    // Init OLED, the whole sequence goes out in one transaction
+    static const uint8_t init[] = {
+        0xAE, //display off
 
-    ssd1306_WriteCommand(0x20); //Set Memory Addressing Mode
-    ssd1306_WriteCommand(0x00); // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
-                                // 10b,Page Addressing Mode (RESET); 11b,Invalid
+        0x20, //Set Memory Addressing Mode
+        0x00, // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
+              // 10b,Page Addressing Mode (RESET); 11b,Invalid
 
-    ssd1306_WriteCommand(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
+        0xB0, //Set Page Start Address for Page Addressing Mode,0-7
 
 #ifdef SSD1306_MIRROR_VERT
-    ssd1306_WriteCommand(0xC0); // Mirror vertically
+        0xC0, // Mirror vertically
 #else
-    ssd1306_WriteCommand(0xC8); //Set COM Output Scan Direction
+        0xC8, //Set COM Output Scan Direction
 #endif
 
-    ssd1306_WriteCommand(0x00); //---set low column address
-    ssd1306_WriteCommand(0x10); //---set high column address
+        0x00, //---set low column address
+        0x10, //---set high column address
 
-    ssd1306_WriteCommand(0x40); //--set start line address - CHECK
+        0x40, //--set start line address - CHECK
 
-    ssd1306_SetContrast(0xFF);
+        0x81, //--set contrast control register
+        0xFF,
 
 #ifdef SSD1306_MIRROR_HORIZ
-    ssd1306_WriteCommand(0xA0); // Mirror horizontally
+        0xA0, // Mirror horizontally
 #else
-    ssd1306_WriteCommand(0xA1); //--set segment re-map 0 to 127 - CHECK
+        0xA1, //--set segment re-map 0 to 127 - CHECK
 #endif
 
 #ifdef SSD1306_INVERSE_COLOR
-    ssd1306_WriteCommand(0xA7); //--set inverse color
+        0xA7, //--set inverse color
 #else
-    ssd1306_WriteCommand(0xA6); //--set normal color
+        0xA6, //--set normal color
 #endif
 
 // Set multiplex ratio.
 #if (SSD1306_HEIGHT == 128)
-    // Found in the Luma Python lib for SH1106.
-    ssd1306_WriteCommand(0xFF);
+        // Found in the Luma Python lib for SH1106.
+        0xFF,
 #else
-    ssd1306_WriteCommand(0xA8); //--set multiplex ratio(1 to 64) - CHECK
+        0xA8, //--set multiplex ratio(1 to 64) - CHECK
 #endif
 
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x1F); //
+        0x1F, //
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x3F); //
+        0x3F, //
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x3F); // Seems to work for 128px high displays too.
+        0x3F, // Seems to work for 128px high displays too.
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
 
-    ssd1306_WriteCommand(0xA4); //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+        0xA4, //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
 
-    ssd1306_WriteCommand(0xD3); //-set display offset - CHECK
-    ssd1306_WriteCommand(0x00); //-not offset
+        0xD3, //-set display offset - CHECK
+        0x00, //-not offset
 
-    ssd1306_WriteCommand(0xD5); //--set display clock divide ratio/oscillator frequency
-    ssd1306_WriteCommand(0xF0); //--set divide ratio
+        0xD5, //--set display clock divide ratio/oscillator frequency
+        0xF0, //--set divide ratio
 
-    ssd1306_WriteCommand(0xD9); //--set pre-charge period
-    ssd1306_WriteCommand(0x11); // 0x22 by default
+        0xD9, //--set pre-charge period
+        0x11, // 0x22 by default
 
-    ssd1306_WriteCommand(0xDA); //--set com pins hardware configuration - CHECK
+        0xDA, //--set com pins hardware configuration - CHECK
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x02);
+        0x02,
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x12);
+        0x12,
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x12);
+        0x12,
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
 
-    ssd1306_WriteCommand(0xDB); //--set vcomh
-    ssd1306_WriteCommand(0x30); //0x20,0.77xVcc, 0x30,0.83xVcc
+        0xDB, //--set vcomh
+        0x30, //0x20,0.77xVcc, 0x30,0.83xVcc
 
-    ssd1306_WriteCommand(0x8D); //--set DC-DC enable
-    ssd1306_WriteCommand(0x14); //
-    ssd1306_SetDisplayOn(1); //--turn on SSD1306 panel
+        0x8D, //--set DC-DC enable
+        0x14, //
+        0xAF, //--turn on SSD1306 panel
+    };
+    ssd1306_WriteCommands(init, sizeof(init));
+    SSD1306.DisplayOn = 1;
 
     // Clear screen
     ssd1306_Fill(Black);
 
-    // Flush buffer to screen
+    // Flush buffer to screen, the panel RAM is random after power up
+    ssd1306_InvalidateScreen();
     ssd1306_UpdateScreen();
 
     // Set default values for screen object
@@ -251,32 +382,24 @@ void ssd1306_Init(void) {
 // Fill the whole screen with the given color
 void ssd1306_Fill(SSD1306_COLOR color) {
     /* Set memory */
-    uint32_t i;
-
-    for(i = 0; i < sizeof(SSD1306_Buffer); i++) {
-        SSD1306_Buffer[i] = (color == Black) ? 0x00 : 0xFF;
+    memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++) {
+        ssd1306_MarkDirty(SSD1306_DirtyMin, SSD1306_DirtyMax, page, 0, SSD1306_WIDTH - 1);
     }
 }
 
-// Write the screenbuffer with changed to the screen
-void ssd1306_UpdateScreen(void) {
-    // Write data to each page of RAM. Number of pages
-    // depends on the screen height:
-    //
-    //  * 32px   ==  4 pages
-    //  * 64px   ==  8 pages
-    //  * 128px  ==  16 pages
-
+// Send the columns x1..x2 of pages p1..p2 of the panel copy in one I2C transaction
+static uint32_t ssd1306_SendWindow(uint8_t x1, uint8_t x2, uint8_t p1, uint8_t p2) {
+    static uint8_t data[SSD1306_WINDOW_OVERHEAD + SSD1306_BUFFER_SIZE];
     uint8_t cmd[] = {
         0X21,   // 设置列起始和结束地址
-        0X00,   // 列起始地址 0
-        0X7F,   // 列终止地址 127
+        x1,     // 列起始地址
+        x2,     // 列终止地址
         0X22,   // 设置页起始和结束地址
-        0X00,   // 页起始地址 0
-        0X07,   // 页终止地址 7
+        p1,     // 页起始地址
+        p2,     // 页终止地址
     };
     uint32_t count = 0;
-    uint8_t data[sizeof(cmd)*2 + SSD1306_BUFFER_SIZE + 1] = {};
 
     // copy cmd
     for (uint32_t i = 0; i < sizeof(cmd)/sizeof(cmd[0]); i++) {
@@ -284,16 +407,187 @@ void ssd1306_UpdateScreen(void) {
         data[count++] = cmd[i];
     }
 
-    // copy frame data
+    // copy frame data, horizontal addressing wraps to the next page after x2
     data[count++] = SSD1306_CTRL_DATA;
-    memcpy(&data[count], SSD1306_Buffer, sizeof(SSD1306_Buffer));
-    count += sizeof(SSD1306_Buffer);
+    for (uint32_t page = p1; page <= p2; page++) {
+        memcpy(&data[count], &SSD1306_Panel[page * SSD1306_WIDTH + x1], x2 - x1 + 1);
+        count += x2 - x1 + 1;
+    }
 
     // send to i2c bus
     uint32_t retval = ssd1306_SendData(data, count);
     if (retval != IOT_SUCCESS) {
         printf("ssd1306_UpdateScreen send frame data filed: %d!\r\n", retval);
     }
+    SSD1306_Stats.transfers++;
+    return count;
+}
+
+typedef struct {
+    uint8_t x1;
+    uint8_t x2;
+    uint8_t p1;
+    uint8_t p2;
+} SSD1306_Window_t;
+
+// Turn the front windows into I2C windows and copy their bytes to the panel copy.
+// Adjacent dirty pages are merged into one window while resending their clean
+// columns is cheaper than another addressing header.
+static uint32_t ssd1306_TakeWindows(SSD1306_Window_t *windows) {
+    uint32_t n = 0;
+    uint32_t page = 0;
+
+    if (SSD1306_PanelValid) {
+        for (page = 0; page < SSD1306_PAGES; page++) {
+            if (SSD1306_FrontMin[page] <= SSD1306_FrontMax[page]) {
+                ssd1306_TrimPage(page);
+            }
+        }
+        page = 0;
+    }
+
+    while (page < SSD1306_PAGES) {
+        if (SSD1306_FrontMin[page] > SSD1306_FrontMax[page]) {
+            page++;
+            continue;
+        }
+
+        uint8_t x1 = SSD1306_FrontMin[page];
+        uint8_t x2 = SSD1306_FrontMax[page];
+        uint32_t last = page;
+        uint32_t cost = SSD1306_WINDOW_OVERHEAD + (x2 - x1 + 1);
+        while (last + 1 < SSD1306_PAGES && SSD1306_FrontMin[last + 1] <= SSD1306_FrontMax[last + 1]) {
+            uint8_t min = SSD1306_FrontMin[last + 1];
+            uint8_t max = SSD1306_FrontMax[last + 1];
+            uint8_t nx1 = (min < x1) ? min : x1;
+            uint8_t nx2 = (max > x2) ? max : x2;
+            uint32_t merged = SSD1306_WINDOW_OVERHEAD + (last + 2 - page) * (nx2 - nx1 + 1);
+            if (merged > cost + SSD1306_WINDOW_OVERHEAD + (max - min + 1)) {
+                break;
+            }
+            x1 = nx1;
+            x2 = nx2;
+            cost = merged;
+            last++;
+        }
+
+        windows[n].x1 = x1;
+        windows[n].x2 = x2;
+        windows[n].p1 = page;
+        windows[n].p2 = last;
+        n++;
+        for (; page <= last; page++) {
+            uint32_t offset = page * SSD1306_WIDTH + x1;
+            memcpy(&SSD1306_Panel[offset], &SSD1306_Front[offset], x2 - x1 + 1);
+            ssd1306_CleanPage(SSD1306_FrontMin, SSD1306_FrontMax, page);
+        }
+    }
+    SSD1306_PanelValid = 1;
+    return n;
+}
+
+// Send the last presented frame, only the part that differs from the panel.
+// The frame lock is held just long enough to copy the windows out, drawing
+// and presenting go on while the I2C transfer runs.
+static void ssd1306_Flush(void) {
+    SSD1306_Window_t windows[SSD1306_PAGES];
+    uint32_t n;
+    uint32_t presented;
+    uint32_t bytes = 0;
+
+    osMutexAcquire(SSD1306_BusMutex, osWaitForever);
+    osMutexAcquire(SSD1306_FrameMutex, osWaitForever);
+    if (!SSD1306_FramePending) {
+        osMutexRelease(SSD1306_FrameMutex);
+        osMutexRelease(SSD1306_BusMutex);
+        return;
+    }
+    n = ssd1306_TakeWindows(windows);
+    presented = SSD1306_PresentCycles;
+    SSD1306_FramePending = 0;
+    osMutexRelease(SSD1306_FrameMutex);
+
+    uint32_t begin = osKernelGetSysTimerCount();
+    for (uint32_t i = 0; i < n; i++) {
+        bytes += ssd1306_SendWindow(windows[i].x1, windows[i].x2, windows[i].p1, windows[i].p2);
+    }
+    uint32_t end = osKernelGetSysTimerCount();
+
+    uint32_t us = ssd1306_CyclesToUs(end - begin);
+    uint32_t frameUs = ssd1306_CyclesToUs(end - presented);
+    SSD1306_Stats.updates++;
+    SSD1306_Stats.lastBytes = bytes;
+    SSD1306_Stats.totalBytes += bytes;
+    SSD1306_Stats.totalUs += us;
+    SSD1306_Stats.lastUs = us;
+    if (us > SSD1306_Stats.maxUs) {
+        SSD1306_Stats.maxUs = us;
+    }
+    SSD1306_Stats.lastFrameUs = frameUs;
+    if (frameUs > SSD1306_Stats.maxFrameUs) {
+        SSD1306_Stats.maxFrameUs = frameUs;
+    }
+    osMutexRelease(SSD1306_BusMutex);
+}
+
+// Hand the back buffer over to the flush, drawing can continue right away
+void ssd1306_Present(void) {
+    osMutexAcquire(SSD1306_FrameMutex, osWaitForever);
+    if (SSD1306_FramePending) {
+        // The previous frame was never sent, it is replaced by this one
+        SSD1306_Stats.dropped++;
+    }
+    for (uint32_t page = 0; page < SSD1306_PAGES; page++) {
+        uint8_t x1 = SSD1306_DirtyMin[page];
+        uint8_t x2 = SSD1306_DirtyMax[page];
+        if (x1 > x2) {
+            continue;
+        }
+        uint32_t offset = page * SSD1306_WIDTH + x1;
+        memcpy(&SSD1306_Front[offset], &SSD1306_Buffer[offset], x2 - x1 + 1);
+        ssd1306_MarkDirty(SSD1306_FrontMin, SSD1306_FrontMax, page, x1, x2);
+        ssd1306_CleanPage(SSD1306_DirtyMin, SSD1306_DirtyMax, page);
+    }
+    SSD1306_FramePending = 1;
+    SSD1306_PresentCycles = osKernelGetSysTimerCount();
+    SSD1306_Stats.presented++;
+    osMutexRelease(SSD1306_FrameMutex);
+    osEventFlagsSet(SSD1306_FlushEvent, SSD1306_FLUSH_EVENT);
+}
+
+// Present the screenbuffer and send it before returning
+void ssd1306_UpdateScreen(void) {
+    ssd1306_Present();
+    ssd1306_Flush();
+}
+
+static void ssd1306_FlushTask(void *arg) {
+    (void)arg;
+
+    while (1) {
+        osEventFlagsWait(SSD1306_FlushEvent, SSD1306_FLUSH_EVENT, osFlagsWaitAny, osWaitForever);
+        ssd1306_Flush();
+    }
+}
+
+void ssd1306_StartFlushTask(void) {
+    osThreadAttr_t attr;
+
+    attr.name = "Ssd1306FlushTask";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = SSD1306_FLUSH_STACK_SIZE;
+    attr.priority = SSD1306_FLUSH_PRIORITY;
+
+    if (osThreadNew(ssd1306_FlushTask, NULL, &attr) == NULL) {
+        printf("Failed to create Ssd1306FlushTask!\r\n");
+    }
+}
+
+void ssd1306_GetStats(SSD1306_Stats_t *stats) {
+    *stats = SSD1306_Stats;
 }
 
 //    Draw one pixel in the screenbuffer
@@ -312,10 +606,11 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
     }
 
     // Draw in the right color
+    uint32_t index = x + (y / 8) * SSD1306_WIDTH;
     if(color == White) {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] |= 1 << (y % 8);
+        ssd1306_SetByte(index, SSD1306_Buffer[index] | (1 << (y % 8)));
     } else {
-        SSD1306_Buffer[x + (y / 8) * SSD1306_WIDTH] &= ~(1 << (y % 8));
+        ssd1306_SetByte(index, SSD1306_Buffer[index] & ~(1 << (y % 8)));
     }
 }
 
@@ -324,7 +619,8 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
 // Font     => Font waarmee we gaan schrijven
 // color    => Black or White
 char ssd1306_DrawChar(char ch, FontDef Font, SSD1306_COLOR color) {
-    uint32_t i, b, j;
+    uint32_t i, j, pages, shift, outPages, index;
+    const uint8_t *strip;
 
     // Check if character is valid
     if (ch < 32 || ch > 126)
@@ -338,15 +634,35 @@ char ssd1306_DrawChar(char ch, FontDef Font, SSD1306_COLOR color) {
         return 0;
     }
 
-    // Use the font to write
-    for(i = 0; i < Font.FontHeight; i++) {
-        b = Font.data[(ch - 32) * Font.FontHeight + i];
-        for(j = 0; j < Font.FontWidth; j++) {
-            if((b << j) & 0x8000)  {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR) color);
-            } else {
-                ssd1306_DrawPixel(SSD1306.CurrentX + j, (SSD1306.CurrentY + i), (SSD1306_COLOR)!color);
+    // Use the font to write: the glyph is stored as page strips, so every
+    // column is a few masked byte writes instead of one DrawPixel per pixel
+    if(SSD1306.Inverted) {
+        color = (SSD1306_COLOR)!color;
+    }
+    pages = (Font.FontHeight + 7) / 8;
+    shift = SSD1306.CurrentY % 8;
+    outPages = (shift + Font.FontHeight + 7) / 8;
+    strip = &Font.strips[(ch - 32) * Font.FontWidth * pages];
+    index = SSD1306.CurrentX + (SSD1306.CurrentY / 8) * SSD1306_WIDTH;
+
+    for(j = 0; j < Font.FontWidth; j++, strip += pages) {
+        uint8_t prevBits = 0;
+        uint8_t prevMask = 0;
+        for(i = 0; i < outPages; i++) {
+            // Rows of the glyph cell in source page i, the last page may be partial
+            uint8_t bits = (i < pages) ? strip[i] : 0;
+            uint8_t mask = 0;
+            if(i < pages) {
+                mask = (Font.FontHeight - i * 8 >= 8) ? 0xFF : (uint8_t)((1 << (Font.FontHeight - i * 8)) - 1);
             }
+            // Shift into the screen page, carrying the bits that spill over from the page above
+            uint8_t outBits = (uint8_t)((bits << shift) | (shift ? (prevBits >> (8 - shift)) : 0));
+            uint8_t outMask = (uint8_t)((mask << shift) | (shift ? (prevMask >> (8 - shift)) : 0));
+            uint8_t value = (color == White) ? outBits : (uint8_t)~outBits;
+            uint32_t at = index + j + i * SSD1306_WIDTH;
+            ssd1306_SetByte(at, (SSD1306_Buffer[at] & ~outMask) | (value & outMask));
+            prevBits = bits;
+            prevMask = mask;
         }
     }
 
@@ -380,8 +696,73 @@ void ssd1306_SetCursor(uint8_t x, uint8_t y) {
     SSD1306.CurrentY = y;
 }
 
-// Draw line by Bresenhem's algorithm
+// Fill rectangle, corners in any order, clipped to the screen.
+// Works a page at a time: rows of the rectangle inside a page form one bit
+// mask, full pages are a memset, the others one masked write per column.
+void ssd1306_FillRect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+    uint8_t tmp;
+
+    if (x1 > x2) {
+        tmp = x1; x1 = x2; x2 = tmp;
+    }
+    if (y1 > y2) {
+        tmp = y1; y1 = y2; y2 = tmp;
+    }
+    if (x1 >= SSD1306_WIDTH || y1 >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (x2 >= SSD1306_WIDTH) {
+        x2 = SSD1306_WIDTH - 1;
+    }
+    if (y2 >= SSD1306_HEIGHT) {
+        y2 = SSD1306_HEIGHT - 1;
+    }
+
+    // Check if pixels should be inverted
+    if (SSD1306.Inverted) {
+        color = (SSD1306_COLOR)!color;
+    }
+    uint8_t value = (color == White) ? 0xFF : 0x00;
+    uint32_t width = x2 - x1 + 1;
+
+    for (uint32_t page = y1 / 8; page <= (uint32_t)y2 / 8; page++) {
+        uint32_t top = (page == y1 / 8) ? y1 % 8 : 0;
+        uint32_t bottom = (page == y2 / 8) ? y2 % 8 : 7;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+        uint8_t *row = &SSD1306_Buffer[page * SSD1306_WIDTH + x1];
+
+        if (mask == 0xFF) {
+            memset(row, value, width);
+        } else {
+            for (uint32_t i = 0; i < width; i++) {
+                row[i] = (row[i] & ~mask) | (value & mask);
+            }
+        }
+        ssd1306_MarkDirty(SSD1306_DirtyMin, SSD1306_DirtyMax, page, x1, x2);
+    }
+}
+
+// Draw horizontal line from x1 to x2
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color) {
+    ssd1306_FillRect(x1, y, x2, y, color);
+}
+
+// Draw vertical line from y1 to y2
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    ssd1306_FillRect(x, y1, x, y2, color);
+}
+
+// Draw line by Bresenhem's algorithm, axis-aligned lines go to the span fills
 void ssd1306_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color) {
+  if(y1 == y2) {
+    ssd1306_DrawHLine(x1, x2, y1, color);
+    return;
+  }
+  if(x1 == x2) {
+    ssd1306_DrawVLine(x1, y1, y2, color);
+    return;
+  }
+
   int32_t deltaX = abs(x2 - x1);
   int32_t deltaY = abs(y2 - y1);
   int32_t signX = ((x1 < x2) ? 1 : -1);
@@ -583,8 +964,8 @@ void ssd1306_DrawRegion(uint8_t x, uint8_t y, uint8_t w, uint8_t h, const uint8_
 
 void ssd1306_SetContrast(const uint8_t value) {
     const uint8_t kSetContrastControlRegister = 0x81;
-    ssd1306_WriteCommand(kSetContrastControlRegister);
-    ssd1306_WriteCommand(value);
+    const uint8_t cmds[] = {kSetContrastControlRegister, value};
+    ssd1306_WriteCommands(cmds, sizeof(cmds));
 }
 
 void ssd1306_SetDisplayOn(const uint8_t on) {
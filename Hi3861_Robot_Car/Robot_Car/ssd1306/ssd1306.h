@@ -104,6 +104,18 @@ extern SPI_HandleTypeDef SSD1306_SPI_PORT;
 #define SSD1306_BUFFER_SIZE   SSD1306_WIDTH * SSD1306_HEIGHT / 8
 #endif
 
+// Flush task, see ssd1306_StartFlushTask()
+#ifndef SSD1306_FLUSH_STACK_SIZE
+#define SSD1306_FLUSH_STACK_SIZE 2048
+#endif
+
+#ifndef SSD1306_FLUSH_PRIORITY
+#define SSD1306_FLUSH_PRIORITY  20
+#endif
+
+// Number of 8-pixel-high pages
+#define SSD1306_PAGES         (SSD1306_HEIGHT / 8)
+
 // Enumeration for screen colors
 typedef enum {
     Black = 0x00, // Black color, no pixel
@@ -128,17 +140,50 @@ typedef struct {
     uint8_t y;
 } SSD1306_VERTEX;
 
+// Screen update statistics, see ssd1306_GetStats()
+typedef struct {
+    uint32_t presented;     // frames handed over by ssd1306_Present()
+    uint32_t dropped;       // presented frames replaced before they were sent
+    uint32_t updates;       // frames sent to the panel
+    uint32_t transfers;     // I2C transactions sent
+    uint32_t lastBytes;     // bytes sent for the last frame, addressing included
+    uint32_t lastUs;        // I2C time of the last frame
+    uint32_t maxUs;         // longest I2C time of a frame
+    uint32_t lastFrameUs;   // last frame, from present until it was on the panel
+    uint32_t maxFrameUs;    // longest present-to-panel time
+    uint32_t totalBytes;    // bytes sent for all frames
+    uint64_t totalUs;       // I2C time of all frames
+} SSD1306_Stats_t;
+
 // Procedure definitions
 void ssd1306_Init(void);
 void ssd1306_Fill(SSD1306_COLOR color);
 void ssd1306_SetCursor(uint8_t x, uint8_t y);
 void ssd1306_UpdateScreen(void);
+void ssd1306_InvalidateScreen(void);
+
+/**
+ * @brief Hands the screenbuffer over to the flush task and returns at once.
+ * @note Drawing may continue right away, it does not change the presented frame.
+ *       A frame presented before the previous one was sent replaces it and is
+ *       counted as dropped.
+ */
+void ssd1306_Present(void);
+/**
+ * @brief Starts the task sending presented frames, call after ssd1306_Init().
+ * @note Without it ssd1306_UpdateScreen() still works synchronously.
+ */
+void ssd1306_StartFlushTask(void);
+void ssd1306_GetStats(SSD1306_Stats_t *stats);
 
 char ssd1306_DrawChar(char ch, FontDef Font, SSD1306_COLOR color);
 char ssd1306_DrawString(char* str, FontDef Font, SSD1306_COLOR color);
 
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 void ssd1306_DrawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_DrawHLine(uint8_t x1, uint8_t x2, uint8_t y, SSD1306_COLOR color);
+void ssd1306_DrawVLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_FillRect(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawPolyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD1306_COLOR color);
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
@@ -173,6 +218,12 @@ uint32_t HAL_GetTick(void); // in ms
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
+/**
+ * @brief Sends a sequence of commands (with their parameters) in one transaction.
+ * @param[in] cmds command bytes.
+ * @param[in] count number of bytes.
+ */
+void ssd1306_WriteCommands(const uint8_t* cmds, size_t count);
 void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
 
@@ -1,40 +1,44 @@
-/**
- * Private configuration file for the SSD1306 library.
- * This example is configured for STM32F0, I2C and including all fonts.
- */
-
-#ifndef __SSD1306_CONF_H__
-#define __SSD1306_CONF_H__
-
-// Choose a microcontroller family
-// #define STM32F0
-//#define STM32F1
-//#define STM32F4
-//#define STM32L0
-//#define STM32L4
-//#define STM32F3
-//#define STM32H7
-//#define STM32F7
-
-// Choose a bus
-#define SSD1306_USE_I2C
-//#define SSD1306_USE_SPI
-
-// I2C Configuration
-// #define SSD1306_I2C_PORT        hi2c1
-#define SSD1306_I2C_ADDR        (0x3C << 1)
-
-// Mirror the screen if needed
-// #define SSD1306_MIRROR_VERT
-// #define SSD1306_MIRROR_HORIZ
-
-// Set inverse color if needed
-// # define SSD1306_INVERSE_COLOR
-
-// Include only needed fonts
-#define SSD1306_INCLUDE_FONT_6x8
-#define SSD1306_INCLUDE_FONT_7x10
-#define SSD1306_INCLUDE_FONT_11x18
-#define SSD1306_INCLUDE_FONT_16x26
-
+/**
+ * Private configuration file for the SSD1306 library.
+ * This example is configured for STM32F0, I2C and including all fonts.
+ */
+
+#ifndef __SSD1306_CONF_H__
+#define __SSD1306_CONF_H__
+
+// Choose a microcontroller family
+// #define STM32F0
+//#define STM32F1
+//#define STM32F4
+//#define STM32L0
+//#define STM32L4
+//#define STM32F3
+//#define STM32H7
+//#define STM32F7
+
+// Choose a bus
+#define SSD1306_USE_I2C
+//#define SSD1306_USE_SPI
+
+// I2C Configuration
+// #define SSD1306_I2C_PORT        hi2c1
+#define SSD1306_I2C_ADDR        (0x3C << 1)
+
+// Flush task, below the robot control tasks (24~26)
+#define SSD1306_FLUSH_STACK_SIZE 2048
+#define SSD1306_FLUSH_PRIORITY  20
+
+// Mirror the screen if needed
+// #define SSD1306_MIRROR_VERT
+// #define SSD1306_MIRROR_HORIZ
+
+// Set inverse color if needed
+// # define SSD1306_INVERSE_COLOR
+
+// Include only needed fonts
+#define SSD1306_INCLUDE_FONT_6x8
+#define SSD1306_INCLUDE_FONT_7x10
+#define SSD1306_INCLUDE_FONT_11x18
+#define SSD1306_INCLUDE_FONT_16x26
+
 #endif /* __SSD1306_CONF_H__ */
\ No newline at end of file
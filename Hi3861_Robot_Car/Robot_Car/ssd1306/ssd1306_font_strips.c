@@ -0,0 +1,408 @@
+/* Generated by gen_font_strips.py from ssd1306_fonts.c, do not edit. */
+
+/*
+ * Glyphs as column-major page strips: ceil(height / 8) bytes per column,
+ * top page first, bit 0 is the top row of the page (SSD1306 GDDRAM layout).
+ */
+
+#include "ssd1306_fonts.h"
+
+#ifdef SSD1306_INCLUDE_FONT_6x8
+const uint8_t Font6x8Strips[] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+0x00, 0x00, 0x5F, 0x00, 0x00, 0x00,  // '!'
+0x00, 0x07, 0x00, 0x07, 0x00, 0x00,  // '"'
+0x14, 0x7F, 0x14, 0x7F, 0x14, 0x00,  // '#'
+0x24, 0x2A, 0x7F, 0x2A, 0x12, 0x00,  // '$'
+0x23, 0x13, 0x08, 0x64, 0x62, 0x00,  // '%'
+0x36, 0x49, 0x56, 0x20, 0x50, 0x00,  // '&'
+0x00, 0x08, 0x07, 0x03, 0x00, 0x00,  // '''
+0x00, 0x1C, 0x22, 0x41, 0x00, 0x00,  // '('
+0x00, 0x41, 0x22, 0x1C, 0x00, 0x00,  // ')'
+0x2A, 0x1C, 0x7F, 0x1C, 0x2A, 0x00,  // '*'
+0x08, 0x08, 0x3E, 0x08, 0x08, 0x00,  // '+'
+0x00, 0x00, 0x70, 0x30, 0x00, 0x00,  // ','
+0x08, 0x08, 0x08, 0x08, 0x08, 0x00,  // '-'
+0x00, 0x00, 0x60, 0x60, 0x00, 0x00,  // '.'
+0x20, 0x10, 0x08, 0x04, 0x02, 0x00,  // '/'
+0x3E, 0x51, 0x49, 0x45, 0x3E, 0x00,  // '0'
+0x00, 0x42, 0x7F, 0x40, 0x00, 0x00,  // '1'
+0x72, 0x49, 0x49, 0x49, 0x46, 0x00,  // '2'
+0x21, 0x41, 0x49, 0x4D, 0x33, 0x00,  // '3'
+0x18, 0x14, 0x12, 0x7F, 0x10, 0x00,  // '4'
+0x27, 0x45, 0x45, 0x45, 0x39, 0x00,  // '5'
+0x3C, 0x4A, 0x49, 0x49, 0x31, 0x00,  // '6'
+0x41, 0x21, 0x11, 0x09, 0x07, 0x00,  // '7'
+0x36, 0x49, 0x49, 0x49, 0x36, 0x00,  // '8'
+0x46, 0x49, 0x49, 0x29, 0x1E, 0x00,  // '9'
+0x00, 0x00, 0x14, 0x00, 0x00, 0x00,  // ':'
+0x00, 0x40, 0x34, 0x00, 0x00, 0x00,  // ';'
+0x00, 0x08, 0x14, 0x22, 0x41, 0x00,  // '<'
+0x14, 0x14, 0x14, 0x14, 0x14, 0x00,  // '='
+0x00, 0x41, 0x22, 0x14, 0x08, 0x00,  // '>'
+0x02, 0x01, 0x59, 0x09, 0x06, 0x00,  // '?'
+0x3E, 0x41, 0x5D, 0x59, 0x4E, 0x00,  // '@'
+0x7C, 0x12, 0x11, 0x12, 0x7C, 0x00,  // 'A'
+0x7F, 0x49, 0x49, 0x49, 0x36, 0x00,  // 'B'
+0x3E, 0x41, 0x41, 0x41, 0x22, 0x00,  // 'C'
+0x7F, 0x41, 0x41, 0x41, 0x3E, 0x00,  // 'D'
+0x7F, 0x49, 0x49, 0x49, 0x41, 0x00,  // 'E'
+0x7F, 0x09, 0x09, 0x09, 0x01, 0x00,  // 'F'
+0x3E, 0x41, 0x41, 0x51, 0x73, 0x00,  // 'G'
+0x7F, 0x08, 0x08, 0x08, 0x7F, 0x00,  // 'H'
+0x00, 0x41, 0x7F, 0x41, 0x00, 0x00,  // 'I'
+0x20, 0x40, 0x41, 0x3F, 0x01, 0x00,  // 'J'
+0x7F, 0x08, 0x14, 0x22, 0x41, 0x00,  // 'K'
+0x7F, 0x40, 0x40, 0x40, 0x40, 0x00,  // 'L'
+0x7F, 0x02, 0x1C, 0x02, 0x7F, 0x00,  // 'M'
+0x7F, 0x04, 0x08, 0x10, 0x7F, 0x00,  // 'N'
+0x3E, 0x41, 0x41, 0x41, 0x3E, 0x00,  // 'O'
+0x7F, 0x09, 0x09, 0x09, 0x06, 0x00,  // 'P'
+0x3E, 0x41, 0x51, 0x21, 0x5E, 0x00,  // 'Q'
+0x7F, 0x09, 0x19, 0x29, 0x46, 0x00,  // 'R'
+0x26, 0x49, 0x49, 0x49, 0x32, 0x00,  // 'S'
+0x03, 0x01, 0x7F, 0x01, 0x03, 0x00,  // 'T'
+0x3F, 0x40, 0x40, 0x40, 0x3F, 0x00,  // 'U'
+0x1F, 0x20, 0x40, 0x20, 0x1F, 0x00,  // 'V'
+0x3F, 0x40, 0x38, 0x40, 0x3F, 0x00,  // 'W'
+0x63, 0x14, 0x08, 0x14, 0x63, 0x00,  // 'X'
+0x03, 0x04, 0x78, 0x04, 0x03, 0x00,  // 'Y'
+0x61, 0x59, 0x49, 0x4D, 0x43, 0x00,  // 'Z'
+0x00, 0x7F, 0x41, 0x41, 0x41, 0x00,  // '['
+0x02, 0x04, 0x08, 0x10, 0x20, 0x00,  // '\'
+0x00, 0x41, 0x41, 0x41, 0x7F, 0x00,  // ']'
+0x04, 0x02, 0x01, 0x02, 0x04, 0x00,  // '^'
+0x40, 0x40, 0x40, 0x40, 0x40, 0x00,  // '_'
+0x00, 0x03, 0x07, 0x08, 0x00, 0x00,  // '`'
+0x20, 0x54, 0x54, 0x78, 0x40, 0x00,  // 'a'
+0x7F, 0x28, 0x44, 0x44, 0x38, 0x00,  // 'b'
+0x38, 0x44, 0x44, 0x44, 0x28, 0x00,  // 'c'
+0x38, 0x44, 0x44, 0x28, 0x7F, 0x00,  // 'd'
+0x38, 0x54, 0x54, 0x54, 0x18, 0x00,  // 'e'
+0x00, 0x08, 0x7E, 0x09, 0x02, 0x00,  // 'f'
+0x18, 0x24, 0x24, 0x1C, 0x78, 0x00,  // 'g'
+0x7F, 0x08, 0x04, 0x04, 0x78, 0x00,  // 'h'
+0x00, 0x44, 0x7D, 0x40, 0x00, 0x00,  // 'i'
+0x20, 0x40, 0x40, 0x3D, 0x00, 0x00,  // 'j'
+0x7F, 0x10, 0x28, 0x44, 0x00, 0x00,  // 'k'
+0x00, 0x41, 0x7F, 0x40, 0x00, 0x00,  // 'l'
+0x7C, 0x04, 0x78, 0x04, 0x78, 0x00,  // 'm'
+0x7C, 0x08, 0x04, 0x04, 0x78, 0x00,  // 'n'
+0x38, 0x44, 0x44, 0x44, 0x38, 0x00,  // 'o'
+0x7C, 0x18, 0x24, 0x24, 0x18, 0x00,  // 'p'
+0x18, 0x24, 0x24, 0x18, 0x7C, 0x00,  // 'q'
+0x7C, 0x08, 0x04, 0x04, 0x08, 0x00,  // 'r'
+0x48, 0x54, 0x54, 0x54, 0x24, 0x00,  // 's'
+0x04, 0x04, 0x3F, 0x44, 0x24, 0x00,  // 't'
+0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00,  // 'u'
+0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00,  // 'v'
+0x3C, 0x40, 0x30, 0x40, 0x3C, 0x00,  // 'w'
+0x44, 0x28, 0x10, 0x28, 0x44, 0x00,  // 'x'
+0x4C, 0x10, 0x10, 0x10, 0x7C, 0x00,  // 'y'
+0x44, 0x64, 0x54, 0x4C, 0x44, 0x00,  // 'z'
+0x00, 0x08, 0x36, 0x41, 0x00, 0x00,  // '{'
+0x00, 0x00, 0x77, 0x00, 0x00, 0x00,  // '|'
+0x00, 0x41, 0x36, 0x08, 0x00, 0x00,  // '}'
+0x02, 0x01, 0x02, 0x04, 0x02, 0x00,  // '~'
+};
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_7x10
+const uint8_t Font7x10Strips[] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xBF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '!'
+0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,  // '"'
+0x00, 0x00, 0xF4, 0x00, 0x2F, 0x00, 0x24, 0x00, 0xF4, 0x00, 0x2F, 0x00, 0x00, 0x00,  // '#'
+0x00, 0x00, 0x66, 0x00, 0x89, 0x00, 0xFF, 0x01, 0x89, 0x00, 0x72, 0x00, 0x00, 0x00,  // '$'
+0x00, 0x00, 0x26, 0x00, 0x19, 0x00, 0x6E, 0x00, 0x94, 0x00, 0x62, 0x00, 0x00, 0x00,  // '%'
+0x00, 0x00, 0x60, 0x00, 0x96, 0x00, 0x99, 0x00, 0x66, 0x00, 0x90, 0x00, 0x00, 0x00,  // '&'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '''
+0x00, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x02, 0x01, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00,  // '('
+0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x02, 0x01, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00,  // ')'
+0x00, 0x00, 0x00, 0x00, 0x0A, 0x00, 0x07, 0x00, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00,  // '*'
+0x00, 0x00, 0x10, 0x00, 0x10, 0x00, 0x7C, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00,  // '+'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ','
+0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,  // '-'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '.'
+0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x3C, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,  // '/'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0x89, 0x00, 0x81, 0x00, 0x7E, 0x00, 0x00, 0x00,  // '0'
+0x00, 0x00, 0x04, 0x00, 0x02, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '1'
+0x00, 0x00, 0x86, 0x00, 0xC1, 0x00, 0xA1, 0x00, 0x91, 0x00, 0x8E, 0x00, 0x00, 0x00,  // '2'
+0x00, 0x00, 0x42, 0x00, 0x81, 0x00, 0x89, 0x00, 0x89, 0x00, 0x76, 0x00, 0x00, 0x00,  // '3'
+0x00, 0x00, 0x30, 0x00, 0x2C, 0x00, 0x22, 0x00, 0xFF, 0x00, 0x20, 0x00, 0x00, 0x00,  // '4'
+0x00, 0x00, 0x4F, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x71, 0x00, 0x00, 0x00,  // '5'
+0x00, 0x00, 0x7E, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x72, 0x00, 0x00, 0x00,  // '6'
+0x00, 0x00, 0x01, 0x00, 0xE1, 0x00, 0x19, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00,  // '7'
+0x00, 0x00, 0x76, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x76, 0x00, 0x00, 0x00,  // '8'
+0x00, 0x00, 0x4E, 0x00, 0x91, 0x00, 0x91, 0x00, 0x91, 0x00, 0x7E, 0x00, 0x00, 0x00,  // '9'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ':'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ';'
+0x00, 0x00, 0x10, 0x00, 0x28, 0x00, 0x28, 0x00, 0x44, 0x00, 0x44, 0x00, 0x00, 0x00,  // '<'
+0x00, 0x00, 0x28, 0x00, 0x28, 0x00, 0x28, 0x00, 0x28, 0x00, 0x28, 0x00, 0x00, 0x00,  // '='
+0x00, 0x00, 0x44, 0x00, 0x44, 0x00, 0x28, 0x00, 0x28, 0x00, 0x10, 0x00, 0x00, 0x00,  // '>'
+0x00, 0x00, 0x02, 0x00, 0x01, 0x00, 0xB1, 0x00, 0x09, 0x00, 0x06, 0x00, 0x00, 0x00,  // '?'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0x99, 0x00, 0x95, 0x00, 0x1E, 0x00, 0x00, 0x00,  // '@'
+0x00, 0x00, 0xE0, 0x00, 0x3E, 0x00, 0x21, 0x00, 0x3E, 0x00, 0xE0, 0x00, 0x00, 0x00,  // 'A'
+0x00, 0x00, 0xFF, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x76, 0x00, 0x00, 0x00,  // 'B'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x42, 0x00, 0x00, 0x00,  // 'C'
+0x00, 0x00, 0xFF, 0x00, 0x81, 0x00, 0x81, 0x00, 0x42, 0x00, 0x3C, 0x00, 0x00, 0x00,  // 'D'
+0x00, 0x00, 0xFF, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x89, 0x00, 0x00, 0x00,  // 'E'
+0x00, 0x00, 0xFF, 0x00, 0x09, 0x00, 0x09, 0x00, 0x09, 0x00, 0x01, 0x00, 0x00, 0x00,  // 'F'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0x91, 0x00, 0x91, 0x00, 0x72, 0x00, 0x00, 0x00,  // 'G'
+0x00, 0x00, 0xFF, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0xFF, 0x00, 0x00, 0x00,  // 'H'
+0x00, 0x00, 0x00, 0x00, 0x81, 0x00, 0xFF, 0x00, 0x81, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'I'
+0x00, 0x00, 0x40, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x7F, 0x00, 0x00, 0x00,  // 'J'
+0x00, 0x00, 0xFF, 0x00, 0x08, 0x00, 0x14, 0x00, 0x62, 0x00, 0x81, 0x00, 0x00, 0x00,  // 'K'
+0x00, 0x00, 0xFF, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x00, 0x00,  // 'L'
+0x00, 0x00, 0xFF, 0x00, 0x06, 0x00, 0x08, 0x00, 0x06, 0x00, 0xFF, 0x00, 0x00, 0x00,  // 'M'
+0x00, 0x00, 0xFF, 0x00, 0x06, 0x00, 0x18, 0x00, 0x60, 0x00, 0xFF, 0x00, 0x00, 0x00,  // 'N'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x7E, 0x00, 0x00, 0x00,  // 'O'
+0x00, 0x00, 0xFF, 0x00, 0x11, 0x00, 0x11, 0x00, 0x11, 0x00, 0x0E, 0x00, 0x00, 0x00,  // 'P'
+0x00, 0x00, 0x7E, 0x00, 0x81, 0x00, 0xC1, 0x00, 0x81, 0x00, 0x7E, 0x01, 0x00, 0x00,  // 'Q'
+0x00, 0x00, 0xFF, 0x00, 0x11, 0x00, 0x11, 0x00, 0x71, 0x00, 0x8E, 0x00, 0x00, 0x00,  // 'R'
+0x00, 0x00, 0x46, 0x00, 0x89, 0x00, 0x89, 0x00, 0x91, 0x00, 0x62, 0x00, 0x00, 0x00,  // 'S'
+0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0xFF, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00,  // 'T'
+0x00, 0x00, 0x7F, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0x7F, 0x00, 0x00, 0x00,  // 'U'
+0x00, 0x00, 0x07, 0x00, 0x38, 0x00, 0xC0, 0x00, 0x38, 0x00, 0x07, 0x00, 0x00, 0x00,  // 'V'
+0x00, 0x00, 0x3F, 0x00, 0xE0, 0x00, 0x1C, 0x00, 0xE0, 0x00, 0x3F, 0x00, 0x00, 0x00,  // 'W'
+0x00, 0x00, 0x81, 0x00, 0x66, 0x00, 0x18, 0x00, 0x66, 0x00, 0x81, 0x00, 0x00, 0x00,  // 'X'
+0x00, 0x00, 0x03, 0x00, 0x0C, 0x00, 0xF0, 0x00, 0x0C, 0x00, 0x03, 0x00, 0x00, 0x00,  // 'Y'
+0x00, 0x00, 0xC1, 0x00, 0xA1, 0x00, 0x99, 0x00, 0x85, 0x00, 0x83, 0x00, 0x00, 0x00,  // 'Z'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x03, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00,  // '['
+0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x3C, 0x00, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00,  // '\'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ']'
+0x00, 0x00, 0x08, 0x00, 0x06, 0x00, 0x01, 0x00, 0x06, 0x00, 0x08, 0x00, 0x00, 0x00,  // '^'
+0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02,  // '_'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '`'
+0x00, 0x00, 0x68, 0x00, 0x94, 0x00, 0x94, 0x00, 0x54, 0x00, 0xF8, 0x00, 0x00, 0x00,  // 'a'
+0x00, 0x00, 0xFF, 0x00, 0x48, 0x00, 0x84, 0x00, 0x84, 0x00, 0x78, 0x00, 0x00, 0x00,  // 'b'
+0x00, 0x00, 0x78, 0x00, 0x84, 0x00, 0x84, 0x00, 0x84, 0x00, 0x48, 0x00, 0x00, 0x00,  // 'c'
+0x00, 0x00, 0x78, 0x00, 0x84, 0x00, 0x84, 0x00, 0x48, 0x00, 0xFF, 0x00, 0x00, 0x00,  // 'd'
+0x00, 0x00, 0x78, 0x00, 0x94, 0x00, 0x94, 0x00, 0x94, 0x00, 0x58, 0x00, 0x00, 0x00,  // 'e'
+0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0xFE, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00,  // 'f'
+0x00, 0x00, 0x78, 0x02, 0x84, 0x02, 0x84, 0x02, 0x48, 0x02, 0xFC, 0x01, 0x00, 0x00,  // 'g'
+0x00, 0x00, 0xFF, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0xF8, 0x00, 0x00, 0x00,  // 'h'
+0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0xFD, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'i'
+0x00, 0x02, 0x04, 0x02, 0x04, 0x02, 0xFD, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'j'
+0x00, 0x00, 0xFF, 0x00, 0x10, 0x00, 0x28, 0x00, 0x44, 0x00, 0x80, 0x00, 0x00, 0x00,  // 'k'
+0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'l'
+0x00, 0x00, 0xFC, 0x00, 0x04, 0x00, 0xFC, 0x00, 0x04, 0x00, 0xF8, 0x00, 0x00, 0x00,  // 'm'
+0x00, 0x00, 0xFC, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0xF8, 0x00, 0x00, 0x00,  // 'n'
+0x00, 0x00, 0x78, 0x00, 0x84, 0x00, 0x84, 0x00, 0x84, 0x00, 0x78, 0x00, 0x00, 0x00,  // 'o'
+0x00, 0x00, 0xFC, 0x03, 0x48, 0x00, 0x84, 0x00, 0x84, 0x00, 0x78, 0x00, 0x00, 0x00,  // 'p'
+0x00, 0x00, 0x78, 0x00, 0x84, 0x00, 0x84, 0x00, 0x48, 0x00, 0xFC, 0x03, 0x00, 0x00,  // 'q'
+0x00, 0x00, 0xFC, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00,  // 'r'
+0x00, 0x00, 0x48, 0x00, 0x94, 0x00, 0x94, 0x00, 0xA4, 0x00, 0x48, 0x00, 0x00, 0x00,  // 's'
+0x00, 0x00, 0x04, 0x00, 0x7F, 0x00, 0x84, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00,  // 't'
+0x00, 0x00, 0x7C, 0x00, 0x80, 0x00, 0x80, 0x00, 0x40, 0x00, 0xFC, 0x00, 0x00, 0x00,  // 'u'
+0x00, 0x00, 0x0C, 0x00, 0x70, 0x00, 0x80, 0x00, 0x70, 0x00, 0x0C, 0x00, 0x00, 0x00,  // 'v'
+0x00, 0x00, 0x3C, 0x00, 0xE0, 0x00, 0x1C, 0x00, 0xE0, 0x00, 0x3C, 0x00, 0x00, 0x00,  // 'w'
+0x00, 0x00, 0x84, 0x00, 0x48, 0x00, 0x30, 0x00, 0x48, 0x00, 0x84, 0x00, 0x00, 0x00,  // 'x'
+0x00, 0x00, 0x0C, 0x02, 0x30, 0x02, 0xC0, 0x01, 0x30, 0x00, 0x0C, 0x00, 0x00, 0x00,  // 'y'
+0x00, 0x00, 0xC4, 0x00, 0xA4, 0x00, 0x94, 0x00, 0x8C, 0x00, 0x84, 0x00, 0x00, 0x00,  // 'z'
+0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0xCF, 0x03, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00,  // '{'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '|'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0xCF, 0x03, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00,  // '}'
+0x00, 0x00, 0x18, 0x00, 0x08, 0x00, 0x08, 0x00, 0x10, 0x00, 0x18, 0x00, 0x00, 0x00,  // '~'
+};
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_11x18
+const uint8_t Font11x18Strips[] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFE, 0x6F, 0x00, 0xFE, 0x6F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '!'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '"'
+0x00, 0x00, 0x00, 0x60, 0x06, 0x00, 0x60, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x06, 0x00, 0x60, 0x06, 0x00, 0x00, 0x00, 0x00,  // '#'
+0x00, 0x00, 0x00, 0x38, 0x1C, 0x00, 0x7C, 0x3C, 0x00, 0xEE, 0x70, 0x00, 0xC6, 0x60, 0x00, 0xFE, 0xFF, 0x01, 0x86, 0x61, 0x00, 0x1C, 0x3F, 0x00, 0x18, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '$'
+0x3C, 0x00, 0x00, 0x7E, 0x18, 0x00, 0x42, 0x0C, 0x00, 0x7E, 0x06, 0x00, 0x3C, 0x03, 0x00, 0x80, 0x3D, 0x00, 0xC0, 0x7E, 0x00, 0x60, 0x42, 0x00, 0x30, 0x7E, 0x00, 0x18, 0x3C, 0x00, 0x00, 0x00, 0x00,  // '%'
+0x00, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x3C, 0x3F, 0x00, 0x7E, 0x61, 0x00, 0xC6, 0x61, 0x00, 0xC6, 0x63, 0x00, 0x7E, 0x36, 0x00, 0x3C, 0x1C, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x00,  // '&'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '''
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x0F, 0x00, 0xF8, 0x7F, 0x00, 0x1C, 0xE0, 0x00, 0x06, 0x80, 0x01, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '('
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x02, 0x06, 0x80, 0x01, 0x1C, 0xE0, 0x00, 0xF8, 0x7F, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ')'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2C, 0x00, 0x00, 0x38, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x38, 0x00, 0x00, 0x2C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '*'
+0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0xF8, 0x1F, 0x00, 0xF8, 0x1F, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00,  // '+'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x02, 0x00, 0xE0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ','
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '-'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '.'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x7F, 0x00, 0xF0, 0x0F, 0x00, 0xFE, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '/'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x0E, 0x70, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x0E, 0x70, 0x00, 0xFC, 0x3F, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '0'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x18, 0x00, 0x00, 0x0C, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '1'
+0x00, 0x00, 0x00, 0x38, 0x70, 0x00, 0x3C, 0x78, 0x00, 0x0E, 0x6C, 0x00, 0x06, 0x66, 0x00, 0x06, 0x63, 0x00, 0x8E, 0x61, 0x00, 0xFC, 0x60, 0x00, 0x78, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '2'
+0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x1C, 0x38, 0x00, 0x06, 0x70, 0x00, 0xC6, 0x60, 0x00, 0xC6, 0x60, 0x00, 0xFC, 0x71, 0x00, 0x38, 0x3F, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '3'
+0x00, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x80, 0x0F, 0x00, 0xF0, 0x0D, 0x00, 0x3C, 0x0C, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '4'
+0x00, 0x00, 0x00, 0xFE, 0x19, 0x00, 0xFE, 0x39, 0x00, 0x86, 0x70, 0x00, 0xC6, 0x60, 0x00, 0xC6, 0x60, 0x00, 0xC6, 0x71, 0x00, 0x86, 0x3F, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '5'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x8E, 0x71, 0x00, 0xC6, 0x60, 0x00, 0xC6, 0x60, 0x00, 0xCE, 0x71, 0x00, 0x9C, 0x3F, 0x00, 0x18, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '6'
+0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x70, 0x00, 0x06, 0x7F, 0x00, 0xC6, 0x07, 0x00, 0xF6, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '7'
+0x00, 0x00, 0x00, 0x38, 0x1E, 0x00, 0x7C, 0x3F, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x8E, 0x61, 0x00, 0x7C, 0x3F, 0x00, 0x38, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '8'
+0x00, 0x00, 0x00, 0xF8, 0x18, 0x00, 0xFC, 0x39, 0x00, 0x8E, 0x73, 0x00, 0x06, 0x63, 0x00, 0x06, 0x63, 0x00, 0x8E, 0x71, 0x00, 0xFC, 0x3F, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '9'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ':'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x60, 0x02, 0xC0, 0xE0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ';'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x80, 0x03, 0x00, 0x80, 0x02, 0x00, 0xC0, 0x06, 0x00, 0x40, 0x04, 0x00, 0x60, 0x0C, 0x00, 0x20, 0x08, 0x00, 0x30, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '<'
+0x00, 0x00, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x60, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '='
+0x00, 0x00, 0x00, 0x30, 0x18, 0x00, 0x20, 0x08, 0x00, 0x60, 0x0C, 0x00, 0x40, 0x04, 0x00, 0xC0, 0x06, 0x00, 0x80, 0x02, 0x00, 0x80, 0x03, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '>'
+0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x06, 0x6E, 0x00, 0x06, 0x6F, 0x00, 0x86, 0x03, 0x00, 0xCE, 0x01, 0x00, 0xFC, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00,  // '?'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x1E, 0x70, 0x00, 0xC6, 0x63, 0x00, 0xC6, 0x67, 0x00, 0x66, 0x36, 0x00, 0xFC, 0x07, 0x00, 0xF8, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '@'
+0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x80, 0x7F, 0x00, 0xF8, 0x0F, 0x00, 0x7E, 0x06, 0x00, 0x06, 0x06, 0x00, 0x7E, 0x06, 0x00, 0xF8, 0x0F, 0x00, 0x80, 0x7F, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00,  // 'A'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0xFC, 0x73, 0x00, 0x78, 0x3E, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'B'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x0E, 0x70, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x1C, 0x38, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'C'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x1C, 0x38, 0x00, 0xFC, 0x1F, 0x00, 0xF0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'D'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x86, 0x61, 0x00, 0x06, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'E'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x86, 0x01, 0x00, 0x86, 0x01, 0x00, 0x86, 0x01, 0x00, 0x86, 0x01, 0x00, 0x86, 0x01, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'F'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x0E, 0x70, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x06, 0x63, 0x00, 0x1C, 0x3F, 0x00, 0x18, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'G'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'H'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'I'
+0x00, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x70, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x70, 0x00, 0xFE, 0x3F, 0x00, 0xFE, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'J'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x80, 0x01, 0x00, 0xC0, 0x01, 0x00, 0x70, 0x07, 0x00, 0x38, 0x0E, 0x00, 0x0C, 0x38, 0x00, 0x06, 0x70, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'K'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'L'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x1E, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x80, 0x01, 0x00, 0xF8, 0x00, 0x00, 0x0E, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00,  // 'M'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x3E, 0x00, 0x00, 0xF8, 0x01, 0x00, 0xC0, 0x1F, 0x00, 0x00, 0x7C, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'N'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x0E, 0x70, 0x00, 0x06, 0x60, 0x00, 0x06, 0x60, 0x00, 0x0E, 0x70, 0x00, 0xFC, 0x3F, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'O'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x06, 0x03, 0x00, 0x06, 0x03, 0x00, 0x06, 0x03, 0x00, 0x8E, 0x03, 0x00, 0xFC, 0x01, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'P'
+0x00, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0xFC, 0x3F, 0x00, 0x0E, 0x70, 0x00, 0x06, 0x60, 0x00, 0x06, 0x6C, 0x00, 0x0E, 0x78, 0x00, 0xFC, 0x3F, 0x00, 0xF0, 0x2F, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'Q'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x86, 0x01, 0x00, 0x86, 0x01, 0x00, 0x86, 0x03, 0x00, 0xCE, 0x0F, 0x00, 0xFC, 0x3C, 0x00, 0x78, 0x70, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'R'
+0x00, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x78, 0x3C, 0x00, 0xFC, 0x70, 0x00, 0xC6, 0x60, 0x00, 0x86, 0x61, 0x00, 0x86, 0x63, 0x00, 0x1C, 0x3F, 0x00, 0x18, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'S'
+0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'T'
+0x00, 0x00, 0x00, 0xFE, 0x1F, 0x00, 0xFE, 0x3F, 0x00, 0x00, 0x70, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x70, 0x00, 0xFE, 0x3F, 0x00, 0xFE, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'U'
+0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x7E, 0x00, 0x00, 0xF0, 0x07, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x78, 0x00, 0x80, 0x3F, 0x00, 0xF0, 0x07, 0x00, 0x7E, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'V'
+0x7E, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x70, 0x00, 0x00, 0x1E, 0x00, 0xC0, 0x03, 0x00, 0xC0, 0x03, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x70, 0x00, 0xFE, 0x7F, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'W'
+0x02, 0x40, 0x00, 0x0E, 0x70, 0x00, 0x3C, 0x38, 0x00, 0x70, 0x1E, 0x00, 0xE0, 0x0F, 0x00, 0xC0, 0x07, 0x00, 0x70, 0x0E, 0x00, 0x38, 0x3C, 0x00, 0x0E, 0x70, 0x00, 0x02, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'X'
+0x02, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x3C, 0x00, 0x00, 0xF0, 0x00, 0x00, 0xC0, 0x7F, 0x00, 0xC0, 0x7F, 0x00, 0xF0, 0x00, 0x00, 0x3C, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'Y'
+0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x06, 0x78, 0x00, 0x06, 0x6E, 0x00, 0x86, 0x67, 0x00, 0xC6, 0x61, 0x00, 0x76, 0x60, 0x00, 0x3E, 0x60, 0x00, 0x0E, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'Z'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x00, 0x03, 0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '['
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x00, 0x00, 0xFE, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '\'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x03, 0x00, 0x03, 0xFF, 0xFF, 0x03, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ']'
+0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0xE0, 0x01, 0x00, 0x78, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x78, 0x00, 0x00, 0xE0, 0x01, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '^'
+0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x01,  // '_'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x06, 0x00, 0x00, 0x0E, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '`'
+0x00, 0x00, 0x00, 0x80, 0x38, 0x00, 0xC0, 0x7C, 0x00, 0x60, 0x66, 0x00, 0x60, 0x66, 0x00, 0x60, 0x26, 0x00, 0x60, 0x36, 0x00, 0xE0, 0x3F, 0x00, 0xC0, 0x7F, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'a'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0xC0, 0x30, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0xE0, 0x70, 0x00, 0xC0, 0x3F, 0x00, 0x80, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'b'
+0x00, 0x00, 0x00, 0x80, 0x1F, 0x00, 0xC0, 0x3F, 0x00, 0xE0, 0x70, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0xE0, 0x70, 0x00, 0xC0, 0x39, 0x00, 0x80, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'c'
+0x00, 0x00, 0x00, 0x80, 0x1F, 0x00, 0xC0, 0x3F, 0x00, 0xE0, 0x70, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0xC0, 0x30, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'd'
+0x00, 0x00, 0x00, 0x80, 0x1F, 0x00, 0xC0, 0x3F, 0x00, 0xE0, 0x76, 0x00, 0x60, 0x66, 0x00, 0x60, 0x66, 0x00, 0xE0, 0x66, 0x00, 0xC0, 0x37, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'e'
+0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xFC, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x66, 0x00, 0x00, 0x66, 0x00, 0x00, 0x66, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'f'
+0x00, 0x00, 0x00, 0xC0, 0x8F, 0x01, 0xE0, 0x9F, 0x03, 0x70, 0x38, 0x03, 0x30, 0x30, 0x03, 0x30, 0x30, 0x03, 0x60, 0x98, 0x03, 0xF0, 0xFF, 0x01, 0xF0, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'g'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0xC0, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'h'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE6, 0x7F, 0x00, 0xE6, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'i'
+0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x30, 0x00, 0x03, 0x30, 0x00, 0x03, 0x30, 0x00, 0x03, 0xF3, 0xFF, 0x03, 0xF3, 0xFF, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'j'
+0x00, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x06, 0x00, 0x00, 0x03, 0x00, 0x80, 0x07, 0x00, 0xC0, 0x1C, 0x00, 0x60, 0x38, 0x00, 0x20, 0x60, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00,  // 'k'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0x06, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'l'
+0xE0, 0x7F, 0x00, 0xE0, 0x7F, 0x00, 0x40, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x7F, 0x00, 0x00, 0x00, 0x00,  // 'm'
+0x00, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'n'
+0x00, 0x00, 0x00, 0x80, 0x1F, 0x00, 0xC0, 0x3F, 0x00, 0xE0, 0x70, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0xE0, 0x70, 0x00, 0xC0, 0x3F, 0x00, 0x80, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'o'
+0x00, 0x00, 0x00, 0xF0, 0xFF, 0x03, 0xF0, 0xFF, 0x03, 0x60, 0x18, 0x00, 0x30, 0x30, 0x00, 0x30, 0x30, 0x00, 0x70, 0x38, 0x00, 0xE0, 0x1F, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'p'
+0x00, 0x00, 0x00, 0xC0, 0x0F, 0x00, 0xE0, 0x1F, 0x00, 0x70, 0x38, 0x00, 0x30, 0x30, 0x00, 0x30, 0x30, 0x00, 0x60, 0x18, 0x00, 0xF0, 0xFF, 0x03, 0xF0, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'q'
+0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0xE0, 0x7F, 0x00, 0xC0, 0x7F, 0x00, 0xC0, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'r'
+0x00, 0x00, 0x00, 0x80, 0x33, 0x00, 0xC0, 0x37, 0x00, 0x60, 0x66, 0x00, 0x60, 0x66, 0x00, 0x60, 0x66, 0x00, 0x60, 0x66, 0x00, 0xC0, 0x3E, 0x00, 0xC0, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 's'
+0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0xF8, 0x3F, 0x00, 0xFC, 0x7F, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 't'
+0x00, 0x00, 0x00, 0xE0, 0x3F, 0x00, 0xE0, 0x7F, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x60, 0x00, 0x00, 0x30, 0x00, 0xE0, 0x7F, 0x00, 0xE0, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'u'
+0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0xE0, 0x01, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x70, 0x00, 0x00, 0x7E, 0x00, 0xC0, 0x0F, 0x00, 0xE0, 0x01, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'v'
+0xE0, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0x78, 0x00, 0xE0, 0x1F, 0x00, 0xE0, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0x78, 0x00, 0xE0, 0x1F, 0x00, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'w'
+0x00, 0x00, 0x00, 0x20, 0x40, 0x00, 0xE0, 0x70, 0x00, 0xC0, 0x39, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x0F, 0x00, 0xC0, 0x39, 0x00, 0xE0, 0x70, 0x00, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'x'
+0x00, 0x00, 0x00, 0x30, 0x00, 0x03, 0xF0, 0x01, 0x03, 0xC0, 0x8F, 0x03, 0x00, 0xFE, 0x01, 0x00, 0xF0, 0x01, 0x80, 0x7F, 0x00, 0xF0, 0x0F, 0x00, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'y'
+0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x60, 0x70, 0x00, 0x60, 0x78, 0x00, 0x60, 0x6C, 0x00, 0x60, 0x66, 0x00, 0x60, 0x63, 0x00, 0xE0, 0x61, 0x00, 0xE0, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00,  // 'z'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x80, 0x07, 0x00, 0xFE, 0xFF, 0x01, 0xFF, 0xFC, 0x03, 0x03, 0x00, 0x03, 0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '{'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '|'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x03, 0x00, 0x03, 0xFF, 0xFC, 0x03, 0xFE, 0xFF, 0x01, 0x80, 0x07, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '}'
+0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x80, 0x01, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '~'
+};
+#endif
+
+#ifdef SSD1306_INCLUDE_FONT_16x26
+const uint8_t Font16x26Strips[] = {
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ' '
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x03, 0x1C, 0x00, 0xFF, 0x7F, 0x1C, 0x00, 0xFF, 0x7F, 0x1C, 0x00, 0xFF, 0x7F, 0x1C, 0x00, 0xFF, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '!'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '"'
+0x00, 0x60, 0x00, 0x00, 0x80, 0x60, 0x00, 0x00, 0xC0, 0x60, 0x1C, 0x00, 0xC0, 0xE0, 0x1F, 0x00, 0xC0, 0xFE, 0x1F, 0x00, 0xE0, 0xFF, 0x0F, 0x00, 0xFE, 0xFF, 0x00, 0x00, 0xFF, 0x6F, 0x18, 0x00, 0xFF, 0xE0, 0x1F, 0x00, 0xC7, 0xFC, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xFC, 0xFF, 0x01, 0x00, 0xFF, 0x7F, 0x00, 0x00, 0xFF, 0x60, 0x00, 0x00, 0xCF, 0x60, 0x00, 0x00, 0xC0, 0x60, 0x00, 0x00,  // '#'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x00, 0xFC, 0x00, 0x0C, 0x00, 0xFE, 0x01, 0x1C, 0x00, 0xFE, 0x03, 0x1C, 0x00, 0xFF, 0x07, 0x18, 0x00, 0x87, 0xFF, 0x7F, 0x00, 0xFF, 0xFF, 0x7F, 0x00, 0xFF, 0xFF, 0x7F, 0x00, 0xFF, 0xFF, 0x7F, 0x00, 0x03, 0xFC, 0x1F, 0x00, 0x07, 0xF8, 0x0F, 0x00, 0x07, 0xF8, 0x0F, 0x00, 0x06, 0xF0, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,  // '$'
+0xFE, 0x01, 0x18, 0x00, 0xFE, 0x01, 0x1C, 0x00, 0xFF, 0x03, 0x1F, 0x00, 0x03, 0x83, 0x0F, 0x00, 0x01, 0xC2, 0x07, 0x00, 0xCF, 0xF3, 0x01, 0x00, 0xFF, 0xFB, 0x00, 0x00, 0xFE, 0x7F, 0x00, 0x00, 0xFC, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0xE0, 0xFB, 0x1F, 0x00, 0xF0, 0xF9, 0x1F, 0x00, 0xFC, 0x18, 0x18, 0x00, 0x3E, 0x18, 0x18, 0x00, 0x1F, 0xF8, 0x1F, 0x00, 0x07, 0xF8, 0x1F, 0x00,  // '%'
+0x00, 0xF8, 0x03, 0x00, 0x00, 0xFC, 0x07, 0x00, 0x00, 0xFC, 0x0F, 0x00, 0x38, 0xFE, 0x1F, 0x00, 0xFE, 0x0F, 0x1E, 0x00, 0xFF, 0x07, 0x1C, 0x00, 0xFF, 0x1F, 0x18, 0x00, 0xFF, 0x3F, 0x18, 0x00, 0x83, 0xFF, 0x18, 0x00, 0xFF, 0xFD, 0x1D, 0x00, 0xFF, 0xF1, 0x1F, 0x00, 0xFE, 0xE0, 0x0F, 0x00, 0x7E, 0x80, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x00, 0xFC, 0x1F, 0x00, 0x00, 0xFC, 0x1D, 0x00,  // '&'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '''
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xFC, 0xFF, 0x3F, 0x00, 0xFC, 0x81, 0x3F, 0x00, 0x3E, 0x00, 0x7C, 0x00, 0x0F, 0x00, 0xF0, 0x00, 0x07, 0x00, 0xE0, 0x00, 0x03, 0x00, 0xC0, 0x01, 0x03, 0x00, 0xC0, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01,  // '('
+0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x03, 0x00, 0xC0, 0x01, 0x03, 0x00, 0xC0, 0x01, 0x07, 0x00, 0xE0, 0x00, 0x0F, 0x00, 0xF0, 0x00, 0x3E, 0x00, 0x7C, 0x00, 0xFC, 0x81, 0x3F, 0x00, 0xFC, 0xFF, 0x3F, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ')'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x38, 0x04, 0x00, 0x00, 0x38, 0x06, 0x00, 0x00, 0x30, 0x0F, 0x00, 0x00, 0xF3, 0x0F, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x00, 0x1F, 0x01, 0x00, 0x00, 0xBF, 0x03, 0x00, 0x00, 0xF1, 0x0F, 0x00, 0x00, 0xB0, 0x0F, 0x00, 0x00, 0x38, 0x0F, 0x00, 0x00, 0x38, 0x04, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,  // '*'
+0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00,  // '+'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x02, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ','
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '-'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '.'
+0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00,  // '/'
+0x00, 0x00, 0x00, 0x00, 0xE0, 0xFF, 0x00, 0x00, 0xF8, 0xFF, 0x03, 0x00, 0xFC, 0xFF, 0x07, 0x00, 0xFE, 0xFF, 0x0F, 0x00, 0x7F, 0xC0, 0x1F, 0x00, 0x0F, 0x00, 0x1E, 0x00, 0x07, 0x00, 0x1C, 0x00, 0x03, 0x00, 0x18, 0x00, 0x07, 0x00, 0x1C, 0x00, 0x0F, 0x00, 0x1E, 0x00, 0x7F, 0xC0, 0x1F, 0x00, 0xFE, 0xFF, 0x0F, 0x00, 0xFC, 0xFF, 0x07, 0x00, 0xF8, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x00, 0x00,  // '0'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x18, 0x00, 0x0C, 0x00, 0x18, 0x00, 0x0C, 0x00, 0x18, 0x00, 0x0E, 0x00, 0x18, 0x00, 0x0E, 0x00, 0x18, 0x00, 0xFE, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00,  // '1'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x1E, 0x00, 0x06, 0x00, 0x1F, 0x00, 0x07, 0x80, 0x1F, 0x00, 0x07, 0xE0, 0x1F, 0x00, 0x03, 0xF0, 0x1B, 0x00, 0x03, 0xF8, 0x18, 0x00, 0x03, 0x7C, 0x18, 0x00, 0x07, 0x3E, 0x18, 0x00, 0xFF, 0x1F, 0x18, 0x00, 0xFE, 0x0F, 0x18, 0x00, 0xFE, 0x07, 0x18, 0x00, 0xFC, 0x03, 0x18, 0x00, 0x70, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00,  // '2'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x1C, 0x00, 0x07, 0x06, 0x1C, 0x00, 0x07, 0x06, 0x1C, 0x00, 0x03, 0x06, 0x18, 0x00, 0x03, 0x06, 0x18, 0x00, 0x03, 0x07, 0x18, 0x00, 0x07, 0x0F, 0x1C, 0x00, 0xFF, 0x1F, 0x1E, 0x00, 0xFF, 0xFF, 0x0F, 0x00, 0xFE, 0xFD, 0x0F, 0x00, 0xFC, 0xF8, 0x07, 0x00, 0x38, 0xF0, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,  // '3'
+0x00, 0x60, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x80, 0x7F, 0x00, 0x00, 0xE0, 0x67, 0x00, 0x00, 0xF0, 0x63, 0x00, 0x00, 0xF8, 0x60, 0x00, 0x00, 0x7E, 0x60, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00,  // '4'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x03, 0x1C, 0x00, 0xFF, 0x03, 0x1C, 0x00, 0xFF, 0x03, 0x1C, 0x00, 0xFF, 0x03, 0x18, 0x00, 0x07, 0x03, 0x18, 0x00, 0x07, 0x07, 0x18, 0x00, 0x07, 0x0F, 0x1C, 0x00, 0x07, 0xBF, 0x1F, 0x00, 0x07, 0xFE, 0x0F, 0x00, 0x07, 0xFE, 0x0F, 0x00, 0x07, 0xFC, 0x07, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,  // '5'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x00, 0x00, 0xE0, 0xFF, 0x01, 0x00, 0xF8, 0xFF, 0x07, 0x00, 0xFC, 0xFF, 0x0F, 0x00, 0xFE, 0xFF, 0x0F, 0x00, 0x3E, 0x0E, 0x1F, 0x00, 0x0F, 0x07, 0x1C, 0x00, 0x07, 0x03, 0x18, 0x00, 0x03, 0x03, 0x18, 0x00, 0x03, 0x07, 0x1C, 0x00, 0x03, 0x0F, 0x1E, 0x00, 0x07, 0xFF, 0x0F, 0x00, 0x07, 0xFE, 0x0F, 0x00, 0x06, 0xFC, 0x07, 0x00, 0x00, 0xF8, 0x03, 0x00,  // '6'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x07, 0x00, 0x18, 0x00, 0x07, 0x00, 0x1F, 0x00, 0x07, 0x80, 0x1F, 0x00, 0x07, 0xE0, 0x1F, 0x00, 0x07, 0xF8, 0x1F, 0x00, 0x07, 0xFE, 0x03, 0x00, 0x07, 0x7F, 0x00, 0x00, 0xC7, 0x1F, 0x00, 0x00, 0xF7, 0x07, 0x00, 0x00, 0xFF, 0x01, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00,  // '7'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x30, 0xF0, 0x07, 0x00, 0xFC, 0xF8, 0x0F, 0x00, 0xFE, 0xFD, 0x0F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0x1F, 0x1C, 0x00, 0x87, 0x07, 0x1C, 0x00, 0x03, 0x0F, 0x18, 0x00, 0x03, 0x0F, 0x18, 0x00, 0x87, 0x1F, 0x1C, 0x00, 0xFF, 0x7F, 0x1E, 0x00, 0xFF, 0xFD, 0x0F, 0x00, 0xFE, 0xF8, 0x0F, 0x00, 0x7C, 0xF0, 0x07, 0x00, 0x00, 0xE0, 0x03, 0x00,  // '8'
+0x00, 0x00, 0x00, 0x00, 0xE0, 0x01, 0x00, 0x00, 0xF8, 0x07, 0x0C, 0x00, 0xFC, 0x0F, 0x1C, 0x00, 0xFE, 0x0F, 0x1C, 0x00, 0xFF, 0x1F, 0x18, 0x00, 0x07, 0x1C, 0x18, 0x00, 0x03, 0x18, 0x18, 0x00, 0x03, 0x18, 0x1C, 0x00, 0x07, 0x18, 0x1C, 0x00, 0x0F, 0x1C, 0x1F, 0x00, 0xFF, 0xEF, 0x0F, 0x00, 0xFE, 0xFF, 0x07, 0x00, 0xFC, 0xFF, 0x03, 0x00, 0xF8, 0xFF, 0x01, 0x00, 0xE0, 0x3F, 0x00, 0x00,  // '9'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ':'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x03, 0x1E, 0x03, 0xC0, 0x03, 0xFE, 0x03, 0xC0, 0x03, 0xFE, 0x03, 0xC0, 0x03, 0xFE, 0x01, 0xC0, 0x03, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ';'
+0x00, 0x20, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xDC, 0x01, 0x00, 0x00, 0x8E, 0x03, 0x00, 0x00, 0x8E, 0x03, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00, 0x07, 0x07, 0x00, 0x80, 0x03, 0x0E, 0x00, 0x80, 0x03, 0x0E, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x01, 0x1C, 0x00,  // '<'
+0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00, 0x00, 0x8C, 0x01, 0x00,  // '='
+0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0x80, 0x03, 0x0E, 0x00, 0x80, 0x03, 0x0E, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00, 0x8E, 0x03, 0x00, 0x00, 0x8E, 0x03, 0x00, 0x00, 0xDC, 0x01, 0x00, 0x00, 0xDC, 0x01, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00,  // '>'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x03, 0x60, 0x1C, 0x00, 0x03, 0x78, 0x1C, 0x00, 0x03, 0x7C, 0x1C, 0x00, 0x03, 0x7E, 0x1C, 0x00, 0x03, 0x7F, 0x1C, 0x00, 0x87, 0x07, 0x00, 0x00, 0xFF, 0x03, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x7C, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,  // '?'
+0x00, 0x3F, 0x00, 0x00, 0xE0, 0xFF, 0x01, 0x00, 0xF8, 0xFF, 0x03, 0x00, 0xFC, 0xFF, 0x07, 0x00, 0x7E, 0x80, 0x0F, 0x00, 0x1E, 0x00, 0x0E, 0x00, 0x8F, 0xFF, 0x1C, 0x00, 0xC7, 0xFF, 0x1D, 0x00, 0xE3, 0xFF, 0x19, 0x00, 0xF3, 0xC1, 0x19, 0x00, 0x73, 0xC0, 0x19, 0x00, 0x37, 0xF0, 0x1D, 0x00, 0x7F, 0xFE, 0x1C, 0x00, 0xFE, 0xFF, 0x0D, 0x00, 0xFE, 0xFF, 0x01, 0x00, 0xF8, 0xFF, 0x01, 0x00,  // '@'
+0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x00, 0x00, 0xF8, 0xDF, 0x00, 0x00, 0xF8, 0xC3, 0x00, 0x00, 0xF8, 0xC0, 0x00, 0x00, 0xF8, 0xC7, 0x00, 0x00, 0xF8, 0xFF, 0x00, 0x00, 0xE0, 0xFF, 0x01, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x00, 0xFC, 0x1F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0x80, 0x1F, 0x00,  // 'A'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x3C, 0x18, 0x00, 0x38, 0x3E, 0x18, 0x00, 0xF8, 0xFF, 0x1C, 0x00, 0xF8, 0xF7, 0x1F, 0x00, 0xF0, 0xE7, 0x0F, 0x00, 0xE0, 0xE3, 0x0F, 0x00, 0x00, 0xC0, 0x07, 0x00,  // 'B'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xC0, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xF0, 0xC1, 0x0F, 0x00, 0x70, 0x00, 0x0F, 0x00, 0x38, 0x00, 0x1E, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x38, 0x00, 0x18, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x38, 0x00, 0x1C, 0x00,  // 'C'
+0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x38, 0x00, 0x1C, 0x00, 0xF8, 0x00, 0x0F, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xF0, 0xFF, 0x07, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xC0, 0xFF, 0x01, 0x00,  // 'D'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00,  // 'E'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00,  // 'F'
+0x00, 0x3C, 0x00, 0x00, 0x80, 0xFF, 0x01, 0x00, 0xC0, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xF0, 0x81, 0x0F, 0x00, 0x78, 0x00, 0x1E, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x18, 0x30, 0x18, 0x00, 0x18, 0x30, 0x18, 0x00, 0x18, 0x30, 0x18, 0x00, 0x18, 0xF0, 0x1F, 0x00, 0x38, 0xF0, 0x1F, 0x00, 0x38, 0xF0, 0x1F, 0x00, 0x30, 0xF0, 0x0F, 0x00,  // 'G'
+0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00,  // 'H'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00,  // 'I'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x1C, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x07, 0x00, 0xF8, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'J'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x80, 0xFF, 0x00, 0x00, 0xC0, 0xF7, 0x03, 0x00, 0xE0, 0xE3, 0x07, 0x00, 0xF8, 0xC0, 0x0F, 0x00, 0x78, 0x00, 0x1F, 0x00, 0x38, 0x00, 0x1E, 0x00, 0x18, 0x00, 0x1C, 0x00, 0x08, 0x00, 0x18, 0x00,  // 'K'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00,  // 'L'
+0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0x0F, 0x00, 0x00, 0xF0, 0x3F, 0x00, 0x00, 0xC0, 0xFF, 0x01, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0xFE, 0x01, 0x00, 0xC0, 0xFF, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xF8, 0x03, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00,  // 'M'
+0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xE0, 0x0F, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00,  // 'N'
+0x00, 0x7E, 0x00, 0x00, 0xC0, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0x78, 0x00, 0x1E, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x78, 0x00, 0x1E, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xC0, 0xFF, 0x03, 0x00,  // 'O'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x30, 0x00, 0x00, 0x18, 0x30, 0x00, 0x00, 0x18, 0x30, 0x00, 0x00, 0x18, 0x38, 0x00, 0x00, 0x38, 0x3C, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00,  // 'P'
+0x00, 0x7E, 0x00, 0x00, 0xC0, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x07, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0xF0, 0xFF, 0x0F, 0x00, 0x78, 0x00, 0x1E, 0x00, 0x38, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x18, 0x00, 0x38, 0x00, 0x38, 0x00, 0x7C, 0x00, 0x78, 0x00, 0x7E, 0x00, 0xF0, 0xFF, 0xFF, 0x00, 0xF0, 0xFF, 0xEF, 0x00, 0xE0, 0xFF, 0xC7, 0x01, 0xC0, 0xFF, 0xC3, 0x01,  // 'Q'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x30, 0x00, 0x00, 0x18, 0x70, 0x00, 0x00, 0x18, 0xF8, 0x00, 0x00, 0x38, 0xF8, 0x01, 0x00, 0x78, 0xFE, 0x03, 0x00, 0xF8, 0xDF, 0x0F, 0x00, 0xF0, 0x8F, 0x1F, 0x00, 0xF0, 0x0F, 0x1F, 0x00, 0xE0, 0x03, 0x1E, 0x00, 0x00, 0x00, 0x18, 0x00,  // 'R'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x03, 0x0E, 0x00, 0xF0, 0x07, 0x1C, 0x00, 0xF0, 0x0F, 0x1C, 0x00, 0xF8, 0x0F, 0x1C, 0x00, 0x38, 0x1E, 0x18, 0x00, 0x18, 0x1C, 0x18, 0x00, 0x18, 0x1C, 0x18, 0x00, 0x18, 0x3C, 0x18, 0x00, 0x18, 0x38, 0x1C, 0x00, 0x18, 0x78, 0x1E, 0x00, 0x38, 0xF8, 0x0F, 0x00, 0x38, 0xF0, 0x0F, 0x00, 0x30, 0xF0, 0x07, 0x00, 0x00, 0xE0, 0x03, 0x00,  // 'S'
+0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,  // 'T'
+0x00, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x00, 0x00, 0xF8, 0xFF, 0x07, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x1F, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x07, 0x00, 0xF8, 0xFF, 0x00, 0x00,  // 'U'
+0x38, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xF8, 0x3F, 0x00, 0x00, 0xE0, 0xFF, 0x00, 0x00, 0x80, 0xFF, 0x07, 0x00, 0x00, 0xFC, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x00, 0x80, 0x1F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xFF, 0x07, 0x00, 0xC0, 0xFF, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00,  // 'V'
+0xF8, 0x03, 0x00, 0x00, 0xF8, 0xFF, 0x01, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF0, 0xFF, 0x1F, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x03, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0xFF, 0x03, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xE0, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x00, 0x00,  // 'W'
+0x08, 0x00, 0x10, 0x00, 0x18, 0x00, 0x1C, 0x00, 0x78, 0x00, 0x1E, 0x00, 0xF8, 0x00, 0x1F, 0x00, 0xF8, 0xC1, 0x0F, 0x00, 0xF0, 0xE7, 0x03, 0x00, 0xE0, 0xFF, 0x01, 0x00, 0x80, 0xFF, 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0xFF, 0x01, 0x00, 0xC0, 0xFF, 0x03, 0x00, 0xE0, 0xE3, 0x07, 0x00, 0xF0, 0xC1, 0x1F, 0x00, 0xF8, 0x80, 0x1F, 0x00, 0x78, 0x00, 0x1E, 0x00, 0x18, 0x00, 0x1C, 0x00,  // 'X'
+0x08, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x01, 0x00, 0x00, 0xF8, 0x07, 0x00, 0x00, 0xE0, 0x0F, 0x00, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xFF, 0x1F, 0x00, 0x00, 0xFC, 0x1F, 0x00, 0x00, 0xFE, 0x1F, 0x00, 0x00, 0xFF, 0x1F, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0xE0, 0x07, 0x00, 0x00, 0xF8, 0x01, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00,  // 'Y'
+0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x1C, 0x00, 0x18, 0x00, 0x1E, 0x00, 0x18, 0x00, 0x1F, 0x00, 0x18, 0xC0, 0x1F, 0x00, 0x18, 0xE0, 0x1F, 0x00, 0x18, 0xF0, 0x1B, 0x00, 0x18, 0xF8, 0x18, 0x00, 0x18, 0x7E, 0x18, 0x00, 0x18, 0x3F, 0x18, 0x00, 0x98, 0x1F, 0x18, 0x00, 0xD8, 0x07, 0x18, 0x00, 0xF8, 0x03, 0x18, 0x00, 0xF8, 0x01, 0x18, 0x00, 0xF8, 0x00, 0x18, 0x00, 0x78, 0x00, 0x18, 0x00,  // 'Z'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01,  // '['
+0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xF0, 0x0F, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0xC0, 0x01,  // '\'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ']'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFF, 0x01, 0x00, 0xE0, 0x3F, 0x00, 0x00, 0xF8, 0x0F, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0xFF, 0x01, 0x00, 0x00, 0xF8, 0x0F, 0x00, 0x00, 0xE0, 0x3F, 0x00, 0x00, 0x80, 0xFF, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xF0, 0x01, 0x00, 0x00, 0xC0, 0x01, 0x00,  // '^'
+0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x60, 0x00,  // '_'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '`'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x07, 0x00, 0x80, 0xC1, 0x0F, 0x00, 0x80, 0xE1, 0x1F, 0x00, 0xC0, 0xE1, 0x1F, 0x00, 0xC0, 0xF1, 0x1E, 0x00, 0xC0, 0x70, 0x18, 0x00, 0xC0, 0x30, 0x18, 0x00, 0xC0, 0x30, 0x18, 0x00, 0xC0, 0x31, 0x1C, 0x00, 0xC0, 0xFF, 0x0F, 0x00, 0xC0, 0xFF, 0x0F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xFE, 0x1F, 0x00, 0x00, 0x00, 0x18, 0x00,  // 'a'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x0F, 0x00, 0x80, 0x03, 0x1C, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x03, 0x1F, 0x00, 0xC0, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x07, 0x00, 0x00, 0xFE, 0x01, 0x00,  // 'b'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0xC0, 0x07, 0x1F, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0x80, 0x01, 0x0C, 0x00,  // 'c'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0xC0, 0x9F, 0x1F, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x1C, 0x00, 0xC0, 0x01, 0x0E, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00,  // 'd'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0xC0, 0x33, 0x1E, 0x00, 0xC0, 0x31, 0x1C, 0x00, 0xC0, 0x30, 0x18, 0x00, 0xC0, 0x30, 0x18, 0x00, 0xC0, 0x31, 0x18, 0x00, 0xC0, 0x3F, 0x18, 0x00, 0xC0, 0x3F, 0x18, 0x00, 0x80, 0x3F, 0x1C, 0x00, 0x00, 0x3F, 0x1C, 0x00, 0x00, 0x3C, 0x0C, 0x00,  // 'e'
+0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xFE, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xC3, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00, 0xC3, 0x00, 0x00, 0x00,  // 'f'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFF, 0x07, 0x03, 0x80, 0xFF, 0x0F, 0x03, 0x80, 0xFF, 0x1F, 0x03, 0xC0, 0x8F, 0x1F, 0x02, 0xC0, 0x01, 0x1C, 0x02, 0xC0, 0x00, 0x18, 0x02, 0xC0, 0x00, 0x18, 0x02, 0xC0, 0x01, 0x1C, 0x03, 0xC0, 0x01, 0x0E, 0x03, 0x80, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x01, 0xC0, 0xFF, 0xFF, 0x00, 0xC0, 0xFF, 0x1F, 0x00,  // 'g'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x80, 0x07, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xFE, 0x1F, 0x00,  // 'h'
+0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC3, 0xFF, 0x1F, 0x00, 0xC3, 0xFF, 0x1F, 0x00, 0xC3, 0xFF, 0x1F, 0x00, 0xC3, 0xFF, 0x1F, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'i'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xC0, 0x00, 0x00, 0x03, 0xC0, 0x00, 0x00, 0x03, 0xC0, 0x00, 0x00, 0x02, 0xC0, 0x00, 0x00, 0x02, 0xC0, 0x00, 0x00, 0x02, 0xC0, 0x00, 0x00, 0x03, 0xC3, 0xFF, 0xFF, 0x03, 0xC3, 0xFF, 0xFF, 0x03, 0xC3, 0xFF, 0xFF, 0x03, 0xC3, 0xFF, 0xFF, 0x01, 0xC3, 0xFF, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'j'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0xFF, 0x03, 0x00, 0x80, 0xCF, 0x07, 0x00, 0xC0, 0x87, 0x1F, 0x00, 0xC0, 0x03, 0x1F, 0x00, 0xC0, 0x01, 0x1E, 0x00, 0xC0, 0x00, 0x1C, 0x00, 0x40, 0x00, 0x18, 0x00,  // 'k'
+0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'l'
+0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0x0F, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0x07, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x80, 0x0F, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00,  // 'm'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0x07, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xFE, 0x1F, 0x00,  // 'n'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0xC0, 0x07, 0x1F, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x07, 0x1F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x00, 0xFE, 0x03, 0x00,  // 'o'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0x80, 0x03, 0x1E, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x03, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x07, 0x00, 0x00, 0xFE, 0x01, 0x00,  // 'p'
+0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xFF, 0x0F, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0xC0, 0x07, 0x1F, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x01, 0x0E, 0x00, 0x80, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0xC0, 0xFF, 0xFF, 0x03, 0x00, 0x00, 0x00, 0x00,  // 'q'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x80, 0x07, 0x00, 0x00, 0xC0, 0x03, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x07, 0x00, 0x00, 0xC0, 0x07, 0x00, 0x00, 0xC0, 0x07, 0x00, 0x00,  // 'r'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0E, 0x0C, 0x00, 0x80, 0x1F, 0x1C, 0x00, 0x80, 0x1F, 0x1C, 0x00, 0xC0, 0x3F, 0x1C, 0x00, 0xC0, 0x3F, 0x18, 0x00, 0xC0, 0x38, 0x18, 0x00, 0xC0, 0x70, 0x18, 0x00, 0xC0, 0x70, 0x18, 0x00, 0xC0, 0xF0, 0x1C, 0x00, 0xC0, 0xE0, 0x1F, 0x00, 0xC0, 0xE1, 0x0F, 0x00, 0xC0, 0xE1, 0x0F, 0x00, 0x80, 0xC1, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,  // 's'
+0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xF8, 0xFF, 0x07, 0x00, 0xF8, 0xFF, 0x0F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xF8, 0xFF, 0x1F, 0x00, 0xC0, 0x00, 0x1C, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x18, 0x00,  // 't'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xFF, 0x07, 0x00, 0xC0, 0xFF, 0x0F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x1C, 0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x0F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00,  // 'u'
+0x40, 0x00, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x80, 0xFF, 0x01, 0x00, 0x00, 0xFE, 0x07, 0x00, 0x00, 0xF8, 0x1F, 0x00, 0x00, 0xC0, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0xC0, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x00, 0xFE, 0x07, 0x00, 0x80, 0xFF, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0xC0, 0x0F, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00,  // 'v'
+0xC0, 0x0F, 0x00, 0x00, 0xC0, 0xFF, 0x01, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x00, 0xF0, 0x1F, 0x00, 0x00, 0xFF, 0x1F, 0x00, 0x80, 0xFF, 0x01, 0x00, 0x80, 0x1F, 0x00, 0x00, 0x80, 0xFF, 0x01, 0x00, 0x80, 0xFF, 0x1F, 0x00, 0x00, 0xFC, 0x1F, 0x00, 0x00, 0xC0, 0x1F, 0x00, 0x00, 0xFE, 0x1F, 0x00, 0xC0, 0xFF, 0x1F, 0x00, 0xC0, 0xFF, 0x01, 0x00,  // 'w'
+0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x10, 0x00, 0xC0, 0x01, 0x1C, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x07, 0x1F, 0x00, 0xC0, 0xDF, 0x0F, 0x00, 0x80, 0xFF, 0x07, 0x00, 0x00, 0xFE, 0x01, 0x00, 0x00, 0xFC, 0x01, 0x00, 0x00, 0xFC, 0x03, 0x00, 0x00, 0xFF, 0x07, 0x00, 0x80, 0xDF, 0x1F, 0x00, 0xC0, 0x87, 0x1F, 0x00, 0xC0, 0x03, 0x1E, 0x00, 0xC0, 0x00, 0x1C, 0x00, 0x40, 0x00, 0x18, 0x00,  // 'x'
+0x40, 0x00, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x02, 0xC0, 0x07, 0x00, 0x02, 0xC0, 0x3F, 0x00, 0x02, 0xC0, 0xFF, 0x00, 0x03, 0x00, 0xFF, 0x83, 0x03, 0x00, 0xF8, 0xFF, 0x03, 0x00, 0xE0, 0xFF, 0x03, 0x00, 0x80, 0xFF, 0x01, 0x00, 0xC0, 0x7F, 0x00, 0x00, 0xF8, 0x0F, 0x00, 0x00, 0xFE, 0x03, 0x00, 0x80, 0xFF, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0xC0, 0x07, 0x00, 0x00, 0xC0, 0x01, 0x00, 0x00,  // 'y'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0xC0, 0x00, 0x1C, 0x00, 0xC0, 0x00, 0x1F, 0x00, 0xC0, 0x80, 0x1F, 0x00, 0xC0, 0xC0, 0x1F, 0x00, 0xC0, 0xE0, 0x1B, 0x00, 0xC0, 0xF0, 0x19, 0x00, 0xC0, 0xF8, 0x18, 0x00, 0xC0, 0x7C, 0x18, 0x00, 0xC0, 0x3E, 0x18, 0x00, 0xC0, 0x1F, 0x18, 0x00, 0xC0, 0x0F, 0x18, 0x00, 0xC0, 0x07, 0x18, 0x00, 0xC0, 0x03, 0x18, 0x00, 0xC0, 0x01, 0x18, 0x00,  // 'z'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x3E, 0x3C, 0x7C, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xE7, 0xFF, 0x01, 0xC3, 0x81, 0xC3, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00,  // '{'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '|'
+0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x01, 0x00, 0x80, 0x01, 0x83, 0x81, 0xC1, 0x01, 0xFF, 0xE7, 0xFF, 0x01, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x3E, 0x3C, 0x7C, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '}'
+0x00, 0xC0, 0x00, 0x00, 0x00, 0xF0, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x70, 0x00, 0x00, 0x00, 0xF0, 0x00, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00,  // '~'
+};
+#endif
@@ -9,6 +9,7 @@ typedef struct {
 	const uint8_t FontWidth;    /*!< Font width in pixels */
 	uint8_t FontHeight;   /*!< Font height in pixels */
 	const uint16_t *data; /*!< Pointer to data font data array */
+	const uint8_t *strips; /*!< Same glyphs as page strips, see gen_font_strips.py */
 } FontDef;
 
 #ifdef SSD1306_INCLUDE_FONT_6x8
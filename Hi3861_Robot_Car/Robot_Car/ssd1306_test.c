@@ -1,221 +1,310 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <memory.h>
-#include <string.h>  // 添加string.h头文件
-
-#include "ohos_init.h"
-#include "cmsis_os2.h"
-#include "iot_gpio.h"
-#include "hi_io.h"
-#include "hi_time.h"
-#include "ssd1306.h"
-#include "iot_i2c.h"
-#include "iot_watchdog.h"
-#include "robot_control.h"
-#include "iot_errno.h"
-#include <unistd.h>
-
-#define OLED_I2C_BAUDRATE 400*1000
-#define GPIO13 13
-#define GPIO14 14
-#define FUNC_SDA 6
-#define FUNC_SCL 6
-extern unsigned char g_car_status;
-extern unsigned short SPEED_FORWARD;
-extern unsigned int MOVING_STATUS;
-
-// 定义状态模式的名称，用于标题栏显示
-char mode_name[4][15] = {
-    "STOP MODE",
-    "TRACE MODE",
-    "CONTROL MODE",
-    "AVOID MODE"
-};
-
-// 移动状态描述
-char moving_status[6][20] = {
-    "Stopping...",
-    "Turing right...",
-    "Turing left...",
-    "Moving forward...",
-    "Obstacles ahead...",
-    "Moving backward..."
-};
-
-// 绘制美化的边框和标题栏
-void DrawUIFrame(const char* title) {
-    // 绘制外边框
-    ssd1306_DrawRectangle(0, 0, 127, 63, White);
-    
-    // 绘制标题栏
-    ssd1306_DrawRectangle(2, 2, 125, 12, White);
-    
-    // 显示标题文字居中
-    int title_len = strlen(title);
-    int title_pos = (128 - title_len * 7) / 2;  // 估算居中位置，Font_7x10中7是字符宽度
-    if (title_pos < 5) title_pos = 5;
-    
-    ssd1306_SetCursor(title_pos, 3);
-    ssd1306_DrawString(title, Font_7x10, White);
-    
-    // 绘制分隔线
-    for (int i = 2; i < 126; i += 4) {
-        ssd1306_DrawPixel(i, 15, White);
-    }
-}
-
-// 显示电池图标
-void DrawBatteryIcon(uint8_t level) {
-    // level范围为0-4，表示电池电量等级
-    uint8_t bat_x = 105;
-    uint8_t bat_y = 3;
-    
-    // 绘制电池外框
-    ssd1306_DrawRectangle(bat_x, bat_y, bat_x + 18, bat_y + 8, White);
-    ssd1306_DrawRectangle(bat_x + 18, bat_y + 2, bat_x + 20, bat_y + 6, White);
-    
-    // 根据电量级别填充电池
-    for (int i = 0; i < level; i++) {
-        int x_pos = bat_x + 2 + i * 4;
-        for (int j = 0; j < 3; j++) {
-            ssd1306_DrawLine(x_pos, bat_y + 2, x_pos, bat_y + 6, White);
-            x_pos++;
-        }
-    }
-}
-
-void Ssd1306TestTask(void* arg)
-{
-    (void) arg;
-    hi_io_set_func(GPIO13, FUNC_SDA);
-    hi_io_set_func(GPIO14, FUNC_SCL);
-    IoTI2cInit(0, OLED_I2C_BAUDRATE);
-
-    IoTWatchDogDisable();
-
-    usleep(20*1000);
-    ssd1306_Init();
-    ssd1306_Fill(Black);
-    
-    // 启动动画
-    ssd1306_SetCursor(0, 0);
-    ssd1306_DrawString("Hello OpenHarmony!", Font_7x10, White);
-    
-    // 绘制启动画面边框
-    ssd1306_DrawRectangle(0, 0, 127, 63, White);
-    ssd1306_DrawRectangle(5, 15, 122, 48, White);
-    
-    ssd1306_SetCursor(15, 25);
-    ssd1306_DrawString("ROBOT CAR SYSTEM", Font_7x10, White);
-    
-    ssd1306_SetCursor(25, 38);
-    ssd1306_DrawString("STARTING...", Font_7x10, White);
-
-    uint32_t start = HAL_GetTick();
-    ssd1306_UpdateScreen();
-    uint32_t end = HAL_GetTick();
-    printf("ssd1306_UpdateScreen time cost: %d ms.\r\n", end - start);
-    osDelay(1000); // 显示启动画面时间延长
-
-    // 循环显示电池充电动画
-    for (int i = 0; i <= 4; i++) {
-        ssd1306_Fill(Black);
-        ssd1306_DrawRectangle(0, 0, 127, 63, White);
-        ssd1306_SetCursor(10, 25);
-        ssd1306_DrawString("INITIALIZING...", Font_7x10, White);
-        DrawBatteryIcon(i);
-        ssd1306_UpdateScreen();
-        osDelay(200);
-    }
-    
-    osDelay(300);
-
-    while (1)
-    {
-        ssd1306_Fill(Black);
-        char title[20] = {0};
-        char status_info[30] = {0};
-        char speed_str[20] = {0};
-
-        // 根据当前模式设置标题
-        if(g_car_status == CAR_OBSTACLE_AVOIDANCE_STATUS) {
-            strcpy(title, mode_name[3]); // "AVOID MODE"
-        } else if (g_car_status == CAR_STOP_STATUS) {
-            strcpy(title, mode_name[0]); // "STOP MODE"
-        } else if (g_car_status == CAR_TRACE_STATUS) {
-            strcpy(title, mode_name[1]); // "TRACE MODE"
-        } else if (g_car_status == CAR_CONTROL_STATUS) {
-            strcpy(title, mode_name[2]); // "CONTROL MODE"
-        }
-        
-        // 绘制UI框架
-        DrawUIFrame(title);
-        
-        // 显示电池图标（模拟75%电量）
-        DrawBatteryIcon(3);
-        
-        // 显示速度信息
-        sprintf(speed_str, "Speed: %u", SPEED_FORWARD);
-        ssd1306_SetCursor(10, 20);
-        ssd1306_DrawString(speed_str, Font_7x10, White);
-        
-        // 绘制速度条指示器
-        int speed_bar_width = (SPEED_FORWARD * 80) / 1000; // 假设最大速度为1000
-        if (speed_bar_width > 80) speed_bar_width = 80;
-        
-        ssd1306_DrawRectangle(10, 32, 90, 38, White);
-        for (int i = 0; i < speed_bar_width; i++) {
-            ssd1306_DrawLine(10 + i, 33, 10 + i, 37, White);
-        }
-        
-        // 显示移动状态
-        ssd1306_SetCursor(10, 45);
-        if (MOVING_STATUS >= 0 && MOVING_STATUS <= 5) {
-            ssd1306_DrawString(moving_status[MOVING_STATUS], Font_7x10, White);
-            
-            // 状态图标
-            if (MOVING_STATUS == 0) { // 停止
-                ssd1306_DrawRectangle(100, 45, 110, 55, White);
-            } else if (MOVING_STATUS == 1) { // 右转
-                ssd1306_DrawCircle(105, 50, 5, White);
-                ssd1306_DrawLine(110, 50, 105, 45, White);
-            } else if (MOVING_STATUS == 2) { // 左转
-                ssd1306_DrawCircle(105, 50, 5, White);
-                ssd1306_DrawLine(100, 50, 105, 45, White);
-            } else if (MOVING_STATUS == 3) { // 前进
-                ssd1306_DrawLine(105, 45, 105, 55, White);
-                ssd1306_DrawLine(105, 45, 100, 50, White);
-                ssd1306_DrawLine(105, 45, 110, 50, White);
-            } else if (MOVING_STATUS == 4) { // 障碍物
-                ssd1306_DrawLine(100, 45, 110, 55, White);
-                ssd1306_DrawLine(100, 55, 110, 45, White);
-            } else if (MOVING_STATUS == 5) { // 后退
-                ssd1306_DrawLine(105, 45, 105, 55, White);
-                ssd1306_DrawLine(105, 55, 100, 50, White);
-                ssd1306_DrawLine(105, 55, 110, 50, White);
-            }
-        }
-        
-        ssd1306_UpdateScreen();
-        osDelay(10);
-    }
-    
-}
-
-void Ssd1306TestDemo(void)
-{
-    osThreadAttr_t attr;
-
-    attr.name = "Ssd1306TestTask";
-    attr.attr_bits = 0U;
-    attr.cb_mem = NULL;
-    attr.cb_size = 0U;
-    attr.stack_mem = NULL;
-    attr.stack_size = 4096;
-    attr.priority = 25;
-
-    if (osThreadNew(Ssd1306TestTask, NULL, &attr) == NULL) {
-        printf("[Ssd1306TestDemo] Failed to create Ssd1306TestTask!\n");
-    }
-}
-APP_FEATURE_INIT(Ssd1306TestDemo);
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <string.h>  // 添加string.h头文件
+
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+#include "iot_gpio.h"
+#include "hi_io.h"
+#include "hi_time.h"
+#include "ssd1306.h"
+#include "iot_i2c.h"
+#include "iot_watchdog.h"
+#include "robot_battery.h"
+#include "robot_control.h"
+#include "robot_l9110s.h"
+#include "robot_widget.h"
+#include "iot_errno.h"
+#include <unistd.h>
+
+#define OLED_I2C_BAUDRATE 400*1000
+#define GPIO13 13
+#define GPIO14 14
+#define FUNC_SDA 6
+#define FUNC_SCL 6
+#define OLED_TASK_PRIORITY 21           // 低于调度器工作任务，让位于测距和遥测；高于驱动的刷屏任务
+#define OLED_FPS_MAX 10                 // 帧率上限，寻迹时运动状态频繁变化也合并到这么多帧
+#define OLED_FRAME_MS (1000 / OLED_FPS_MAX)
+#define OLED_REFRESH_MAX_MS 1000        // 状态不变时的最长刷新间隔，电量不计入状态版本号，靠它更新
+extern unsigned char g_car_status;
+extern unsigned short SPEED_FORWARD;
+extern unsigned int MOVING_STATUS;
+
+// 状态模式的名称，用于标题栏显示，按oled_source_mode()的返回值索引
+static const char *const mode_name[] = {
+    "STOP MODE",
+    "TRACE MODE",
+    "CONTROL MODE",
+    "AVOID MODE"
+};
+
+// 移动状态描述，按MOVING_STATUS索引
+static const char *const moving_status[] = {
+    "Stopping...",
+    "Turing right...",
+    "Turing left...",
+    "Moving forward...",
+    "Obstacles ahead...",
+    "Moving backward..."
+};
+
+// 绘制美化的边框、标题栏和分隔线，标题文字由控件绘制
+void DrawUIFrame(void) {
+    // 绘制外边框
+    ssd1306_DrawRectangle(0, 0, 127, 63, White);
+    
+    // 绘制标题栏，Font_7x10的文字占3~12行
+    ssd1306_DrawRectangle(2, 2, 125, 13, White);
+    
+    // 绘制分隔线
+    for (int i = 2; i < 126; i += 4) {
+        ssd1306_DrawPixel(i, 15, White);
+    }
+}
+
+// 电池图标位置
+#define BAT_X 105
+#define BAT_Y 3
+
+// 填充电池格，level范围为0-4，每格3列宽
+static void DrawBatteryCells(uint8_t level) {
+    for (int i = 0; i < level; i++) {
+        int x_pos = BAT_X + 2 + i * 4;
+        ssd1306_FillRect(x_pos, BAT_Y + 2, x_pos + 2, BAT_Y + 6, White);
+    }
+}
+
+// 显示电池图标
+void DrawBatteryIcon(uint8_t level) {
+    // 绘制电池外框
+    ssd1306_DrawRectangle(BAT_X, BAT_Y, BAT_X + 18, BAT_Y + 8, White);
+    ssd1306_DrawRectangle(BAT_X + 18, BAT_Y + 2, BAT_X + 20, BAT_Y + 6, White);
+    
+    DrawBatteryCells(level);
+}
+
+// 控件数据源
+static int oled_source_mode(void)
+{
+    switch (g_car_status) {
+        case CAR_STOP_STATUS:
+            return 0;
+        case CAR_TRACE_STATUS:
+            return 1;
+        case CAR_CONTROL_STATUS:
+            return 2;
+        case CAR_OBSTACLE_AVOIDANCE_STATUS:
+            return 3;
+        default:
+            return -1;
+    }
+}
+
+// 按实际电量分为0~4格，未接分压电路时显示空电池
+static int oled_source_battery(void)
+{
+    int percent = battery_get_percent();
+    return (percent < 0) ? 0 : (percent + 12) / 25;
+}
+
+static int oled_source_speed(void)
+{
+    return SPEED_FORWARD;
+}
+
+static int oled_source_moving(void)
+{
+    return (int)MOVING_STATUS;
+}
+
+static void oled_draw_battery(const Widget *widget, int value)
+{
+    (void)widget;
+    DrawBatteryCells((uint8_t)value);
+}
+
+// 运动状态图标，包围盒为(100,45)~(110,55)
+static void oled_draw_moving(const Widget *widget, int value)
+{
+    (void)widget;
+    if (value == 0) { // 停止
+        ssd1306_DrawRectangle(100, 45, 110, 55, White);
+    } else if (value == 1) { // 右转
+        ssd1306_DrawCircle(105, 50, 5, White);
+        ssd1306_DrawLine(110, 50, 105, 45, White);
+    } else if (value == 2) { // 左转
+        ssd1306_DrawCircle(105, 50, 5, White);
+        ssd1306_DrawLine(100, 50, 105, 45, White);
+    } else if (value == 3) { // 前进
+        ssd1306_DrawLine(105, 45, 105, 55, White);
+        ssd1306_DrawLine(105, 45, 100, 50, White);
+        ssd1306_DrawLine(105, 45, 110, 50, White);
+    } else if (value == 4) { // 障碍物
+        ssd1306_DrawLine(100, 45, 110, 55, White);
+        ssd1306_DrawLine(100, 55, 110, 45, White);
+    } else if (value == 5) { // 后退
+        ssd1306_DrawLine(105, 45, 105, 55, White);
+        ssd1306_DrawLine(105, 55, 100, 50, White);
+        ssd1306_DrawLine(105, 55, 110, 50, White);
+    }
+}
+
+// 状态界面控件：标题居中在电池图标左侧，速度条满格为最大占空比，
+// 状态文字在图标下层，图标盖住放不下的部分
+static Widget g_oled_widgets[] = {
+    {WIDGET_LABEL, WIDGET_ALIGN_CENTER, 4, 3, 100, 10, oled_source_mode, &Font_7x10, mode_name, NULL, 4, NULL},
+    {WIDGET_ICON, WIDGET_ALIGN_LEFT, BAT_X + 2, BAT_Y + 2, 15, 5, oled_source_battery, NULL, NULL, NULL, 0,
+     oled_draw_battery},
+    {WIDGET_VALUE, WIDGET_ALIGN_LEFT, 10, 20, 108, 10, oled_source_speed, &Font_7x10, NULL, "Speed: %d", 0, NULL},
+    {WIDGET_BAR, WIDGET_ALIGN_LEFT, 11, 33, 79, 5, oled_source_speed, NULL, NULL, NULL, PWM_DUTY_MAX, NULL},
+    {WIDGET_LABEL, WIDGET_ALIGN_LEFT, 10, 45, 117, 10, oled_source_moving, &Font_7x10, moving_status, NULL, 6, NULL},
+    {WIDGET_ICON, WIDGET_ALIGN_LEFT, 100, 45, 11, 11, oled_source_moving, NULL, NULL, NULL, 0, oled_draw_moving},
+};
+
+#define OLED_WIDGET_COUNT ((int)(sizeof(g_oled_widgets) / sizeof(g_oled_widgets[0])))
+
+// 画状态界面中不变的部分，控件全部失效，下一次oled_refresh()画出全部控件
+static void oled_layout(void)
+{
+    ssd1306_Fill(Black);
+    DrawUIFrame();
+    DrawBatteryIcon(0);
+    ssd1306_DrawRectangle(10, 32, 90, 38, White);    // 速度条外框
+    widget_invalidate(g_oled_widgets, OLED_WIDGET_COUNT);
+}
+
+// 状态界面刷新统计，oled_report()打印后清零
+static volatile unsigned int g_oled_changed = 0;        // 因状态版本号变化醒来的次数
+static volatile unsigned int g_oled_timeouts = 0;       // 等满OLED_REFRESH_MAX_MS醒来的次数
+static volatile unsigned int g_oled_frames = 0;         // 画面有变化、交给刷屏任务的帧数
+static volatile unsigned long long g_oled_draw_us = 0;  // 读数据源和重绘控件的总时间
+static unsigned long long g_oled_report_us = 0;         // 统计起点
+static unsigned long long g_oled_report_i2c_us = 0;     // 统计起点时驱动累计的I2C时间
+
+// 只重绘数据源变化了的控件，有变化时交给驱动的刷屏任务发送，不在本任务中等待I2C
+static void oled_refresh(void)
+{
+    unsigned long long begin = hi_get_us();
+
+    if (widget_update(g_oled_widgets, OLED_WIDGET_COUNT) > 0) {
+        ssd1306_Present();
+        g_oled_frames++;
+    }
+    g_oled_draw_us += hi_get_us() - begin;
+}
+
+// 状态界面主循环：画完一帧后至少隔OLED_FRAME_MS，之后睡到状态版本号变化，
+// 最长睡到距上一帧OLED_REFRESH_MAX_MS；停车不动时每秒只醒一次
+static void oled_loop(void)
+{
+    SSD1306_Stats_t stats;
+
+    ssd1306_GetStats(&stats);
+    g_oled_report_us = hi_get_us();
+    g_oled_report_i2c_us = stats.totalUs;
+    while (1) {
+        unsigned int version = car_state_version();
+        oled_refresh();
+        osDelay(OLED_FRAME_MS / 10);
+        if (car_state_wait(version, (OLED_REFRESH_MAX_MS - OLED_FRAME_MS) / 10) != version) {
+            g_oled_changed++;
+        } else {
+            g_oled_timeouts++;
+        }
+    }
+}
+
+// 打印上次调用以来状态界面的唤醒次数、帧数、绘制占用的CPU和I2C总线占用率
+void oled_report(void)
+{
+    SSD1306_Stats_t stats;
+    unsigned long long now = hi_get_us();
+    unsigned long long elapsed = now - g_oled_report_us;
+
+    if (g_oled_report_us == 0 || elapsed == 0) {
+        printf("oled display not running\r\n");
+        return;
+    }
+    ssd1306_GetStats(&stats);
+    printf("oled %u wakeups (%u changed, %u timeout), %u frames in %u ms, draw cpu %.3f%%, i2c busy %.3f%%\r\n",
+           g_oled_changed + g_oled_timeouts, g_oled_changed, g_oled_timeouts, g_oled_frames,
+           (unsigned int)(elapsed / 1000), g_oled_draw_us * 100.0 / elapsed,
+           (stats.totalUs - g_oled_report_i2c_us) * 100.0 / elapsed);
+    g_oled_changed = 0;
+    g_oled_timeouts = 0;
+    g_oled_frames = 0;
+    g_oled_draw_us = 0;
+    g_oled_report_us = now;
+    g_oled_report_i2c_us = stats.totalUs;
+}
+
+void Ssd1306TestTask(void* arg)
+{
+    (void) arg;
+    hi_io_set_func(GPIO13, FUNC_SDA);
+    hi_io_set_func(GPIO14, FUNC_SCL);
+    IoTI2cInit(0, OLED_I2C_BAUDRATE);
+
+    IoTWatchDogDisable();
+
+    usleep(20*1000);
+    ssd1306_Init();
+    ssd1306_StartFlushTask();
+    ssd1306_Fill(Black);
+    
+    // 启动动画
+    ssd1306_SetCursor(0, 0);
+    ssd1306_DrawString("Hello OpenHarmony!", Font_7x10, White);
+    
+    // 绘制启动画面边框
+    ssd1306_DrawRectangle(0, 0, 127, 63, White);
+    ssd1306_DrawRectangle(5, 15, 122, 48, White);
+    
+    ssd1306_SetCursor(15, 25);
+    ssd1306_DrawString("ROBOT CAR SYSTEM", Font_7x10, White);
+    
+    ssd1306_SetCursor(25, 38);
+    ssd1306_DrawString("STARTING...", Font_7x10, White);
+
+    SSD1306_Stats_t stats;
+    ssd1306_UpdateScreen();
+    ssd1306_GetStats(&stats);
+    printf("ssd1306_UpdateScreen sent %u bytes in %u us.\r\n", stats.lastBytes, stats.lastUs);
+    osDelay(1000); // 显示启动画面时间延长
+
+    // 循环显示电池充电动画
+    for (int i = 0; i <= 4; i++) {
+        ssd1306_Fill(Black);
+        ssd1306_DrawRectangle(0, 0, 127, 63, White);
+        ssd1306_SetCursor(10, 25);
+        ssd1306_DrawString("INITIALIZING...", Font_7x10, White);
+        DrawBatteryIcon(i);
+        ssd1306_UpdateScreen();
+        osDelay(200);
+    }
+    
+    osDelay(300);
+
+    // 启动画面结束后本任务按状态变化刷新状态界面
+    oled_layout();
+    oled_loop();
+}
+
+void Ssd1306TestDemo(void)
+{
+    osThreadAttr_t attr;
+
+    attr.name = "Ssd1306TestTask";
+    attr.attr_bits = 0U;
+    attr.cb_mem = NULL;
+    attr.cb_size = 0U;
+    attr.stack_mem = NULL;
+    attr.stack_size = 4096;
+    attr.priority = OLED_TASK_PRIORITY;
+
+    if (osThreadNew(Ssd1306TestTask, NULL, &attr) == NULL) {
+        printf("[Ssd1306TestDemo] Failed to create Ssd1306TestTask!\n");
+    }
+}
+APP_FEATURE_INIT(Ssd1306TestDemo);
@@ -1,158 +1,409 @@
-#include "ohos_init.h"
-#include "cmsis_os2.h"
-#include "iot_gpio.h"
-#include "hi_io.h"
-#include "hi_time.h"
-#include "iot_watchdog.h"
-#include "robot_control.h"
-#include "iot_errno.h"
-#include "hi_pwm.h"
-#include "hi_timer.h"
-#include "iot_pwm.h"
-
-#include "robot_l9110s.h"
-
-//左右两轮电机各由一个L9110S驱动
-//GPOI0和GPIO1控制左轮,GPIO9和GPIO10控制右轮。通过输入GPIO的电平高低控制车轮正转/反转/停止/刹车。
-#define GPIO0 0
-#define GPIO1 1
-#define GPIO9 9
-#define GPIO10 10
-
-//查阅机器人板原理图可知
-//左边的红外传感器通过GPIO11与3861芯片连接
-//右边的红外传感器通过GPIO12与3861芯片连接
-#define GPIO11 11
-#define GPIO12 12
-
-#define GPIO_FUNC 0
-#define car_speed_left 0
-#define car_speed_right 0
-
-#define DISTANCE_BETWEEN_CAR_AND_OBSTACLE 20.0f
-
-extern unsigned char g_car_status;   
-unsigned int g_car_speed_left = car_speed_left;
-unsigned int g_car_speed_right = car_speed_right;
-IotGpioValue io_status_left;
-IotGpioValue io_status_right;
-
-// 全局变量，保存红外传感器状态（volatile保证多线程/中断下数据一致性）
-volatile IotGpioValue g_trace_left = IOT_GPIO_VALUE1;
-volatile IotGpioValue g_trace_right = IOT_GPIO_VALUE1;
-
-extern float GetDistance(void);
-
-unsigned int MOVING_STATUS = 0;
-
-static int g_obstacle_detected = 0;  // 障碍物检测标志
-static int g_obstacle_check_counter = 0;  // 避障检测计数器
-
-// 黑线持续检测时间阈值（单位：ms），可根据需要调整
-unsigned int black_line_detect_time_ms = 15; 
-unsigned int black_line_counter = 0; // 黑线检测计数器
-volatile int g_black_line_stop = 0; // 黑线停车标志
-
-//获取红外传感器的值，调整电机的状态
-void timer1_callback(unsigned int arg)
-{
-    // 使用计数器,使得每50ms检测一次障碍物
-    g_obstacle_check_counter++;
-    if (g_obstacle_check_counter >= 50) {
-        g_obstacle_check_counter = 0;
-        
-        // 获取前方距离
-        float distance = GetDistance();
-        
-        // 检查是否有障碍物
-        if (distance < DISTANCE_BETWEEN_CAR_AND_OBSTACLE) {
-            if (!g_obstacle_detected) {
-                printf("Obstacle detected! Distance: %.2f cm\n", distance);
-                g_obstacle_detected = 1;
-                // 立即停止小车
-                car_stop();
-                MOVING_STATUS = 4;  // 障碍物状态码
-            }
-        } else {
-            if (g_obstacle_detected) {
-                printf("Obstacle cleared! Distance: %.2f cm, resuming trace\n", distance);
-                g_obstacle_detected = 0;
-            }
-        }
-    }
-    
-    // 如果检测到障碍物，直接返回，不执行循迹逻辑
-    if (g_obstacle_detected) {
-        return;
-    }
-
-    // 正常的循迹逻辑：采集红外传感器状态
-    IoTGpioGetInputVal(GPIO11, (IotGpioValue*)&g_trace_left);
-    IoTGpioGetInputVal(GPIO12, (IotGpioValue*)&g_trace_right);
-
-    // 黑线持续检测逻辑
-    if (g_trace_left == IOT_GPIO_VALUE0 && g_trace_right == IOT_GPIO_VALUE0) {
-        black_line_counter++;
-        if (black_line_counter >= black_line_detect_time_ms) {
-            g_black_line_stop = 1;
-        }
-    } else {
-        black_line_counter = 0;
-        g_black_line_stop = 0;
-    }
-}
-
-void trace_module(void)
-{
-    unsigned int timer_id1;
-    pwm_init();
-
-    car_stop();
-
-    // 初始化避障检测变量
-    g_obstacle_detected = 0;
-    g_obstacle_check_counter = 0;
-    g_black_line_stop = 0;
-    black_line_counter = 0;
-
-    hi_timer_create(&timer_id1);
-    // 启动系统周期定时器用来按照预定的时间间隔1ms触发timer1_callback任务的执行
-    hi_timer_start(timer_id1, HI_TIMER_TYPE_PERIOD, 1, timer1_callback, 0);
-
-    while (1) {
-        // 只有在没有检测到障碍物时才执行循迹逻辑
-        if (!g_obstacle_detected) {
-            if (g_black_line_stop) {
-                car_stop();
-                MOVING_STATUS = 0;
-                printf("[trace] Brake: black line detected for %d ms\n", black_line_detect_time_ms);
-            } else {
-                // 只保留左转/右转/直行逻辑，不再遇到黑线就立即停车
-                if (g_trace_right == IOT_GPIO_VALUE0 && g_trace_left != IOT_GPIO_VALUE0) {
-                    car_right();
-                    MOVING_STATUS = 1;
-                    printf("[trace] Turn right\n");
-                } else if (g_trace_left == IOT_GPIO_VALUE0 && g_trace_right != IOT_GPIO_VALUE0) {
-                    car_left();
-                    MOVING_STATUS = 2;
-                    printf("[trace] Turn left\n");
-                } else if(g_trace_left == IOT_GPIO_VALUE1 && g_trace_right == IOT_GPIO_VALUE1){
-                    car_forward();
-                    MOVING_STATUS = 3;
-                    printf("[trace] Forward\n");
-                }else if(g_trace_left == IOT_GPIO_VALUE0 && g_trace_right == IOT_GPIO_VALUE0){
-                    car_forward();
-                    MOVING_STATUS = 3;
-                    printf("[trace] Forward\n");
-                }
-            }
-        }
-        hi_udelay(20);
-        if (g_car_status != CAR_TRACE_STATUS) {
-            break;
-        }
-    }
-    // 退出trace模式，关闭PWM
-    pwm_stop();
-    hi_timer_delete(timer_id1);
+#include <stdio.h>
+#include <string.h>
+
+#include "ohos_init.h"
+#include "cmsis_os2.h"
+#include "iot_gpio.h"
+#include "hi_io.h"
+#include "hi_time.h"
+#include "iot_watchdog.h"
+#include "robot_control.h"
+#include "iot_errno.h"
+#include "hi_pwm.h"
+#include "iot_pwm.h"
+
+#include "robot_ir.h"
+#include "robot_lap.h"
+#include "robot_l9110s.h"
+#include "robot_line.h"
+#include "robot_sched.h"
+#include "robot_ttc.h"
+
+//左右两轮电机各由一个L9110S驱动
+//GPOI0和GPIO1控制左轮,GPIO9和GPIO10控制右轮。通过输入GPIO的电平高低控制车轮正转/反转/停止/刹车。
+#define GPIO0 0
+#define GPIO1 1
+#define GPIO9 9
+#define GPIO10 10
+
+//查阅机器人板原理图可知
+//左边的红外传感器通过GPIO11与3861芯片连接
+//右边的红外传感器通过GPIO12与3861芯片连接
+#define GPIO11 11
+#define GPIO12 12
+
+#define GPIO_FUNC 0
+#define car_speed_left 0
+#define car_speed_right 0
+
+extern unsigned char g_car_status;   
+unsigned int g_car_speed_left = car_speed_left;
+unsigned int g_car_speed_right = car_speed_right;
+IotGpioValue io_status_left;
+IotGpioValue io_status_right;
+
+// 全局变量，保存滤波后的红外传感器状态（volatile保证多线程/中断下数据一致性）
+volatile IotGpioValue g_trace_left = IOT_GPIO_VALUE1;
+volatile IotGpioValue g_trace_right = IOT_GPIO_VALUE1;
+static IrChannel g_ir_left;
+static IrChannel g_ir_right;
+
+extern float GetDistance(void);
+
+unsigned int MOVING_STATUS = 0;
+
+static volatile int g_obstacle_detected = 0;  // 障碍物检测标志，由测距任务写入
+
+// 黑线持续检测时间阈值（单位：ms），可根据需要调整
+unsigned int black_line_detect_time_ms = 15; 
+unsigned int black_line_counter = 0; // 黑线检测计数器
+volatile int g_black_line_stop = 0; // 黑线停车标志
+
+// 采样状态元组：左右红外电平、黑线停车、障碍物，任一位变化时才通知寻迹任务
+#define TRACE_STATE_LEFT        (1 << 0)    // 左侧红外为高电平(未压线)
+#define TRACE_STATE_RIGHT       (1 << 1)    // 右侧红外为高电平(未压线)
+#define TRACE_STATE_BLACK_STOP  (1 << 2)
+#define TRACE_STATE_OBSTACLE    (1 << 3)
+#define TRACE_STATE_INVALID     (0xFF)      // 强制下一次采样发出事件
+
+#define TRACE_EVENT_CHANGE      (1 << 0)
+#define TRACE_WAIT_TICKS        (5)         // 没有事件时每50ms检查一次模式切换
+#define TRACE_TURN_DIFF         (1000)      // PD寻迹时左右轮占空比差超过该值视为转弯
+
+// 调度作业参数：红外采样在节拍中执行；测距会忙等回响最长数十ms，交给工作任务
+#define TRACE_IR_BUDGET_US          (100)
+#define TRACE_RANGE_PERIOD_MS       (50)    // 每50ms测距一次
+#define TRACE_RANGE_BUDGET_US       (30000) // 回响超时时间
+#define TRACE_RANGE_PRIORITY        (20)
+
+// 红外采样作业的实际执行间隔直方图，每格250us，最后一格收集所有>=2ms的间隔
+#define TRACE_JITTER_BIN_US     (250)
+#define TRACE_JITTER_BINS       (9)
+
+static osEventFlagsId_t g_trace_event = NULL;
+static volatile unsigned char g_trace_state = TRACE_STATE_INVALID;   // 最近一次通知的状态
+static volatile unsigned int g_trace_state_ms = 0;                   // 状态跳变时刻，用于估计黑线偏移
+static unsigned char g_trace_prev_state = TRACE_STATE_INVALID;       // 寻迹任务上次处理的状态
+static int g_trace_bar_action = LAP_MARK_STOP;                       // 压上横线时的处理，见lap_mark()
+
+static int g_trace_ir_job = -1;
+static int g_trace_range_job = -1;
+
+static unsigned int g_trace_jitter[TRACE_JITTER_BINS];
+static unsigned int g_trace_jitter_max_us = 0;
+static unsigned long long g_trace_last_us = 0;     // 上次采样时刻，0表示尚未采样
+
+// 记录与上次采样的实际间隔
+static void trace_jitter_record(void)
+{
+    unsigned long long now = hi_get_us();
+
+    if (g_trace_last_us != 0) {
+        unsigned int interval = (unsigned int)(now - g_trace_last_us);
+        unsigned int bin = interval / TRACE_JITTER_BIN_US;
+        g_trace_jitter[(bin < TRACE_JITTER_BINS) ? bin : TRACE_JITTER_BINS - 1]++;
+        if (interval > g_trace_jitter_max_us) {
+            g_trace_jitter_max_us = interval;
+        }
+    }
+    g_trace_last_us = now;
+}
+
+static void trace_jitter_reset(void)
+{
+    memset(g_trace_jitter, 0, sizeof(g_trace_jitter));
+    g_trace_jitter_max_us = 0;
+    g_trace_last_us = 0;
+}
+
+static void trace_jitter_report(void)
+{
+    char buf[192];
+    int len = 0;
+
+    for (unsigned int i = 0; i < TRACE_JITTER_BINS - 1 && len < (int)sizeof(buf); i++) {
+        len += snprintf(buf + len, sizeof(buf) - len, " %u-%u:%u", i * TRACE_JITTER_BIN_US,
+                        (i + 1) * TRACE_JITTER_BIN_US - 1, g_trace_jitter[i]);
+    }
+    printf("[trace] sample interval (us):%s >=%u:%u, max %u\n", buf,
+           (TRACE_JITTER_BINS - 1) * TRACE_JITTER_BIN_US, g_trace_jitter[TRACE_JITTER_BINS - 1],
+           g_trace_jitter_max_us);
+}
+
+static unsigned char trace_state_pack(void)
+{
+    unsigned char state = 0;
+
+    if (g_trace_left != IOT_GPIO_VALUE0) {
+        state |= TRACE_STATE_LEFT;
+    }
+    if (g_trace_right != IOT_GPIO_VALUE0) {
+        state |= TRACE_STATE_RIGHT;
+    }
+    if (g_black_line_stop) {
+        state |= TRACE_STATE_BLACK_STOP;
+    }
+    if (g_obstacle_detected) {
+        state |= TRACE_STATE_OBSTACLE;
+    }
+    return state;
+}
+
+// 状态与上次通知的不同时才发事件，寻迹任务只在状态跳变时被唤醒
+// stamp_ms为跳变时刻，红外跳变时取滤波回推的边沿时刻
+static void trace_post_if_changed(unsigned int stamp_ms)
+{
+    unsigned char state = trace_state_pack();
+
+    if (state != g_trace_state) {
+        g_trace_state_ms = stamp_ms;
+        g_trace_state = state;
+        osEventFlagsSet(g_trace_event, TRACE_EVENT_CHANGE);
+    }
+}
+
+// 测一次前方距离，按碰撞时间检查是否需要刹车，恢复时要求距离拉开到安全距离以上
+// 只置障碍物标志，由红外采样作业通知寻迹任务停车
+static void trace_range_once(void)
+{
+    float distance = GetDistance();
+    unsigned int now = hi_get_milli_seconds();
+    ttc_update(distance, now, TTC_SAMPLE_TIMEOUT_MS);
+
+    if (ttc_should_brake(SPEED_FORWARD, now)) {
+        if (!g_obstacle_detected) {
+            printf("Obstacle detected! Distance: %.2f cm\n", distance);
+            g_obstacle_detected = 1;
+        }
+    } else if (distance >= DISTANCE_BETWEEN_CAR_AND_OBSTACLE) {
+        if (g_obstacle_detected) {
+            printf("Obstacle cleared! Distance: %.2f cm, resuming trace\n", distance);
+            g_obstacle_detected = 0;
+        }
+    }
+}
+
+//获取红外传感器的值，统计黑线时间，状态变化时通知寻迹任务
+//在调度节拍中执行，不做测距和打印，保证1ms采样周期
+static void trace_sample(void)
+{
+    unsigned int now = hi_get_milli_seconds();
+    unsigned int stamp = now;
+    IotGpioValue left = IOT_GPIO_VALUE1;
+    IotGpioValue right = IOT_GPIO_VALUE1;
+
+    trace_jitter_record();
+
+    // 如果检测到障碍物，不执行循迹逻辑
+    if (g_obstacle_detected) {
+        trace_post_if_changed(now);
+        return;
+    }
+
+    // 正常的循迹逻辑：采集红外传感器状态，经位历史滤波后使用
+    IoTGpioGetInputVal(GPIO11, &left);
+    IoTGpioGetInputVal(GPIO12, &right);
+    if (ir_channel_update(&g_ir_left, left == IOT_GPIO_VALUE0, now)) {
+        stamp = g_ir_left.edge_ms;
+    }
+    if (ir_channel_update(&g_ir_right, right == IOT_GPIO_VALUE0, now)) {
+        stamp = g_ir_right.edge_ms;
+    }
+    g_trace_left = g_ir_left.black ? IOT_GPIO_VALUE0 : IOT_GPIO_VALUE1;
+    g_trace_right = g_ir_right.black ? IOT_GPIO_VALUE0 : IOT_GPIO_VALUE1;
+
+    // 黑线持续检测逻辑
+    if (g_trace_left == IOT_GPIO_VALUE0 && g_trace_right == IOT_GPIO_VALUE0) {
+        black_line_counter++;
+        if (black_line_counter >= black_line_detect_time_ms) {
+            g_black_line_stop = 1;
+        }
+    } else {
+        black_line_counter = 0;
+        g_black_line_stop = 0;
+    }
+    trace_post_if_changed(stamp);
+}
+
+static const SchedJobConfig g_trace_ir_config = {
+    "ir", trace_sample, 1, 0, 0, SCHED_CTX_TICK, TRACE_IR_BUDGET_US
+};
+static const SchedJobConfig g_trace_range_config = {
+    "range", trace_range_once, TRACE_RANGE_PERIOD_MS, 0, TRACE_RANGE_PRIORITY, SCHED_CTX_TASK, TRACE_RANGE_BUDGET_US
+};
+
+#if TRACE_USE_PD
+// PD寻迹：按估计的黑线偏移输出差速，每个控制周期调用一次
+// 前进占空比取已学习赛道的速度曲线，同时累计本圈里程
+static void trace_steer(unsigned int now)
+{
+    int left_duty;
+    int right_duty;
+
+    line_control(now, lap_speed(SPEED_FORWARD), &left_duty, &right_duty);
+    car_drive(left_duty, right_duty);
+    lap_odometry(now, left_duty, right_duty);
+    if (right_duty - left_duty > TRACE_TURN_DIFF) {
+        car_set_moving(2);
+    } else if (left_duty - right_duty > TRACE_TURN_DIFF) {
+        car_set_moving(1);
+    } else {
+        car_set_moving(3);
+    }
+}
+#endif
+
+/**
+ * @brief 按采样状态执行一次动作
+ * @param state 采样状态元组
+ * @param changed 状态刚发生跳变，只在跳变时打印日志；三态控制只在跳变时调用
+ */
+static void trace_actuate(unsigned char state, int changed)
+{
+    unsigned char prev = g_trace_prev_state;
+    int left_black = !(state & TRACE_STATE_LEFT);
+    int right_black = !(state & TRACE_STATE_RIGHT);
+    unsigned int now = hi_get_milli_seconds();
+
+    if (changed) {
+        g_trace_prev_state = state;
+    }
+
+    if (g_trace_bar_action == LAP_MARK_FINISH) {
+        car_stop();     // 跑完设定圈数，滑过横线后也不再寻迹
+        car_set_moving(0);
+        return;
+    }
+    if (state & TRACE_STATE_OBSTACLE) {
+        car_stop();
+        car_set_moving(4);  // 障碍物状态码
+        line_reset();       // 恢复后重新估计
+        return;
+    }
+    if (state & TRACE_STATE_BLACK_STOP) {
+        // 刚压上横线时结算一圈，未跑完设定圈数时直行通过
+        int was_on_bar = (prev != TRACE_STATE_INVALID) && (prev & TRACE_STATE_BLACK_STOP);
+        if (changed && !was_on_bar) {
+            g_trace_bar_action = lap_mark(now);
+        }
+        if (g_trace_bar_action == LAP_MARK_CONTINUE) {
+            car_forward();
+            car_set_moving(3);
+            lap_odometry(now, SPEED_FORWARD, SPEED_FORWARD);
+            return;
+        }
+        car_stop();
+        car_set_moving(0);
+        line_reset();
+        if (changed) {
+            printf("[trace] Brake: black line detected for %d ms\n", black_line_detect_time_ms);
+        }
+        return;
+    }
+#if TRACE_USE_PD
+    if (changed) {
+        line_observe(left_black, right_black, g_trace_state_ms);
+    }
+    trace_steer(now);
+#else
+    if (right_black && !left_black) {
+        car_right();
+        car_set_moving(1);
+        printf("[trace] Turn right\n");
+    } else if (left_black && !right_black) {
+        car_left();
+        car_set_moving(2);
+        printf("[trace] Turn left\n");
+    } else {
+        // 两侧都未压线或都压线(尚未达到停车时间)时直行
+        car_forward();
+        car_set_moving(3);
+        printf("[trace] Forward\n");
+    }
+#endif
+}
+
+/**
+ * @brief 寻迹模式主循环
+ * @note 调度器每1ms采样红外，每50ms测距更新障碍物标志，状态元组变化时发事件；
+ *       本任务阻塞等待事件，三态控制只在状态跳变时动作一次，其余时间让出CPU；
+ *       PD控制在状态跳变时立即更新差速，两次跳变之间每TRACE_CONTROL_TICKS按外推的偏移更新一次
+ *       退出时打印本任务的CPU占用率、事件数和唤醒次数
+ */
+void trace_module(void)
+{
+    unsigned int start_ms;
+    unsigned long long busy_us = 0;
+    unsigned int events = 0;
+    unsigned int wakeups = 0;
+
+    if (g_trace_event == NULL) {
+        g_trace_event = osEventFlagsNew(NULL);
+        if (g_trace_event == NULL) {
+            printf("[trace] Failed to create event!\n");
+            return;
+        }
+    }
+    if (g_trace_ir_job < 0) {
+        g_trace_ir_job = sched_add(&g_trace_ir_config);
+    }
+    if (g_trace_range_job < 0) {
+        g_trace_range_job = sched_add(&g_trace_range_config);
+    }
+    if (g_trace_ir_job < 0 || g_trace_range_job < 0) {
+        printf("[trace] Failed to add sched jobs!\n");
+        return;
+    }
+    osEventFlagsClear(g_trace_event, TRACE_EVENT_CHANGE);
+    g_trace_state = TRACE_STATE_INVALID;
+    g_trace_prev_state = TRACE_STATE_INVALID;
+    g_trace_bar_action = LAP_MARK_STOP;
+    line_reset();
+    lap_begin(hi_get_milli_seconds());
+    pwm_init();
+
+    car_stop();
+
+    // 初始化避障检测变量
+    g_obstacle_detected = 0;
+    g_black_line_stop = 0;
+    ttc_reset();
+    black_line_counter = 0;
+
+    ir_channel_reset(&g_ir_left, 0, hi_get_milli_seconds());
+    ir_channel_reset(&g_ir_right, 0, hi_get_milli_seconds());
+    trace_jitter_reset();
+    // 红外采样和测距都交给调度器按节拍执行
+    sched_enable(g_trace_ir_job, 1);
+    sched_enable(g_trace_range_job, 1);
+    start_ms = hi_get_milli_seconds();
+
+    while (1) {
+        unsigned int flags = osEventFlagsWait(g_trace_event, TRACE_EVENT_CHANGE, osFlagsWaitAny,
+                                              TRACE_USE_PD ? TRACE_CONTROL_TICKS : TRACE_WAIT_TICKS);
+        if (g_car_status != CAR_TRACE_STATUS) {
+            break;
+        }
+        int changed = !(flags & osFlagsError);
+        if (!changed && !TRACE_USE_PD) {
+            continue;   // 超时，状态没有变化
+        }
+
+        unsigned long long begin = hi_get_us();
+        trace_actuate(g_trace_state, changed);
+        busy_us += hi_get_us() - begin;
+        events += changed;
+        wakeups++;
+    }
+    // 退出trace模式，关闭PWM
+    pwm_stop();
+    sched_enable(g_trace_ir_job, 0);
+    sched_enable(g_trace_range_job, 0);
+
+    unsigned int elapsed_ms = hi_get_milli_seconds() - start_ms;
+    if (elapsed_ms > 0) {
+        printf("[trace] cpu %.2f%%, %u events, %u wakeups in %u ms\n",
+               busy_us * 100.0 / (elapsed_ms * 1000.0), events, wakeups, elapsed_ms);
+    }
+    trace_jitter_report();
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 // 鸿蒙系统相关头文件
 #include "ohos_init.h"
 #include "cmsis_os2.h"
+#include "hi_time.h"
 
 // JSON解析库
 #include "cJSON.h"
@@ -30,15 +31,32 @@
 // 小车控制相关头文件
 #include "udp_control.h"
 #include "robot_control.h"
+#include "robot_ir.h"
+#include "robot_lap.h"
 #include "robot_l9110s.h"
+#include "robot_scan.h"
+#include "robot_sched.h"
+#include "robot_sg90.h"
+#include "ssd1306.h"
 
 // 外部变量声明
 extern unsigned int MOVING_STATUS;      // 小车运动状态
 extern unsigned char g_car_status;      // 小车工作模式状态
+extern void oled_report(void);          // 状态界面刷新统计
+
+// 两次处理指令之间的最小间隔(ms)：UDP任务优先级最高，连续收到数据包时让出CPU，避免饿死模式和调度任务
+#define UDP_MIN_INTERVAL_MS     (10)
 
 // UDP接收缓冲区
 char recvline[1024];
 
+// 最近一次发来指令的客户端，udp_report()向它回发消息
+// 地址由UDP任务写、遥测作业读，结构体不能原子复制，读写都在g_udp_client_mutex内
+static int g_udp_sockfd = -1;
+static struct sockaddr_in g_udp_client;
+static int g_udp_client_valid = 0;
+static osMutexId_t g_udp_client_mutex = NULL;
+
 // 状态优化变量，避免重复执行相同指令（预留功能）
 static int last_moving_status = -1;     // 上次运动状态
 static unsigned long last_command_time = 0;  // 上次指令时间戳
@@ -71,25 +89,25 @@ void cotrl_handle(char *recvline, int ret)
             if(strcmp("stop", modeItem->valuestring) == 0)
             {
                 printf("stop mode\r\n");
-                g_car_status = CAR_STOP_STATUS;  // 切换到停止模式
+                car_set_status(CAR_STOP_STATUS);  // 切换到停止模式
             }
 
             if(strcmp("obstacle_avoidance", modeItem->valuestring) == 0)
             {
                 printf("obstacle avoidance mode\r\n");
-                g_car_status = CAR_OBSTACLE_AVOIDANCE_STATUS;  // 切换到避障模式
+                car_set_status(CAR_OBSTACLE_AVOIDANCE_STATUS);  // 切换到避障模式
             }
 
             if(strcmp("trace", modeItem->valuestring) == 0)
             {
                 printf("trace mode\r\n");
-                g_car_status = CAR_TRACE_STATUS;  // 切换到寻迹模式
+                car_set_status(CAR_TRACE_STATUS);  // 切换到寻迹模式
             }
 
             if(strcmp("control", modeItem->valuestring) == 0)
             {
                 printf("remote control mode\r\n");
-                g_car_status = CAR_CONTROL_STATUS;  // 切换到远程控制模式
+                car_set_status(CAR_CONTROL_STATUS);  // 切换到远程控制模式
                 // 如果同时有cmd，直接处理控制指令
                 if(cmdItem != NULL && cmdItem->valuestring != NULL)
                 {
@@ -112,6 +130,120 @@ void cotrl_handle(char *recvline, int ret)
     }
 }
 
+/**
+ * @brief 舵机与扫描配置指令处理函数
+ * @param recvjson 已解析的JSON控制指令
+ * @param cmd 指令名称
+ * @return 1-已处理，0-不是配置指令
+ * @note 配置指令在任何模式下都生效：
+ *       - "servo_cal": 写入舵机标定表，value为-90、-45、0、+45、+90度对应的5个脉宽(微秒)
+ *       - "scan": 设置扫描范围和分区数，需要min、max、bins字段
+ *       - "cruise": 设置避障减速带和停车带，需要slow、stop字段
+ *       - "irfilter": 设置红外滤波窗口和判定阈值，需要window、on、off字段
+ *       - "lap": 设置寻迹连续跑的圈数，需要laps字段，0表示遇到横线即停车
+ *       - "lap_reset": 清除已学习的赛道
+ *       - "sched": 在串口打印调度器各作业的执行时间表
+ *       - "oled": 在串口打印OLED刷新次数、丢帧数、每帧发送字节数、传输耗时和帧延迟，
+ *                 以及上次查询以来状态界面的唤醒次数、帧数、绘制CPU占用和I2C占用率
+ */
+static int udp_config(cJSON *recvjson, const char *cmd)
+{
+    if(strcmp("servo_cal", cmd) == 0)
+    {
+        cJSON *valueItem = cJSON_GetObjectItem(recvjson, "value");
+        unsigned short table[SERVO_CAL_POINTS];
+        if (valueItem == NULL || !cJSON_IsArray(valueItem) ||
+            cJSON_GetArraySize(valueItem) != SERVO_CAL_POINTS) {
+            printf("servo_cal needs %d pulse widths\r\n", SERVO_CAL_POINTS);
+            return 1;
+        }
+        for (int i = 0; i < SERVO_CAL_POINTS; i++) {
+            table[i] = (unsigned short)cJSON_GetArrayItem(valueItem, i)->valueint;
+        }
+        if (servo_set_calibration(table) == 0) {
+            printf("servo calibration: %u %u %u %u %u\r\n",
+                   table[0], table[1], table[2], table[3], table[4]);
+        } else {
+            printf("servo calibration rejected\r\n");
+        }
+        return 1;
+    }
+    if(strcmp("scan", cmd) == 0)
+    {
+        cJSON *minItem = cJSON_GetObjectItem(recvjson, "min");
+        cJSON *maxItem = cJSON_GetObjectItem(recvjson, "max");
+        cJSON *binsItem = cJSON_GetObjectItem(recvjson, "bins");
+        if (minItem == NULL || maxItem == NULL || binsItem == NULL ||
+            scan_config(minItem->valueint, maxItem->valueint, (unsigned int)binsItem->valueint) != 0) {
+            printf("scan config rejected\r\n");
+        } else {
+            printf("scan %d..%d, %d bins\r\n", minItem->valueint, maxItem->valueint, binsItem->valueint);
+        }
+        return 1;
+    }
+    if(strcmp("cruise", cmd) == 0)
+    {
+        cJSON *slowItem = cJSON_GetObjectItem(recvjson, "slow");
+        cJSON *stopItem = cJSON_GetObjectItem(recvjson, "stop");
+        if (slowItem == NULL || stopItem == NULL || slowItem->valueint <= 0 || stopItem->valueint <= 0 ||
+            car_set_cruise_band((unsigned int)slowItem->valueint, (unsigned int)stopItem->valueint) != 0) {
+            printf("cruise band rejected\r\n");
+        } else {
+            printf("cruise slow %d cm, stop %d cm\r\n", slowItem->valueint, stopItem->valueint);
+        }
+        return 1;
+    }
+    if(strcmp("irfilter", cmd) == 0)
+    {
+        cJSON *windowItem = cJSON_GetObjectItem(recvjson, "window");
+        cJSON *onItem = cJSON_GetObjectItem(recvjson, "on");
+        cJSON *offItem = cJSON_GetObjectItem(recvjson, "off");
+        if (windowItem == NULL || onItem == NULL || offItem == NULL ||
+            windowItem->valueint <= 0 || onItem->valueint <= 0 || offItem->valueint < 0 ||
+            ir_filter_config((unsigned int)windowItem->valueint, (unsigned int)onItem->valueint,
+                             (unsigned int)offItem->valueint) != 0) {
+            printf("ir filter rejected\r\n");
+        } else {
+            printf("ir filter window %d, on %d, off %d\r\n",
+                   windowItem->valueint, onItem->valueint, offItem->valueint);
+        }
+        return 1;
+    }
+    if(strcmp("lap", cmd) == 0)
+    {
+        cJSON *lapsItem = cJSON_GetObjectItem(recvjson, "laps");
+        if (lapsItem == NULL || lapsItem->valueint < 0 || lap_set_target((unsigned int)lapsItem->valueint) != 0) {
+            printf("lap target rejected\r\n");
+        } else {
+            printf("lap target %d\r\n", lapsItem->valueint);
+        }
+        return 1;
+    }
+    if(strcmp("lap_reset", cmd) == 0)
+    {
+        lap_forget();
+        printf("lap track cleared\r\n");
+        return 1;
+    }
+    if(strcmp("sched", cmd) == 0)
+    {
+        sched_report();
+        return 1;
+    }
+    if(strcmp("oled", cmd) == 0)
+    {
+        SSD1306_Stats_t stats;
+        ssd1306_GetStats(&stats);
+        printf("oled %u presented, %u dropped, %u sent, %u transfers, last %u bytes %u us, max %u us, avg %u bytes\r\n",
+               stats.presented, stats.dropped, stats.updates, stats.transfers, stats.lastBytes, stats.lastUs,
+               stats.maxUs, (stats.updates > 0) ? stats.totalBytes / stats.updates : 0);
+        printf("oled frame time last %u us, max %u us\r\n", stats.lastFrameUs, stats.maxFrameUs);
+        oled_report();
+        return 1;
+    }
+    return 0;
+}
+
 /**
  * @brief UDP运动控制处理函数
  * @param recvline 接收到的JSON控制指令
@@ -122,7 +254,7 @@ void cotrl_handle(char *recvline, int ret)
  *       - "right": 右转
  *       - "stop": 停止
  *       - "speed": 设置速度 (需要配合value字段)
- *       只有在远程控制模式下才会响应控制指令
+ *       只有在远程控制模式下才会响应控制指令，配置指令见udp_config()
  */
 void udp_control(char *recvline){
     cJSON *recvjson;
@@ -137,6 +269,10 @@ void udp_control(char *recvline){
         if(cmdItem != NULL && cmdItem->valuestring != NULL)
         {
             printf("cmd : %s\r\n", cmdItem->valuestring);
+            if (udp_config(recvjson, cmdItem->valuestring)) {
+                cJSON_Delete(recvjson);
+                return;
+            }
             // 确保在远控模式下才响应控制指令
             if (g_car_status != CAR_CONTROL_STATUS) {
                 printf("Not in remote control mode, ignore control commands\r\n");
@@ -148,31 +284,31 @@ void udp_control(char *recvline){
             if(strcmp("forward", cmdItem->valuestring) == 0)
             {
                 car_forward();      // 小车前进
-                MOVING_STATUS = 3;
+                car_set_moving(3);
                 printf("forward\r\n");
             }
             else if(strcmp("backward", cmdItem->valuestring) == 0)
             {
                 car_backward();     // 小车后退
-                MOVING_STATUS = 5;
+                car_set_moving(5);
                 printf("backward\r\n");
             }
             else if(strcmp("left", cmdItem->valuestring) == 0)
             {
                 car_left();         // 小车左转
-                MOVING_STATUS = 2;
+                car_set_moving(2);
                 printf("left\r\n");
             }
             else if(strcmp("right", cmdItem->valuestring) == 0)
             {
                 car_right();        // 小车右转
-                MOVING_STATUS = 1;
+                car_set_moving(1);
                 printf("right\r\n");
             }
             else if(strcmp("stop", cmdItem->valuestring) == 0)
             {
                 car_stop();         // 小车停止
-                MOVING_STATUS = 0;
+                car_set_moving(0);
                 printf("stop\r\n");
             }
             // 新增：处理速度调节指令
@@ -181,7 +317,7 @@ void udp_control(char *recvline){
                 cJSON *valueItem = cJSON_GetObjectItem(recvjson, "value");
                 if (valueItem && cJSON_IsNumber(valueItem)) {
                     extern unsigned short SPEED_FORWARD;
-                    SPEED_FORWARD = (unsigned short)valueItem->valueint;
+                    car_set_speed((unsigned short)valueItem->valueint);
                     printf("Set SPEED_FORWARD to %d\r\n", SPEED_FORWARD);
                 } else {
                     printf("speed command missing or invalid value\r\n");
@@ -273,6 +409,12 @@ void udp_thread(void *pdata)
     }
     
     printf("UDP server successfully bound and listening on port 50001\r\n");
+    g_udp_client_mutex = osMutexNew(NULL);
+    if (g_udp_client_mutex == NULL) {
+        printf("Failed to create UDP client mutex, telemetry disabled\r\n");
+    }
+    g_udp_sockfd = sockfd;
+    unsigned int last_handled = hi_get_milli_seconds() - UDP_MIN_INTERVAL_MS;
     
     while(1)
     {
@@ -286,6 +428,13 @@ void udp_thread(void *pdata)
         ret = recvfrom(sockfd, recvline, 1024, 0, (struct sockaddr*)&addrClient,(socklen_t*)&sizeClientAddr);
         // printf("recvfrom returned: %d\r\n", ret);
 
+        // recvfrom阻塞等待数据包，不是轮询；只有数据包来得比最小间隔还密时才补足间隔
+        unsigned int since = hi_get_milli_seconds() - last_handled;
+        if (since < UDP_MIN_INTERVAL_MS) {
+            hi_sleep(UDP_MIN_INTERVAL_MS - since);
+        }
+        last_handled = hi_get_milli_seconds();
+
         if(ret > 0)
         {
             char *pClientIP = inet_ntoa(addrClient.sin_addr);
@@ -293,6 +442,13 @@ void udp_thread(void *pdata)
             printf("Received from %s-%d: %s (length: %d)\r\n", 
                    pClientIP, ntohs(addrClient.sin_port), recvline, ret);
 
+            if (g_udp_client_mutex != NULL) {
+                osMutexAcquire(g_udp_client_mutex, osWaitForever);
+                g_udp_client = addrClient;
+                g_udp_client_valid = 1;
+                osMutexRelease(g_udp_client_mutex);
+            }
+
             cotrl_handle(recvline, ret); 
         }
         else if(ret == 0)
@@ -303,12 +459,30 @@ void udp_thread(void *pdata)
         {
             printf("recvfrom error: %d\r\n", ret);
         }
-        
-        // 添加适当的延时，避免过于频繁的轮询
-        osDelay(10);
     }
 }
 
+int udp_report(const char *text)
+{
+    struct sockaddr_in client;
+    int valid;
+
+    if (g_udp_sockfd < 0 || g_udp_client_mutex == NULL || text == NULL) {
+        return -1;
+    }
+    osMutexAcquire(g_udp_client_mutex, osWaitForever);
+    client = g_udp_client;
+    valid = g_udp_client_valid;
+    osMutexRelease(g_udp_client_mutex);
+    if (!valid) {
+        return -1;
+    }
+    if (sendto(g_udp_sockfd, text, strlen(text), 0, (struct sockaddr *)&client, sizeof(client)) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
 void start_udp_thread(void)
 {
     osThreadAttr_t attr;
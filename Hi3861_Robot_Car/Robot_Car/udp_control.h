@@ -1,10 +1,11 @@
-#ifndef UDP_CONTROL_H
-#define UDP_CONTROL_H
-
-// 函数声明
-void cotrl_handle(char *recvline, int ret);
-void udp_control(char *recvline);
-void udp_thread(void *pdata);
-void start_udp_thread(void);
-
+#ifndef UDP_CONTROL_H
+#define UDP_CONTROL_H
+
+// 函数声明
+void cotrl_handle(char *recvline, int ret);
+void udp_control(char *recvline);
+void udp_thread(void *pdata);
+void start_udp_thread(void);
+int udp_report(const char *text);   // 向最近一次发来指令的客户端发送消息，0-成功，-1-没有客户端或发送失败
+
 #endif
\ No newline at end of file
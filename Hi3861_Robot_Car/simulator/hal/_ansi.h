@@ -0,0 +1,13 @@
+// 仿真用SDK头文件：ssd1306.h使用的newlib宏
+#ifndef SIM_ANSI_H
+#define SIM_ANSI_H
+
+#ifdef __cplusplus
+#define _BEGIN_STD_C extern "C" {
+#define _END_STD_C }
+#else
+#define _BEGIN_STD_C
+#define _END_STD_C
+#endif
+
+#endif // SIM_ANSI_H
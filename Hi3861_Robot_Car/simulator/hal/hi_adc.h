@@ -0,0 +1,35 @@
+#ifndef SIM_HI_ADC_H
+#define SIM_HI_ADC_H
+
+#include "hi_io.h"
+
+typedef enum {
+    HI_ADC_CHANNEL_0,
+    HI_ADC_CHANNEL_1,
+    HI_ADC_CHANNEL_2,
+    HI_ADC_CHANNEL_3,
+    HI_ADC_CHANNEL_4,
+    HI_ADC_CHANNEL_5,
+    HI_ADC_CHANNEL_6,
+    HI_ADC_CHANNEL_7,
+    HI_ADC_CHANNEL_BUTT
+} hi_adc_channel_index;
+
+typedef enum {
+    HI_ADC_EQU_MODEL_1,
+    HI_ADC_EQU_MODEL_2,
+    HI_ADC_EQU_MODEL_4,
+    HI_ADC_EQU_MODEL_8
+} hi_adc_equ_model_sel;
+
+typedef enum {
+    HI_ADC_CUR_BAIS_DEFAULT,
+    HI_ADC_CUR_BAIS_AUTO,
+    HI_ADC_CUR_BAIS_1P8V,
+    HI_ADC_CUR_BAIS_3P3V
+} hi_adc_cur_bais;
+
+hi_u32 hi_adc_read(hi_adc_channel_index channel, hi_u16 *data, hi_adc_equ_model_sel equ_model,
+                   hi_adc_cur_bais cur_bais, hi_u16 delay_cnt);
+
+#endif // SIM_HI_ADC_H
@@ -0,0 +1,13 @@
+#ifndef SIM_HI_HRTIMER_H
+#define SIM_HI_HRTIMER_H
+
+#include "hi_io.h"
+
+typedef hi_void (*hi_hrtimer_callback_f)(hi_u32 data);
+
+hi_u32 hi_hrtimer_create(hi_u32 *timer_id);
+hi_u32 hi_hrtimer_delete(hi_u32 timer_id);
+hi_u32 hi_hrtimer_start(hi_u32 timer_id, hi_u32 expire, hi_hrtimer_callback_f hrtimer_func, hi_u32 data);
+hi_u32 hi_hrtimer_stop(hi_u32 timer_id);
+
+#endif // SIM_HI_HRTIMER_H
@@ -0,0 +1,22 @@
+// 仿真用SDK头文件：只声明固件实际用到的类型和接口
+#ifndef SIM_HI_IO_H
+#define SIM_HI_IO_H
+
+typedef unsigned int hi_u32;
+typedef unsigned short hi_u16;
+typedef unsigned char hi_u8;
+typedef int hi_s32;
+typedef void hi_void;
+typedef unsigned long long hi_u64;
+
+#define hi_unref_param(p) ((void)(p))
+
+#define HI_IO_FUNC_GPIO_0_PWM3_OUT  5
+#define HI_IO_FUNC_GPIO_1_PWM4_OUT  5
+#define HI_IO_FUNC_GPIO_9_PWM0_OUT  5
+#define HI_IO_FUNC_GPIO_10_PWM1_OUT 5
+
+hi_u32 hi_io_set_func(int id, hi_u8 val);
+hi_u32 hi_io_set_pull(int id, int val);
+
+#endif // SIM_HI_IO_H
@@ -0,0 +1,20 @@
+#ifndef SIM_HI_PWM_H
+#define SIM_HI_PWM_H
+
+#include "hi_io.h"
+
+typedef enum {
+    HI_PWM_PORT_PWM0,
+    HI_PWM_PORT_PWM1,
+    HI_PWM_PORT_PWM2,
+    HI_PWM_PORT_PWM3,
+    HI_PWM_PORT_PWM4,
+    HI_PWM_PORT_PWM5,
+    HI_PWM_PORT_MAX
+} hi_pwm_port;
+
+hi_u32 hi_pwm_init(hi_pwm_port port);
+hi_u32 hi_pwm_start(hi_pwm_port port, hi_u16 duty, hi_u16 freq);
+hi_u32 hi_pwm_stop(hi_pwm_port port);
+
+#endif // SIM_HI_PWM_H
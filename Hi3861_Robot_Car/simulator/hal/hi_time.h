@@ -0,0 +1,14 @@
+#ifndef SIM_HI_TIME_H
+#define SIM_HI_TIME_H
+
+#include "hi_io.h"
+
+hi_void hi_udelay(hi_u32 us);
+hi_u32 hi_get_tick(hi_void);
+hi_u64 hi_get_tick64(hi_void);
+hi_u32 hi_get_milli_seconds(hi_void);
+hi_u32 hi_get_seconds(hi_void);
+hi_u64 hi_get_us(hi_void);
+hi_u32 hi_sleep(hi_u32 ms);
+
+#endif // SIM_HI_TIME_H
@@ -0,0 +1,20 @@
+#ifndef SIM_HI_TIMER_H
+#define SIM_HI_TIMER_H
+
+#include "hi_io.h"
+
+typedef enum {
+    HI_TIMER_TYPE_ONCE,
+    HI_TIMER_TYPE_PERIOD,
+    HI_TIMER_TYPE_MAX
+} hi_timer_type;
+
+typedef hi_void (*hi_timer_callback_f)(hi_u32 data);
+
+hi_u32 hi_timer_create(hi_u32 *timer_handle);
+hi_u32 hi_timer_start(hi_u32 timer_handle, hi_timer_type type, hi_u32 expire,
+                      hi_timer_callback_f timer_func, hi_u32 data);
+hi_u32 hi_timer_stop(hi_u32 timer_handle);
+hi_u32 hi_timer_delete(hi_u32 timer_handle);
+
+#endif // SIM_HI_TIMER_H
@@ -0,0 +1,7 @@
+#ifndef SIM_IOT_ERRNO_H
+#define SIM_IOT_ERRNO_H
+
+#define IOT_SUCCESS 0
+#define IOT_FAILURE (-1)
+
+#endif // SIM_IOT_ERRNO_H
@@ -0,0 +1,33 @@
+#ifndef SIM_IOT_GPIO_H
+#define SIM_IOT_GPIO_H
+
+typedef enum {
+    IOT_GPIO_VALUE0 = 0,
+    IOT_GPIO_VALUE1
+} IotGpioValue;
+
+typedef enum {
+    IOT_GPIO_DIR_IN = 0,
+    IOT_GPIO_DIR_OUT
+} IotGpioDir;
+
+typedef enum {
+    IOT_INT_TYPE_LEVEL = 0,
+    IOT_INT_TYPE_EDGE
+} IotGpioIntType;
+
+typedef enum {
+    IOT_GPIO_EDGE_FALL_LEVEL_LOW = 0,
+    IOT_GPIO_EDGE_RISE_LEVEL_HIGH
+} IotGpioIntPolarity;
+
+typedef void (*GpioIsrCallbackFunc)(char *arg);
+
+unsigned int IoTGpioInit(unsigned int id);
+unsigned int IoTGpioSetDir(unsigned int id, IotGpioDir dir);
+unsigned int IoTGpioSetOutputVal(unsigned int id, IotGpioValue val);
+unsigned int IoTGpioGetInputVal(unsigned int id, IotGpioValue *val);
+unsigned int IoTGpioRegisterIsrFunc(unsigned int id, IotGpioIntType intType, IotGpioIntPolarity intPolarity,
+                                    GpioIsrCallbackFunc func, char *arg);
+
+#endif // SIM_IOT_GPIO_H
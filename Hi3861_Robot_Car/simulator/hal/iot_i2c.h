@@ -0,0 +1,8 @@
+// 仿真用SDK头文件：只声明固件实际用到的类型和接口
+#ifndef SIM_IOT_I2C_H
+#define SIM_IOT_I2C_H
+
+unsigned int IoTI2cInit(unsigned int id, unsigned int baudrate);
+unsigned int IoTI2cWrite(unsigned int id, unsigned short deviceAddr, const unsigned char *data, unsigned int dataLen);
+
+#endif // SIM_IOT_I2C_H
@@ -0,0 +1,6 @@
+#ifndef SIM_IOT_PWM_H
+#define SIM_IOT_PWM_H
+
+// 固件只用hi_pwm接口，这里保留空头文件以便原样编译
+
+#endif // SIM_IOT_PWM_H
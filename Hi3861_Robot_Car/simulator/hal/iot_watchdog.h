@@ -0,0 +1,6 @@
+#ifndef SIM_IOT_WATCHDOG_H
+#define SIM_IOT_WATCHDOG_H
+
+void IoTWatchDogDisable(void);
+
+#endif // SIM_IOT_WATCHDOG_H
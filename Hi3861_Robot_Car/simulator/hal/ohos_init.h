@@ -0,0 +1,8 @@
+#ifndef SIM_OHOS_INIT_H
+#define SIM_OHOS_INIT_H
+
+// 仿真器按场景显式调用入口函数，不做自动注册
+#define APP_FEATURE_INIT(func)
+#define SYS_RUN(func)
+
+#endif // SIM_OHOS_INIT_H
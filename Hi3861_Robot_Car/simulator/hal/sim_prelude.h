@@ -0,0 +1,14 @@
+// 编译固件源文件时强制包含：把日志输出接到仿真器，并补上固件依赖的SDK隐式声明
+#ifndef SIM_PRELUDE_H
+#define SIM_PRELUDE_H
+
+#include <stdio.h>
+#include <string.h>
+
+int sim_printf(const char *fmt, ...);
+#define printf sim_printf
+
+int memset_s(void *dest, size_t dest_max, int c, size_t count);
+void IoTWatchDogDisable(void);
+
+#endif // SIM_PRELUDE_H
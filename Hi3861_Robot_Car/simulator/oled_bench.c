@@ -0,0 +1,587 @@
+/*
+ * OLED驱动主机基准
+ * 功能：把ssd1306驱动与仿真内核、面板模型一起编译成主机程序：
+ *       校验按页条带绘制的字符、按字节填充的线段和矩形与逐像素绘制的结果在面板上逐字节一致，
+ *       校验保留模式控件的重绘规则和绘制结果，再比较两种绘制方式的速度；
+ *       状态界面逐帧重画时统计每帧实际发送的字节数和总线时间；
+ *       最后启动刷屏任务，比较同步发送和提交给刷屏任务时调用者阻塞的时间，以及连续提交时的丢帧和上屏延迟
+ * 用法：make oled_bench && ./oled_bench，任一项校验不一致时返回1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmsis_os2.h"
+#include "ssd1306.h"
+#include "robot_widget.h"
+
+#include "sim_hal.h"
+#include "sim_kernel.h"
+#include "sim_oled.h"
+
+#define BENCH_CHARS         (200000)    // 每项吞吐测试绘制的字符数
+#define BENCH_SHAPES        (20000)     // 每项图形测试的绘制次数
+#define BENCH_CHECK_X       (5)
+#define BENCH_CHECK_SHAPES  (2000)      // 随机线段和矩形的校验次数
+#define BENCH_DASH_FRAMES   (100)       // 状态界面更新的帧数，按100ms一帧相当于10s
+#define BENCH_DASH_STATUS   (20)        // 状态文字每隔这么多帧变化一次
+#define BENCH_PRESENT_FRAMES (200)      // 每个系统tick(10ms)提交一帧整屏都变化的画面，比整屏发送时间短
+
+typedef struct {
+    const char *name;
+    FontDef *font;
+} BenchFont;
+
+static BenchFont g_fonts[] = {
+    {"6x8", &Font_6x8},
+    {"7x10", &Font_7x10},
+    {"11x18", &Font_11x18},
+    {"16x26", &Font_16x26},
+};
+
+#define BENCH_FONT_COUNT    ((int)(sizeof(g_fonts) / sizeof(g_fonts[0])))
+
+static uint8_t g_pattern[SSD1306_BUFFER_SIZE];
+static uint8_t g_expect[SIM_OLED_RAM_SIZE];
+static int g_done = 0;
+static int g_failed = 0;            // 校验不一致的项数，非0时返回1
+
+// 改动前的绘制方式：字模逐行展开，前景和背景每个像素调用一次ssd1306_DrawPixel()
+static void bench_draw_pixels(char ch, const FontDef *font, uint8_t x, uint8_t y, SSD1306_COLOR color)
+{
+    for (uint32_t i = 0; i < font->FontHeight; i++) {
+        uint32_t b = font->data[(ch - 32) * font->FontHeight + i];
+        for (uint32_t j = 0; j < font->FontWidth; j++) {
+            if ((b << j) & 0x8000) {
+                ssd1306_DrawPixel(x + j, y + i, color);
+            } else {
+                ssd1306_DrawPixel(x + j, y + i, (SSD1306_COLOR)!color);
+            }
+        }
+    }
+}
+
+// 改动前的DrawLine：Bresenham逐像素
+static void bench_line_pixels(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color)
+{
+    int dx = abs(x2 - x1);
+    int dy = abs(y2 - y1);
+    int sx = (x1 < x2) ? 1 : -1;
+    int sy = (y1 < y2) ? 1 : -1;
+    int err = dx - dy;
+
+    ssd1306_DrawPixel(x2, y2, color);
+    while (x1 != x2 || y1 != y2) {
+        ssd1306_DrawPixel(x1, y1, color);
+        int err2 = err * 2;
+        if (err2 > -dy) {
+            err -= dy;
+            x1 += sx;
+        }
+        if (err2 < dx) {
+            err += dx;
+            y1 += sy;
+        }
+    }
+}
+
+static void bench_rect_pixels(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color)
+{
+    for (int y = (y1 < y2 ? y1 : y2); y <= (y1 < y2 ? y2 : y1); y++) {
+        for (int x = (x1 < x2 ? x1 : x2); x <= (x1 < x2 ? x2 : x1); x++) {
+            ssd1306_DrawPixel(x, y, color);
+        }
+    }
+}
+
+static void bench_draw_strips(char ch, const FontDef *font, uint8_t x, uint8_t y, SSD1306_COLOR color)
+{
+    ssd1306_SetCursor(x, y);
+    ssd1306_DrawChar(ch, *font, color);
+}
+
+// 记下参考绘制送到面板的内容
+static void bench_expect(void)
+{
+    ssd1306_UpdateScreen();
+    memcpy(g_expect, sim_oled_ram(), sizeof(g_expect));
+}
+
+// 与bench_expect()比较，不一致返回1
+static int bench_compare(void)
+{
+    ssd1306_UpdateScreen();
+    return memcmp(g_expect, sim_oled_ram(), sizeof(g_expect)) != 0;
+}
+
+// 每个字体、页内偏移和颜色下逐字比较两种方式送到面板的内容，背景用杂乱图案检查掩码
+static int bench_check_glyphs(void)
+{
+    int mismatches = 0;
+    int checked = 0;
+
+    for (int f = 0; f < BENCH_FONT_COUNT; f++) {
+        const FontDef *font = g_fonts[f].font;
+        for (uint8_t y = 8; y < 16; y++) {
+            for (int color = Black; color <= White; color++) {
+                for (char ch = 32; ch <= 126; ch++) {
+                    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+                    bench_draw_pixels(ch, font, BENCH_CHECK_X, y, (SSD1306_COLOR)color);
+                    bench_expect();
+
+                    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+                    bench_draw_strips(ch, font, BENCH_CHECK_X, y, (SSD1306_COLOR)color);
+                    if (bench_compare()) {
+                        if (mismatches++ < 5) {
+                            printf("mismatch: font %s, y %u, color %d, char '%c'\n", g_fonts[f].name, y, color, ch);
+                        }
+                    }
+                    checked++;
+                }
+            }
+        }
+    }
+    printf("glyph check: %d glyphs, %d mismatches\n", checked, mismatches);
+    return mismatches;
+}
+
+// 随机线段(其中一半水平或垂直)和填充矩形，与逐像素绘制比较，坐标可越界检查裁剪
+static int bench_check_shapes(void)
+{
+    int mismatches = 0;
+
+    srand(7);
+    for (int i = 0; i < BENCH_CHECK_SHAPES; i++) {
+        uint8_t x1 = rand() % 140;
+        uint8_t y1 = rand() % 72;
+        uint8_t x2 = (i % 4 == 0) ? x1 : rand() % 140;
+        uint8_t y2 = (i % 4 == 1) ? y1 : rand() % 72;
+        SSD1306_COLOR color = (SSD1306_COLOR)(rand() % 2);
+
+        ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+        bench_line_pixels(x1, y1, x2, y2, color);
+        bench_expect();
+        ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+        ssd1306_DrawLine(x1, y1, x2, y2, color);
+        if (bench_compare() && mismatches++ < 5) {
+            printf("mismatch: line %u,%u-%u,%u color %d\n", x1, y1, x2, y2, color);
+        }
+
+        ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+        bench_rect_pixels(x1, y1, x2, y2, color);
+        bench_expect();
+        ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+        ssd1306_FillRect(x1, y1, x2, y2, color);
+        if (bench_compare() && mismatches++ < 5) {
+            printf("mismatch: rect %u,%u-%u,%u color %d\n", x1, y1, x2, y2, color);
+        }
+    }
+    printf("shape check: %d lines, %d rects, %d mismatches\n", BENCH_CHECK_SHAPES, BENCH_CHECK_SHAPES, mismatches);
+    return mismatches;
+}
+
+// 控件校验用的数据源
+static int g_widget_values[4];
+
+static int bench_source0(void)
+{
+    return g_widget_values[0];
+}
+
+static int bench_source1(void)
+{
+    return g_widget_values[1];
+}
+
+static int bench_source2(void)
+{
+    return g_widget_values[2];
+}
+
+// 在包围盒内画实心方块
+static void bench_icon_draw(const Widget *widget, int value)
+{
+    if (value) {
+        ssd1306_FillRect(widget->x + 1, widget->y + 1, widget->x + widget->w - 2, widget->y + widget->h - 2, White);
+    }
+}
+
+static const char *const g_widget_texts[] = {"GO", "STOP"};
+
+static int g_widget_cases = 0;
+static int g_widget_failures = 0;
+
+static void bench_widget_result(const char *name, int ok)
+{
+    g_widget_cases++;
+    if (!ok) {
+        g_widget_failures++;
+        printf("widget mismatch: %s\n", name);
+    }
+}
+
+// 单个控件在杂乱背景上画一次，与按规则直接绘制的参考结果比较：包围盒外不能改动
+static void bench_widget_single(const char *name, Widget *widget, int value, void (*reference)(const Widget *))
+{
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    ssd1306_FillRect(widget->x, widget->y, widget->x + widget->w - 1, widget->y + widget->h - 1, Black);
+    reference(widget);
+    bench_expect();
+
+    g_widget_values[0] = value;
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    widget_invalidate(widget, 1);
+    widget_update(widget, 1);
+    bench_widget_result(name, !bench_compare());
+}
+
+static void bench_ref_blank(const Widget *widget)
+{
+    (void)widget;
+}
+
+static void bench_ref_label(const Widget *widget)
+{
+    ssd1306_SetCursor(widget->x, widget->y);
+    ssd1306_DrawString("STOP", *widget->font, White);
+}
+
+// 30列宽的包围盒放得下5个6x8字符，第6个字符放不下就整个不画
+static void bench_ref_value(const Widget *widget)
+{
+    ssd1306_SetCursor(widget->x, widget->y);
+    ssd1306_DrawString("Speed", *widget->font, White);
+}
+
+static void bench_ref_bar_half(const Widget *widget)
+{
+    ssd1306_FillRect(widget->x, widget->y, widget->x + widget->w / 2 - 1, widget->y + widget->h - 1, White);
+}
+
+static void bench_ref_bar_full(const Widget *widget)
+{
+    ssd1306_FillRect(widget->x, widget->y, widget->x + widget->w - 1, widget->y + widget->h - 1, White);
+}
+
+// 控件重绘规则：值不变不画；值变化的控件重画后，压在它上面的控件补画，不相交的控件不动；
+// 增量更新后的画面与全部重画的结果一致
+static void bench_widget_overlap(void)
+{
+    Widget widgets[] = {
+        {WIDGET_LABEL, WIDGET_ALIGN_LEFT, 10, 10, 60, 8, bench_source0, &Font_6x8, g_widget_texts, NULL, 2, NULL},
+        {WIDGET_ICON, WIDGET_ALIGN_LEFT, 14, 8, 10, 12, bench_source1, NULL, NULL, NULL, 0, bench_icon_draw},
+        {WIDGET_VALUE, WIDGET_ALIGN_LEFT, 10, 40, 60, 8, bench_source2, &Font_6x8, NULL, "%d", 0, NULL},
+    };
+    int count = (int)(sizeof(widgets) / sizeof(widgets[0]));
+    SimI2cStats before;
+    SimI2cStats after;
+
+    g_widget_values[0] = 0;
+    g_widget_values[1] = 1;
+    g_widget_values[2] = 42;
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    widget_invalidate(widgets, count);
+    bench_widget_result("first update draws all", widget_update(widgets, count) == count);
+    ssd1306_UpdateScreen();
+
+    sim_oled_stats(&before);
+    bench_widget_result("unchanged update draws none", widget_update(widgets, count) == 0);
+    ssd1306_UpdateScreen();
+    sim_oled_stats(&after);
+    bench_widget_result("unchanged update sends nothing", after.bytes == before.bytes);
+
+    // 下层标签变化：上层图标补画，不相交的数值不画
+    g_widget_values[0] = 1;
+    bench_widget_result("overlap redraws upper", widget_update(widgets, count) == 2);
+    ssd1306_UpdateScreen();
+    uint8_t incremental[SIM_OLED_RAM_SIZE];
+    memcpy(incremental, sim_oled_ram(), sizeof(incremental));
+
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    widget_invalidate(widgets, count);
+    widget_update(widgets, count);
+    ssd1306_UpdateScreen();
+    bench_widget_result("incremental equals full redraw", memcmp(incremental, sim_oled_ram(), sizeof(incremental)) == 0);
+
+    // 上层图标变化：只画它自己，下层标签被清掉的部分不补画
+    g_widget_values[1] = 0;
+    bench_widget_result("upper change redraws only upper", widget_update(widgets, count) == 1);
+}
+
+static int bench_check_widgets(void)
+{
+    Widget label = {WIDGET_LABEL, WIDGET_ALIGN_LEFT, 20, 12, 40, 8, bench_source0, &Font_6x8, g_widget_texts, NULL, 2,
+                    NULL};
+    Widget value = {WIDGET_VALUE, WIDGET_ALIGN_LEFT, 20, 12, 30, 8, bench_source0, &Font_6x8, NULL, "Speed: %d", 0,
+                    NULL};
+    Widget bar = {WIDGET_BAR, WIDGET_ALIGN_LEFT, 11, 33, 50, 5, bench_source0, NULL, NULL, NULL, 100, NULL};
+
+    bench_widget_single("label in range", &label, 1, bench_ref_label);
+    bench_widget_single("label above range", &label, 2, bench_ref_blank);
+    bench_widget_single("label negative", &label, -1, bench_ref_blank);
+    bench_widget_single("value truncated", &value, 6000, bench_ref_value);
+    bench_widget_single("bar half", &bar, 50, bench_ref_bar_half);
+    bench_widget_single("bar over limit", &bar, 150, bench_ref_bar_full);
+    bench_widget_single("bar below one column", &bar, 1, bench_ref_blank);
+    bench_widget_single("bar negative", &bar, -5, bench_ref_blank);
+    bench_widget_overlap();
+
+    printf("widget check: %d cases, %d mismatches\n", g_widget_cases, g_widget_failures);
+    return g_widget_failures;
+}
+
+static double bench_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 沿一行反复绘制可打印字符，返回每秒字符数(主机CPU时间)
+static double bench_rate(void (*draw)(char, const FontDef *, uint8_t, uint8_t, SSD1306_COLOR),
+                         const FontDef *font, uint8_t y)
+{
+    uint8_t x = 0;
+    char ch = 32;
+    double begin = bench_seconds();
+
+    for (int i = 0; i < BENCH_CHARS; i++) {
+        if (x + font->FontWidth > SSD1306_WIDTH) {
+            x = 0;
+        }
+        draw(ch, font, x, y, White);
+        x += font->FontWidth;
+        ch = (ch == 126) ? 32 : ch + 1;
+    }
+    return BENCH_CHARS / (bench_seconds() - begin);
+}
+
+// 仪表盘速度条：改动前80条竖线逐像素，改动后一次FillRect
+static void bench_bar_pixels(void)
+{
+    for (int i = 0; i < 80; i++) {
+        bench_line_pixels(10 + i, 33, 10 + i, 37, White);
+    }
+}
+
+static void bench_bar_spans(void)
+{
+    ssd1306_FillRect(10, 33, 89, 37, White);
+}
+
+// 状态界面外框
+static void bench_frame_pixels(void)
+{
+    bench_line_pixels(0, 0, 127, 0, White);
+    bench_line_pixels(127, 0, 127, 63, White);
+    bench_line_pixels(127, 63, 0, 63, White);
+    bench_line_pixels(0, 63, 0, 0, White);
+}
+
+static void bench_frame_spans(void)
+{
+    ssd1306_DrawRectangle(0, 0, 127, 63, White);
+}
+
+// 清屏：改动前逐字节比较写入，与FillBuffer()相同
+static void bench_clear_bytes(void)
+{
+    static const uint8_t zero[SSD1306_BUFFER_SIZE];
+    ssd1306_FillBuffer((uint8_t *)zero, sizeof(zero));
+}
+
+static void bench_clear_memset(void)
+{
+    ssd1306_Fill(Black);
+}
+
+typedef struct {
+    const char *name;
+    void (*pixels)(void);
+    void (*spans)(void);
+} BenchShape;
+
+static const BenchShape g_shapes[] = {
+    {"speed bar 80x5", bench_bar_pixels, bench_bar_spans},
+    {"frame 128x64", bench_frame_pixels, bench_frame_spans},
+    {"clear screen", bench_clear_bytes, bench_clear_memset},
+};
+
+// 在同一背景上反复绘制一个图形，返回每次的耗时(主机CPU时间, ns)
+static double bench_shape_ns(void (*draw)(void))
+{
+    double begin = bench_seconds();
+
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    for (int i = 0; i < BENCH_SHAPES; i++) {
+        draw();
+    }
+    return (bench_seconds() - begin) * 1e9 / BENCH_SHAPES;
+}
+
+// 状态界面的一帧：与ssd1306_test.c相同的布局，整屏清空后全部重画，只有状态文字变化
+static void bench_dashboard_draw(int status)
+{
+    ssd1306_Fill(Black);
+    ssd1306_DrawRectangle(0, 0, 127, 63, White);
+    ssd1306_DrawRectangle(2, 2, 125, 13, White);
+    ssd1306_SetCursor(19, 3);
+    ssd1306_DrawString("TRACE MODE", Font_7x10, White);
+    ssd1306_DrawRectangle(105, 3, 123, 11, White);
+    ssd1306_FillRect(107, 5, 117, 9, White);
+    ssd1306_SetCursor(10, 20);
+    ssd1306_DrawString("Speed: 6000", Font_7x10, White);
+    ssd1306_DrawRectangle(10, 32, 90, 38, White);
+    ssd1306_FillRect(11, 33, 68, 37, White);
+    ssd1306_SetCursor(10, 45);
+    ssd1306_DrawString(status ? "Turing left..." : "Moving forward...", Font_7x10, White);
+}
+
+// 逐帧更新状态界面，full为1时每帧先使面板副本失效，按改动前的方式整屏发送
+static void bench_dashboard(const char *name, int full)
+{
+    SimI2cStats before;
+    SimI2cStats after;
+
+    sim_oled_stats(&before);
+    for (int i = 0; i < BENCH_DASH_FRAMES; i++) {
+        bench_dashboard_draw((i / BENCH_DASH_STATUS) % 2);
+        if (full) {
+            ssd1306_InvalidateScreen();
+        }
+        ssd1306_UpdateScreen();
+    }
+    sim_oled_stats(&after);
+    printf("dashboard %-8s %5.2f transfers, %7.1f bytes, bus %6.2f ms per frame\n", name,
+           (double)(after.transfers - before.transfers) / BENCH_DASH_FRAMES,
+           (double)(after.bytes - before.bytes) / BENCH_DASH_FRAMES,
+           (after.busy_us - before.busy_us) / 1000.0 / BENCH_DASH_FRAMES);
+}
+
+// 整屏每字节都与上一帧不同的画面
+static void bench_fill_frame(uint8_t seed)
+{
+    static uint8_t frame[SSD1306_BUFFER_SIZE];
+
+    for (int i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        frame[i] = g_pattern[i] ^ seed;
+    }
+    ssd1306_FillBuffer(frame, sizeof(frame));
+}
+
+// 双缓冲：同步发送时调用者等满整屏的总线时间，提交给刷屏任务时只复制变化的窗口；
+// 连续提交快于总线时，来不及发送的帧被下一帧替换
+static void bench_present(void)
+{
+    SSD1306_Stats_t before;
+    SSD1306_Stats_t after;
+    uint64_t begin;
+
+    ssd1306_StartFlushTask();
+
+    bench_fill_frame(0x01);
+    begin = sim_now_us();
+    ssd1306_UpdateScreen();
+    unsigned int sync_us = (unsigned int)(sim_now_us() - begin);
+
+    bench_fill_frame(0x02);
+    begin = sim_now_us();
+    ssd1306_Present();
+    unsigned int present_us = (unsigned int)(sim_now_us() - begin);
+    osDelay(5);
+
+    ssd1306_GetStats(&before);
+    for (int i = 0; i < BENCH_PRESENT_FRAMES; i++) {
+        bench_fill_frame((uint8_t)(i + 3));
+        ssd1306_Present();
+        osDelay(1);
+    }
+    osDelay(5);
+    ssd1306_GetStats(&after);
+    printf("full frame caller blocked: UpdateScreen %u us, Present %u us\n", sync_us, present_us);
+    printf("present every 10 ms: %u presented, %u sent, %u dropped, max present-to-panel %.1f ms\n",
+           after.presented - before.presented, after.updates - before.updates, after.dropped - before.dropped,
+           after.maxFrameUs / 1000.0);
+}
+
+static void bench_task(void *arg)
+{
+    (void)arg;
+
+    for (int i = 0; i < SSD1306_BUFFER_SIZE; i++) {
+        g_pattern[i] = (uint8_t)(i * 37) ^ 0x5A;
+    }
+    // 上电初始化：I2C传输次数、字节数和总线时间，总耗时含驱动里等屏幕上电的100ms
+    SimI2cStats before;
+    SimI2cStats after;
+    uint64_t begin = sim_now_us();
+    ssd1306_Init();
+    sim_oled_stats(&after);
+    printf("init: %.1f ms, %u I2C transfers, %llu bytes, bus %llu us\n", (sim_now_us() - begin) / 1000.0,
+           after.transfers, after.bytes, after.busy_us);
+
+    // 整屏更新
+    ssd1306_FillBuffer(g_pattern, sizeof(g_pattern));
+    sim_oled_stats(&before);
+    ssd1306_UpdateScreen();
+    sim_oled_stats(&after);
+    printf("full frame: %u I2C transfers, %llu bytes, bus %llu us\n", after.transfers - before.transfers,
+           after.bytes - before.bytes, after.busy_us - before.busy_us);
+
+    // 状态界面：每帧整屏发送与只发送变化的页窗口
+    bench_dashboard("full", 1);
+    bench_dashboard("changed", 0);
+
+    g_failed += bench_check_glyphs();
+    g_failed += bench_check_shapes();
+    g_failed += bench_check_widgets();
+
+    printf("%-6s %3s %14s %14s %8s\n", "font", "y", "pixels char/s", "strips char/s", "speedup");
+    for (int f = 0; f < BENCH_FONT_COUNT; f++) {
+        const FontDef *font = g_fonts[f].font;
+        // 页对齐和不对齐各测一次，不对齐时每列要多写一个字节
+        uint8_t rows[] = {16, 20};
+        for (int r = 0; r < 2; r++) {
+            if (rows[r] + font->FontHeight > SSD1306_HEIGHT) {
+                continue;
+            }
+            double pixels = bench_rate(bench_draw_pixels, font, rows[r]);
+            double strips = bench_rate(bench_draw_strips, font, rows[r]);
+            printf("%-6s %3u %14.0f %14.0f %7.1fx\n", g_fonts[f].name, rows[r], pixels, strips, strips / pixels);
+        }
+    }
+
+    printf("%-16s %12s %12s %8s\n", "shape", "pixels ns", "spans ns", "speedup");
+    for (int i = 0; i < (int)(sizeof(g_shapes) / sizeof(g_shapes[0])); i++) {
+        double pixels = bench_shape_ns(g_shapes[i].pixels);
+        double spans = bench_shape_ns(g_shapes[i].spans);
+        printf("%-16s %12.0f %12.0f %7.1fx\n", g_shapes[i].name, pixels, spans, pixels / spans);
+    }
+
+    bench_present();
+    g_done = 1;
+}
+
+static int bench_done(void)
+{
+    return g_done;
+}
+
+int main(void)
+{
+    osThreadAttr_t attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.name = "BenchTask";
+    attr.stack_size = 4096;
+    attr.priority = 25;
+
+    sim_kernel_init(NULL);
+    sim_hal_init(0);
+    sim_oled_init();
+    osThreadNew(bench_task, NULL, &attr);
+    sim_kernel_run(SIM_FOREVER, bench_done);
+    return g_failed ? 1 : 0;
+}
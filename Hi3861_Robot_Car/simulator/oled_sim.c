@@ -0,0 +1,157 @@
+/*
+ * OLED状态界面仿真
+ * 功能：把ssd1306_test.c的状态界面、控件模块和ssd1306驱动与小车状态接口、仿真内核和面板模型一起编译：
+ *       启动动画结束后分别统计停车和行驶时的帧数和I2C占用，并打印状态界面自己的唤醒统计；
+ *       检查状态版本号变化后多久上屏、停车时不刷屏、行驶时帧率不超过上限
+ * 用法：make oled_sim && ./oled_sim，任一项检查不通过时返回1；固件日志带虚拟时间戳输出
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "cmsis_os2.h"
+#include "robot_control.h"
+#include "ssd1306.h"
+
+#include "sim_hal.h"
+#include "sim_kernel.h"
+#include "sim_oled.h"
+
+#define SIM_OLED_BOOT_MS        (25000)     // 启动动画按tick计时约23s，之后进入状态界面
+#define SIM_OLED_PHASE_MS       (20000)     // 停车和行驶各统计的时间
+#define SIM_OLED_FLIP_MS        (60)        // 行驶时运动状态变化的间隔，快于帧率上限
+#define SIM_OLED_FPS_MAX        (10)        // 与ssd1306_test.c的OLED_FPS_MAX一致
+#define SIM_OLED_LATENCY_MS     (1000 / SIM_OLED_FPS_MAX)   // 状态变化到上屏的上限：最多等一帧的间隔
+#define SIM_OLED_WAIT_MS        (2000)      // 等待上屏的最长时间，超过判为没有刷新
+#define SIM_OLED_POLL_US        (1000)
+
+extern unsigned short SPEED_FORWARD;
+extern void Ssd1306TestDemo(void);
+extern void oled_report(void);
+
+static int g_done = 0;
+static int g_failed = 0;
+
+typedef struct {
+    SSD1306_Stats_t panel;
+    SimI2cStats bus;
+    uint64_t now_us;
+} SimOledSample;
+
+static void sim_oled_sample(SimOledSample *sample)
+{
+    ssd1306_GetStats(&sample->panel);
+    sim_oled_stats(&sample->bus);
+    sample->now_us = sim_now_us();
+}
+
+// 打印一段时间内送到面板的帧数、I2C字节数和总线占用率，返回帧数
+static unsigned int sim_oled_phase(const char *name, const SimOledSample *begin)
+{
+    SimOledSample end;
+
+    sim_oled_sample(&end);
+    uint64_t elapsed = end.now_us - begin->now_us;
+    unsigned int frames = end.panel.presented - begin->panel.presented;
+    printf("%-8s %5.1f s: %u frames presented, %u sent, %llu I2C bytes, bus %.3f%%\n", name, elapsed / 1e6,
+           frames, end.panel.updates - begin->panel.updates, end.bus.bytes - begin->bus.bytes,
+           (end.bus.busy_us - begin->bus.busy_us) * 100.0 / elapsed);
+    oled_report();
+    return frames;
+}
+
+static void sim_oled_check(const char *name, int ok)
+{
+    printf("check %-32s %s\n", name, ok ? "ok" : "FAIL");
+    if (!ok) {
+        g_failed++;
+    }
+}
+
+// 改变状态后每1ms查看一次面板，返回等到新帧发送完的时间(ms)，超时返回-1
+static int sim_oled_latency(void (*change)(void))
+{
+    SSD1306_Stats_t before;
+    SSD1306_Stats_t now;
+    uint64_t begin = sim_now_us();
+
+    ssd1306_GetStats(&before);
+    change();
+    while (sim_now_us() - begin < (uint64_t)SIM_OLED_WAIT_MS * 1000) {
+        sim_delay_us(SIM_OLED_POLL_US);
+        ssd1306_GetStats(&now);
+        if (now.updates != before.updates) {
+            return (int)((sim_now_us() - begin) / 1000);
+        }
+    }
+    return -1;
+}
+
+static void sim_oled_change_speed(void)
+{
+    car_set_speed(SPEED_FORWARD + CAR_SPEED_STEP);
+}
+
+static void sim_oled_change_mode(void)
+{
+    car_set_status(CAR_TRACE_STATUS);
+}
+
+static void sim_oled_task(void *arg)
+{
+    SimOledSample begin;
+
+    (void)arg;
+    Ssd1306TestDemo();
+    osDelay(SIM_OLED_BOOT_MS / 10);
+    oled_report();
+
+    // 停车：没有状态变化，状态界面只按OLED_REFRESH_MAX_MS超时醒来，不应提交新帧
+    sim_oled_sample(&begin);
+    osDelay(SIM_OLED_PHASE_MS / 10);
+    unsigned int parked = sim_oled_phase("parked", &begin);
+
+    // 版本号和事件握手：停车很久之后改变状态，应在一帧间隔内上屏
+    int speed_ms = sim_oled_latency(sim_oled_change_speed);
+    osDelay(SIM_OLED_LATENCY_MS / 10 + 1);
+    int mode_ms = sim_oled_latency(sim_oled_change_mode);
+    printf("latency  speed %d ms, mode %d ms\n", speed_ms, mode_ms);
+    osDelay(SIM_OLED_LATENCY_MS / 10 + 1);
+
+    // 行驶：运动状态每SIM_OLED_FLIP_MS变化一次，帧数受帧率上限约束
+    sim_oled_sample(&begin);
+    for (int i = 0; i < SIM_OLED_PHASE_MS / SIM_OLED_FLIP_MS; i++) {
+        car_set_moving((i % 2) ? 1 : 3);
+        osDelay(SIM_OLED_FLIP_MS / 10);
+    }
+    unsigned int driving = sim_oled_phase("driving", &begin);
+
+    sim_oled_check("parked presents no frame", parked == 0);
+    sim_oled_check("speed change shown in one frame", speed_ms >= 0 && speed_ms <= SIM_OLED_LATENCY_MS);
+    sim_oled_check("mode change shown in one frame", mode_ms >= 0 && mode_ms <= SIM_OLED_LATENCY_MS);
+    sim_oled_check("driving frame rate capped", driving > 0 &&
+                   driving <= SIM_OLED_PHASE_MS / 1000 * SIM_OLED_FPS_MAX + 1);
+    g_done = 1;
+}
+
+static int sim_oled_done(void)
+{
+    return g_done;
+}
+
+int main(void)
+{
+    osThreadAttr_t attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.name = "OledSimTask";
+    attr.stack_size = 4096;
+    attr.priority = 25;
+
+    sim_kernel_init(NULL);
+    sim_hal_init(1);
+    sim_oled_init();
+    osThreadNew(sim_oled_task, NULL, &attr);
+    sim_kernel_run(SIM_FOREVER, sim_oled_done);
+    return g_failed ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * 仿真外设层
+ * 功能：实现固件调用的GPIO、PWM、ADC等SDK接口，转接到仿真世界模型
+ *       固件中不参与仿真的外设(WiFi/UDP、看门狗)在这里实现为空操作
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hi_adc.h"
+#include "hi_io.h"
+#include "hi_pwm.h"
+#include "hi_timer.h"
+#include "iot_errno.h"
+#include "iot_gpio.h"
+
+#include "sim_hal.h"
+#include "sim_kernel.h"
+#include "sim_world.h"
+
+// 电机PWM端口与robot_l9110s.c一致：左轮PWM4前进/PWM3后退，右轮PWM1前进/PWM0后退
+static float g_pwm_duty[HI_PWM_PORT_MAX];
+static int g_verbose = 0;
+
+// GPIO5按键：按下时在中断上下文中调用固件注册的中断函数
+static GpioIsrCallbackFunc g_gpio5_isr = NULL;
+static char *g_gpio5_isr_arg = NULL;
+static const SimButton *g_buttons = NULL;
+static int g_button_count = 0;
+static int g_button_index = 0;
+static int g_button_down = 0;
+static unsigned int g_button_timer = 0;
+static hi_u16 g_adc_code = SIM_ADC_IDLE_CODE;
+static float g_battery_v = 0.0f;
+
+void sim_hal_init(int verbose)
+{
+    memset(g_pwm_duty, 0, sizeof(g_pwm_duty));
+    g_verbose = verbose;
+    g_gpio5_isr = NULL;
+    g_buttons = NULL;
+    g_button_count = 0;
+    g_adc_code = SIM_ADC_IDLE_CODE;
+    g_battery_v = 0.0f;
+}
+
+void sim_battery_init(float voltage)
+{
+    g_battery_v = voltage;
+}
+
+// 按下时切换ADC读数并触发中断，松开时恢复空闲读数，然后定好下一次动作
+static void sim_button_timer(hi_u32 data)
+{
+    const SimButton *button = &g_buttons[g_button_index];
+    unsigned int next_ms;
+
+    (void)data;
+    if (!g_button_down) {
+        g_button_down = 1;
+        g_adc_code = button->adc_code;
+        if (g_gpio5_isr != NULL) {
+            g_gpio5_isr(g_gpio5_isr_arg);
+        }
+        next_ms = button->hold_ms;
+    } else {
+        g_button_down = 0;
+        g_adc_code = SIM_ADC_IDLE_CODE;
+        if (++g_button_index >= g_button_count) {
+            return;
+        }
+        next_ms = g_buttons[g_button_index].at_ms - (button->at_ms + button->hold_ms);
+    }
+    hi_timer_start(g_button_timer, HI_TIMER_TYPE_ONCE, next_ms, sim_button_timer, 0);
+}
+
+void sim_button_init(const SimButton *buttons, int count)
+{
+    g_buttons = buttons;
+    g_button_count = count;
+    g_button_index = 0;
+    g_button_down = 0;
+    if (buttons == NULL || count <= 0) {
+        return;
+    }
+    hi_timer_create(&g_button_timer);
+    hi_timer_start(g_button_timer, HI_TIMER_TYPE_ONCE, buttons[0].at_ms, sim_button_timer, 0);
+}
+
+int sim_printf(const char *fmt, ...)
+{
+    va_list args;
+    int ret;
+
+    if (!g_verbose) {
+        return 0;
+    }
+    printf("[%9.3f] ", sim_now_us() / 1000000.0);
+    va_start(args, fmt);
+    ret = vprintf(fmt, args);
+    va_end(args);
+    return ret;
+}
+
+int memset_s(void *dest, size_t dest_max, int c, size_t count)
+{
+    if (dest == NULL || count > dest_max) {
+        return -1;
+    }
+    memset(dest, c, count);
+    return 0;
+}
+
+void IoTWatchDogDisable(void)
+{
+}
+
+void start_udp_thread(void)
+{
+}
+
+// 没有客户端，回发的消息只在日志中显示
+int udp_report(const char *text)
+{
+    sim_printf("[udp] %s\n", text);
+    return 0;
+}
+
+/* ---------------- GPIO ---------------- */
+
+hi_u32 hi_io_set_func(int id, hi_u8 val)
+{
+    (void)id;
+    (void)val;
+    return 0;
+}
+
+hi_u32 hi_io_set_pull(int id, int val)
+{
+    (void)id;
+    (void)val;
+    return 0;
+}
+
+unsigned int IoTGpioInit(unsigned int id)
+{
+    (void)id;
+    return IOT_SUCCESS;
+}
+
+unsigned int IoTGpioSetDir(unsigned int id, IotGpioDir dir)
+{
+    (void)id;
+    (void)dir;
+    return IOT_SUCCESS;
+}
+
+unsigned int IoTGpioSetOutputVal(unsigned int id, IotGpioValue val)
+{
+    world_gpio_write(id, val == IOT_GPIO_VALUE1);
+    return IOT_SUCCESS;
+}
+
+unsigned int IoTGpioGetInputVal(unsigned int id, IotGpioValue *val)
+{
+    *val = world_gpio_read(id) ? IOT_GPIO_VALUE1 : IOT_GPIO_VALUE0;
+    return IOT_SUCCESS;
+}
+
+unsigned int IoTGpioRegisterIsrFunc(unsigned int id, IotGpioIntType intType, IotGpioIntPolarity intPolarity,
+                                    GpioIsrCallbackFunc func, char *arg)
+{
+    // 只有GPIO5按键有中断，按键序列由场景给出
+    (void)intType;
+    (void)intPolarity;
+    if (id == 5) {
+        g_gpio5_isr = func;
+        g_gpio5_isr_arg = arg;
+    }
+    return IOT_SUCCESS;
+}
+
+/* ---------------- PWM ---------------- */
+
+// 电机两端平均电压 = 占空比 * 电池电压，换算为标称电压下的等效占空比
+static void sim_pwm_apply(void)
+{
+    float scale = (g_battery_v > 0.0f) ? g_battery_v / SIM_BATTERY_NOMINAL : 1.0f;
+
+    world_set_wheels((g_pwm_duty[HI_PWM_PORT_PWM4] - g_pwm_duty[HI_PWM_PORT_PWM3]) * scale,
+                     (g_pwm_duty[HI_PWM_PORT_PWM1] - g_pwm_duty[HI_PWM_PORT_PWM0]) * scale);
+}
+
+hi_u32 hi_pwm_init(hi_pwm_port port)
+{
+    (void)port;
+    return 0;
+}
+
+hi_u32 hi_pwm_start(hi_pwm_port port, hi_u16 duty, hi_u16 freq)
+{
+    if (port >= HI_PWM_PORT_MAX || freq == 0) {
+        return 1;
+    }
+    // 占空比 = duty / freq，换算到与robot_l9110s.c相同的0~8000刻度
+    g_pwm_duty[port] = (float)duty / (float)freq * SIM_DUTY_FULL;
+    sim_pwm_apply();
+    return 0;
+}
+
+hi_u32 hi_pwm_stop(hi_pwm_port port)
+{
+    if (port >= HI_PWM_PORT_MAX) {
+        return 1;
+    }
+    g_pwm_duty[port] = 0.0f;
+    sim_pwm_apply();
+    return 0;
+}
+
+/* ---------------- ADC ---------------- */
+
+hi_u32 hi_adc_read(hi_adc_channel_index channel, hi_u16 *data, hi_adc_equ_model_sel equ_model,
+                   hi_adc_cur_bais cur_bais, hi_u16 delay_cnt)
+{
+    (void)equ_model;
+    (void)cur_bais;
+    (void)delay_cnt;
+    sim_busy_wait(SIM_ADC_READ_US);
+    if (channel == HI_ADC_CHANNEL_1) {
+        *data = (hi_u16)(g_battery_v / SIM_BATTERY_DIVIDER * 4096 / 7.2f);
+    } else {
+        *data = (channel == HI_ADC_CHANNEL_2) ? g_adc_code : SIM_ADC_IDLE_CODE;
+    }
+    return IOT_SUCCESS;
+}
@@ -0,0 +1,33 @@
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include "sim_world.h"
+
+// 按键未按下时ADC读数：3.3V上拉，码字 = 电压 * 4096 / (1.8 * 4)
+#define SIM_ADC_IDLE_CODE   (1877)
+#define SIM_ADC_READ_US     (100)       // 一次hi_adc_read的耗时：4次平均加0xF0个334ns的启动延时
+#define SIM_BATTERY_NOMINAL (7.4f)      // 电机模型假设的电池电压
+#define SIM_BATTERY_DIVIDER (3.0f)      // 电池分压比，与robot_battery.h一致
+
+/**
+ * @brief 复位外设状态
+ * @param verbose 非0时输出固件日志，带虚拟时间戳
+ */
+void sim_hal_init(int verbose);
+
+/**
+ * @brief 固件printf的替代实现，见hal/sim_prelude.h
+ */
+int sim_printf(const char *fmt, ...);
+
+/**
+ * @brief 按场景的按键序列依次按下/松开GPIO5按键，需在固件注册中断之前调用
+ */
+void sim_button_init(const SimButton *buttons, int count);
+
+/**
+ * @brief 设置电池电压，0表示没有接分压电路
+ */
+void sim_battery_init(float voltage);
+
+#endif // SIM_HAL_H
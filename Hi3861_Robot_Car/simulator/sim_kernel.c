@@ -0,0 +1,550 @@
+/*
+ * 仿真内核
+ * 功能：在主机上按虚拟时间运行固件任务和定时器回调
+ *       每个osThreadNew()任务是一个协程，阻塞调用切回调度器；
+ *       调度器每次选出最早到期的定时器或任务，推进时钟后执行，因此结果可复现
+ * 实现的接口：CMSIS-RTOS2任务/延时/事件/互斥锁，hi_time，hi_timer，hi_hrtimer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+#include "cmsis_os2.h"
+#include "hi_time.h"
+#include "hi_timer.h"
+#include "hi_hrtimer.h"
+
+#include "sim_kernel.h"
+
+#define SIM_MAX_THREADS     (16)
+#define SIM_MAX_TIMERS      (16)
+#define SIM_STACK_SIZE      (256 * 1024)    // 主机上printf等库函数比目标板占用更多栈
+
+typedef enum {
+    SIM_THREAD_FREE = 0,
+    SIM_THREAD_READY,       // 在wake_us时刻可运行
+    SIM_THREAD_WAIT,        // 等待事件，wake_us为超时时刻
+    SIM_THREAD_DONE
+} SimThreadState;
+
+typedef struct {
+    uint32_t flags;
+} SimEventFlags;
+
+typedef struct {
+    int owner;              // 持有者任务序号，-1表示空闲
+    unsigned int count;     // 递归持有次数
+} SimMutex;
+
+typedef struct {
+    SimThreadState state;
+    ucontext_t ctx;
+    void *stack;
+    osThreadFunc_t func;
+    void *arg;
+    int priority;
+    uint64_t wake_us;
+    uint64_t seq;               // 同一时刻可运行时先进先出
+    SimEventFlags *wait_ef;
+    uint32_t wait_flags;
+    uint32_t wait_options;
+    uint32_t wait_result;
+} SimThread;
+
+typedef struct {
+    int used;
+    int active;
+    uint64_t due_us;
+    uint64_t period_us;         // 0表示单次
+    void (*func)(hi_u32 data);
+    hi_u32 data;
+} SimTimer;
+
+static SimThread g_threads[SIM_MAX_THREADS];
+static SimTimer g_timers[SIM_MAX_TIMERS];
+static ucontext_t g_sched_ctx;
+static int g_current = -1;          // 正在运行的任务，-1表示调度器
+static int g_isr = 0;
+static uint64_t g_now_us = 0;
+static uint64_t g_seq = 0;
+static SimClockHook g_hook = NULL;
+
+void sim_kernel_init(SimClockHook hook)
+{
+    for (int i = 0; i < SIM_MAX_THREADS; i++) {
+        free(g_threads[i].stack);
+    }
+    memset(g_threads, 0, sizeof(g_threads));
+    memset(g_timers, 0, sizeof(g_timers));
+    g_current = -1;
+    g_isr = 0;
+    g_now_us = 0;
+    g_seq = 0;
+    g_hook = hook;
+}
+
+uint64_t sim_now_us(void)
+{
+    return g_now_us;
+}
+
+int sim_in_isr(void)
+{
+    return g_isr;
+}
+
+static SimTimer *sim_next_timer(void)
+{
+    SimTimer *next = NULL;
+
+    for (int i = 0; i < SIM_MAX_TIMERS; i++) {
+        SimTimer *t = &g_timers[i];
+        if (t->used && t->active && (next == NULL || t->due_us < next->due_us)) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+// 在中断上下文中执行定时器回调，回调内可以重新启动自身
+static void sim_fire_timer(SimTimer *t)
+{
+    if (t->period_us != 0) {
+        t->due_us += t->period_us;
+    } else {
+        t->active = 0;
+    }
+    g_isr = 1;
+    t->func(t->data);
+    g_isr = 0;
+}
+
+// 任务忙等期间，到期的定时器抢占执行
+static void sim_fire_due_timers(void)
+{
+    SimTimer *t;
+
+    if (g_isr) {
+        return;
+    }
+    while ((t = sim_next_timer()) != NULL && t->due_us <= g_now_us) {
+        sim_fire_timer(t);
+    }
+}
+
+void sim_busy_wait(uint32_t us)
+{
+    g_now_us += us;
+    sim_fire_due_timers();
+}
+
+// 当前任务阻塞到wake_us，切回调度器
+static void sim_block(uint64_t wake_us)
+{
+    SimThread *self = &g_threads[g_current];
+
+    self->wake_us = wake_us;
+    self->seq = g_seq++;
+    swapcontext(&self->ctx, &g_sched_ctx);
+}
+
+void sim_delay_us(uint64_t us)
+{
+    if (g_isr || g_current < 0) {
+        sim_busy_wait((uint32_t)us);
+        return;
+    }
+    g_threads[g_current].state = SIM_THREAD_READY;
+    sim_block(g_now_us + us);
+}
+
+static SimThread *sim_next_thread(void)
+{
+    SimThread *next = NULL;
+
+    for (int i = 0; i < SIM_MAX_THREADS; i++) {
+        SimThread *t = &g_threads[i];
+        if (t->state != SIM_THREAD_READY && t->state != SIM_THREAD_WAIT) {
+            continue;
+        }
+        if (t->wake_us == SIM_FOREVER) {
+            continue;
+        }
+        if (next == NULL || t->wake_us < next->wake_us ||
+            (t->wake_us == next->wake_us &&
+             (t->priority > next->priority || (t->priority == next->priority && t->seq < next->seq)))) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+int sim_kernel_run(uint64_t until_us, int (*done)(void))
+{
+    while (g_now_us < until_us) {
+        if (done != NULL && done()) {
+            return 1;
+        }
+
+        SimTimer *timer = sim_next_timer();
+        SimThread *thread = sim_next_thread();
+        uint64_t next = until_us;
+        if (timer != NULL && timer->due_us < next) {
+            next = timer->due_us;
+        }
+
+        if (thread != NULL && thread->wake_us < next) {
+            if (thread->wake_us > g_now_us) {
+                g_now_us = thread->wake_us;
+            }
+            if (thread->state == SIM_THREAD_WAIT) {
+                thread->state = SIM_THREAD_READY;
+                thread->wait_ef = NULL;
+                thread->wait_result = osFlagsErrorTimeout;
+            }
+            g_current = (int)(thread - g_threads);
+            swapcontext(&g_sched_ctx, &thread->ctx);
+            g_current = -1;
+        } else if (timer != NULL && timer->due_us <= next) {
+            if (timer->due_us > g_now_us) {
+                g_now_us = timer->due_us;
+            }
+            sim_fire_timer(timer);
+        } else {
+            g_now_us = until_us;
+        }
+
+        if (g_hook != NULL) {
+            g_hook(g_now_us);
+        }
+    }
+    return 0;
+}
+
+/* ---------------- CMSIS-RTOS2 ---------------- */
+
+static void sim_thread_entry(void)
+{
+    SimThread *self = &g_threads[g_current];
+
+    self->func(self->arg);
+    self->state = SIM_THREAD_DONE;      // 返回后由uc_link切回调度器
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr)
+{
+    for (int i = 0; i < SIM_MAX_THREADS; i++) {
+        SimThread *t = &g_threads[i];
+        if (t->state != SIM_THREAD_FREE) {
+            continue;
+        }
+        t->stack = malloc(SIM_STACK_SIZE);
+        if (t->stack == NULL) {
+            return NULL;
+        }
+        getcontext(&t->ctx);
+        t->ctx.uc_stack.ss_sp = t->stack;
+        t->ctx.uc_stack.ss_size = SIM_STACK_SIZE;
+        t->ctx.uc_link = &g_sched_ctx;
+        makecontext(&t->ctx, sim_thread_entry, 0);
+        t->func = func;
+        t->arg = argument;
+        t->priority = (attr != NULL) ? (int)attr->priority : osPriorityNormal;
+        t->state = SIM_THREAD_READY;
+        t->wake_us = g_now_us;
+        t->seq = g_seq++;
+        return t;
+    }
+    return NULL;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    sim_delay_us((uint64_t)ticks * SIM_TICK_US);
+    return osOK;
+}
+
+uint32_t osKernelGetTickCount(void)
+{
+    return (uint32_t)(g_now_us / SIM_TICK_US);
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return 1000000 / SIM_TICK_US;
+}
+
+uint32_t osKernelGetSysTimerCount(void)
+{
+    // 与hi_get_us()一样，轮询计数视为忙等，避免死循环
+    sim_busy_wait(SIM_POLL_US);
+    return (uint32_t)(g_now_us * (SIM_SYSTIMER_HZ / 1000000));
+}
+
+uint32_t osKernelGetSysTimerFreq(void)
+{
+    return SIM_SYSTIMER_HZ;
+}
+
+osEventFlagsId_t osEventFlagsNew(const osEventFlagsAttr_t *attr)
+{
+    (void)attr;
+    return calloc(1, sizeof(SimEventFlags));
+}
+
+static int sim_flags_match(uint32_t current, uint32_t flags, uint32_t options)
+{
+    if (options & osFlagsWaitAll) {
+        return (current & flags) == flags;
+    }
+    return (current & flags) != 0;
+}
+
+uint32_t osEventFlagsSet(osEventFlagsId_t ef_id, uint32_t flags)
+{
+    SimEventFlags *ef = ef_id;
+
+    if (ef == NULL) {
+        return osFlagsErrorParameter;
+    }
+    ef->flags |= flags;
+    for (int i = 0; i < SIM_MAX_THREADS; i++) {
+        SimThread *t = &g_threads[i];
+        if (t->state != SIM_THREAD_WAIT || t->wait_ef != ef ||
+            !sim_flags_match(ef->flags, t->wait_flags, t->wait_options)) {
+            continue;
+        }
+        t->wait_result = ef->flags;
+        if (!(t->wait_options & osFlagsNoClear)) {
+            ef->flags &= ~t->wait_flags;
+        }
+        t->state = SIM_THREAD_READY;
+        t->wait_ef = NULL;
+        t->wake_us = g_now_us;
+        t->seq = g_seq++;
+    }
+    return ef->flags;
+}
+
+uint32_t osEventFlagsClear(osEventFlagsId_t ef_id, uint32_t flags)
+{
+    SimEventFlags *ef = ef_id;
+    uint32_t old;
+
+    if (ef == NULL) {
+        return osFlagsErrorParameter;
+    }
+    old = ef->flags;
+    ef->flags &= ~flags;
+    return old;
+}
+
+uint32_t osEventFlagsGet(osEventFlagsId_t ef_id)
+{
+    SimEventFlags *ef = ef_id;
+    return (ef != NULL) ? ef->flags : 0;
+}
+
+uint32_t osEventFlagsWait(osEventFlagsId_t ef_id, uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    SimEventFlags *ef = ef_id;
+
+    if (ef == NULL) {
+        return osFlagsErrorParameter;
+    }
+    if (sim_flags_match(ef->flags, flags, options)) {
+        uint32_t result = ef->flags;
+        if (!(options & osFlagsNoClear)) {
+            ef->flags &= ~flags;
+        }
+        return result;
+    }
+    if (timeout == 0 || g_isr || g_current < 0) {
+        return osFlagsErrorResource;
+    }
+
+    SimThread *self = &g_threads[g_current];
+    self->state = SIM_THREAD_WAIT;
+    self->wait_ef = ef;
+    self->wait_flags = flags;
+    self->wait_options = options;
+    sim_block((timeout == osWaitForever) ? SIM_FOREVER : g_now_us + (uint64_t)timeout * SIM_TICK_US);
+    return self->wait_result;
+}
+
+osMutexId_t osMutexNew(const osMutexAttr_t *attr)
+{
+    SimMutex *m = calloc(1, sizeof(SimMutex));
+
+    (void)attr;
+    if (m != NULL) {
+        m->owner = -1;
+    }
+    return m;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    SimMutex *m = mutex_id;
+    uint64_t deadline = (timeout == osWaitForever) ? SIM_FOREVER : g_now_us + (uint64_t)timeout * SIM_TICK_US;
+
+    if (m == NULL || g_isr) {
+        return osErrorParameter;
+    }
+    // 协程不会被抢占，只有持有者阻塞时才会出现竞争，按tick轮询即可
+    while (m->owner >= 0 && m->owner != g_current) {
+        if (g_now_us >= deadline) {
+            return osErrorTimeout;
+        }
+        sim_delay_us(SIM_TICK_US);
+    }
+    m->owner = g_current;
+    m->count++;
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    SimMutex *m = mutex_id;
+
+    if (m == NULL || m->owner != g_current) {
+        return osErrorResource;
+    }
+    if (--m->count == 0) {
+        m->owner = -1;
+    }
+    return osOK;
+}
+
+/* ---------------- hi_time ---------------- */
+
+hi_void hi_udelay(hi_u32 us)
+{
+    sim_delay_us(us);
+}
+
+hi_u32 hi_get_tick(hi_void)
+{
+    return (hi_u32)(g_now_us / SIM_TICK_US);
+}
+
+hi_u64 hi_get_tick64(hi_void)
+{
+    return g_now_us / SIM_TICK_US;
+}
+
+hi_u32 hi_get_milli_seconds(hi_void)
+{
+    return (hi_u32)(g_now_us / 1000);
+}
+
+hi_u32 hi_get_seconds(hi_void)
+{
+    return (hi_u32)(g_now_us / 1000000);
+}
+
+hi_u64 hi_get_us(hi_void)
+{
+    // 固件用轮询hi_get_us()实现忙等，每次读取推进一点时间，避免死循环
+    sim_busy_wait(SIM_POLL_US);
+    return g_now_us;
+}
+
+hi_u32 hi_sleep(hi_u32 ms)
+{
+    sim_delay_us((uint64_t)ms * 1000);
+    return 0;
+}
+
+/* ---------------- hi_timer / hi_hrtimer ---------------- */
+
+static hi_u32 sim_timer_create(hi_u32 *id)
+{
+    for (hi_u32 i = 0; i < SIM_MAX_TIMERS; i++) {
+        if (!g_timers[i].used) {
+            memset(&g_timers[i], 0, sizeof(SimTimer));
+            g_timers[i].used = 1;
+            *id = i;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static hi_u32 sim_timer_start(hi_u32 id, uint64_t delay_us, uint64_t period_us,
+                              void (*func)(hi_u32), hi_u32 data)
+{
+    if (id >= SIM_MAX_TIMERS || !g_timers[id].used || func == NULL) {
+        return 1;
+    }
+    g_timers[id].active = 1;
+    g_timers[id].due_us = g_now_us + delay_us;
+    g_timers[id].period_us = period_us;
+    g_timers[id].func = func;
+    g_timers[id].data = data;
+    return 0;
+}
+
+static hi_u32 sim_timer_stop(hi_u32 id)
+{
+    if (id >= SIM_MAX_TIMERS || !g_timers[id].used) {
+        return 1;
+    }
+    g_timers[id].active = 0;
+    return 0;
+}
+
+static hi_u32 sim_timer_delete(hi_u32 id)
+{
+    if (id >= SIM_MAX_TIMERS || !g_timers[id].used) {
+        return 1;
+    }
+    g_timers[id].used = 0;
+    g_timers[id].active = 0;
+    return 0;
+}
+
+hi_u32 hi_timer_create(hi_u32 *timer_handle)
+{
+    return sim_timer_create(timer_handle);
+}
+
+hi_u32 hi_timer_start(hi_u32 timer_handle, hi_timer_type type, hi_u32 expire,
+                      hi_timer_callback_f timer_func, hi_u32 data)
+{
+    uint64_t delay_us = (uint64_t)expire * 1000;
+    return sim_timer_start(timer_handle, delay_us, (type == HI_TIMER_TYPE_PERIOD) ? delay_us : 0,
+                           timer_func, data);
+}
+
+hi_u32 hi_timer_stop(hi_u32 timer_handle)
+{
+    return sim_timer_stop(timer_handle);
+}
+
+hi_u32 hi_timer_delete(hi_u32 timer_handle)
+{
+    return sim_timer_delete(timer_handle);
+}
+
+hi_u32 hi_hrtimer_create(hi_u32 *timer_id)
+{
+    return sim_timer_create(timer_id);
+}
+
+hi_u32 hi_hrtimer_delete(hi_u32 timer_id)
+{
+    return sim_timer_delete(timer_id);
+}
+
+hi_u32 hi_hrtimer_start(hi_u32 timer_id, hi_u32 expire, hi_hrtimer_callback_f hrtimer_func, hi_u32 data)
+{
+    return sim_timer_start(timer_id, expire, 0, hrtimer_func, data);
+}
+
+hi_u32 hi_hrtimer_stop(hi_u32 timer_id)
+{
+    return sim_timer_stop(timer_id);
+}
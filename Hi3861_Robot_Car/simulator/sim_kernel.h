@@ -0,0 +1,48 @@
+#ifndef SIM_KERNEL_H
+#define SIM_KERNEL_H
+
+#include <stdint.h>
+
+// 仿真内核：用协程模拟CMSIS-RTOS2任务和SDK定时器，所有时间都是虚拟时间
+// 代码执行本身不耗时，只有延时、忙等和轮询hi_get_us()会推进时钟
+
+#define SIM_TICK_US         (10000)     // LiteOS-M系统tick为10ms
+#define SIM_POLL_US         (1)         // 每次读取hi_get_us()视为忙等1us
+#define SIM_SYSTIMER_HZ     (160000000) // 系统定时器按CPU主频160MHz计数
+#define SIM_FOREVER         UINT64_MAX
+
+// 时钟推进后的回调，用于按虚拟时间推进物理世界
+typedef void (*SimClockHook)(uint64_t now_us);
+
+/**
+ * @brief 初始化内核，清空任务和定时器
+ */
+void sim_kernel_init(SimClockHook hook);
+
+/**
+ * @brief 获取当前虚拟时间(us)
+ */
+uint64_t sim_now_us(void);
+
+/**
+ * @brief 当前是否在定时器回调(中断上下文)中
+ */
+int sim_in_isr(void);
+
+/**
+ * @brief 当前上下文忙等指定时间，期间到期的定时器照常触发
+ */
+void sim_busy_wait(uint32_t us);
+
+/**
+ * @brief 当前任务让出CPU指定时间，中断上下文中退化为忙等
+ */
+void sim_delay_us(uint64_t us);
+
+/**
+ * @brief 运行调度器直到虚拟时间到达until_us或done()返回非0
+ * @return 1-done()提前结束，0-到达时间上限
+ */
+int sim_kernel_run(uint64_t until_us, int (*done)(void));
+
+#endif // SIM_KERNEL_H
@@ -0,0 +1,359 @@
+/*
+ * 小车自主模式仿真器
+ * 功能：在主机上用真实的寻迹/避障固件代码驱动仿真小车跑一组场景，
+ *       输出每个场景的完成时间、碰撞次数、脱线次数和行驶路程，用于比较算法改动；
+ *       避障场景另外检查模式切换的最坏反应时间，超过SIM_AVOID_REACTION_MS时场景失败；
+ *       避障场景都会向障碍物靠近，碰撞时间估计始终没有给出接近速度时场景也失败；
+ *       直线驶向障碍物的场景还要求按接近速度的预估提前降低过占空比
+ * 用法：robot_sim [-v] [场景名...]，不带场景名时运行全部场景
+ *       每个场景在独立子进程中运行，固件全局状态互不影响
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "robot_control.h"
+#include "robot_lap.h"
+#include "robot_sched.h"
+
+#include "sim_hal.h"
+#include "sim_kernel.h"
+#include "sim_world.h"
+
+#define SIM_LINE_WIDTH_CM   (2.0f)      // 黑色胶带宽度
+#define SIM_FINISH_WIDTH_CM (3.0f)      // 终点横线宽度，两个红外传感器同时压线超过15ms即停车
+#define SIM_EXIT_MS         (500)       // 切回停止模式后留给固件退出的时间
+// 避障模式最坏反应时间上限：模式切换应在下一个tick生效，
+// 另外留出系统tick(10ms)取整和扫描任务测距抢占的余量，超出时场景判为失败
+#define SIM_AVOID_REACTION_MS   (AVOID_TICK_MS * 2)
+
+extern unsigned char g_car_status;
+extern void RobotCarDemo(void);
+
+/* ---------------- 场景 ---------------- */
+
+// 椭圆赛道：两段120cm直道和两个半径40cm的弯道，终点线在起点后方
+static void draw_oval(void)
+{
+    world_track_line(90, 60, 210, 60, SIM_LINE_WIDTH_CM);
+    world_track_line(90, 140, 210, 140, SIM_LINE_WIDTH_CM);
+    world_track_arc(210, 100, 40, -90, 90, SIM_LINE_WIDTH_CM);
+    world_track_arc(90, 100, 40, 90, 270, SIM_LINE_WIDTH_CM);
+    world_track_line(140, 52, 140, 68, SIM_FINISH_WIDTH_CM);
+}
+
+// S弯：直道、左弯、右弯、直道，终点线在末端
+static void draw_s_curve(void)
+{
+    world_track_line(20, 40, 100, 40, SIM_LINE_WIDTH_CM);
+    world_track_arc(100, 75, 35, -90, 0, SIM_LINE_WIDTH_CM);
+    world_track_arc(170, 75, 35, 90, 180, SIM_LINE_WIDTH_CM);
+    world_track_line(170, 110, 270, 110, SIM_LINE_WIDTH_CM);
+    world_track_line(250, 102, 250, 118, SIM_FINISH_WIDTH_CM);
+}
+
+// 连续跑3圈，第一圈学习赛道
+static void setup_laps(void)
+{
+    lap_set_target(3);
+}
+
+// 寻迹途中单击调速键(约1.0V)加速，再双击减速，按键处理不应打乱1ms红外采样
+static const SimButton g_speed_buttons[] = {
+    {3000, 150, 569},
+    {6000, 100, 569},
+    {6200, 100, 569},
+};
+
+// 从停止模式出发，按住模式键(约0.15V)2秒：0.8秒时长按急停，1.8秒时选中寻迹，松开后直接进入寻迹模式
+static const SimButton g_select_buttons[] = {
+    {500, 2000, 85},
+};
+
+static const SimPoint g_oval_box[] = {{200, 50}, {215, 50}, {215, 70}, {200, 70}};
+static const SimPolygon g_oval_obstacles[] = {
+    {g_oval_box, 4},
+};
+
+// 走廊：两侧交错伸出的挡板
+static const SimPoint g_corridor_a[] = {{110, 0}, {130, 0}, {130, 55}, {110, 55}};
+static const SimPoint g_corridor_b[] = {{210, 65}, {230, 65}, {230, 120}, {210, 120}};
+static const SimPoint g_corridor_c[] = {{310, 0}, {330, 0}, {330, 55}, {310, 55}};
+static const SimPolygon g_corridor_obstacles[] = {
+    {g_corridor_a, 4},
+    {g_corridor_b, 4},
+    {g_corridor_c, 4},
+};
+
+// 正前方一堵墙，两侧留出通道
+static const SimPoint g_wall[] = {{145, 70}, {155, 70}, {155, 230}, {145, 230}};
+static const SimPoint g_wall_post[] = {{60, 220}, {75, 220}, {75, 235}, {60, 235}};
+static const SimPolygon g_wall_obstacles[] = {
+    {g_wall, 4},
+    {g_wall_post, 4},
+};
+
+// 正前方一堵贯通场地的墙，小车只能直线驶近后再后退转向
+static const SimPoint g_approach_wall[] = {{200, 0}, {210, 0}, {210, 120}, {200, 120}};
+static const SimPolygon g_approach_obstacles[] = {
+    {g_approach_wall, 4},
+};
+
+static const SimScenario g_scenarios[] = {
+    {
+        .name = "trace_oval", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .time_limit_ms = 60000,
+    },
+    {
+        .name = "trace_s_curve", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 150,
+        .start_x = 30, .start_y = 40, .start_heading = 0,
+        .draw_track = draw_s_curve,
+        .goal_x = 250, .goal_y = 110, .goal_radius = 8, .goal_min_path = 150,
+        .time_limit_ms = 60000,
+    },
+    {
+        // 红外读数有2%随机翻转
+        .name = "trace_noisy", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .ir_flip_rate = 0.02f,
+        .time_limit_ms = 60000,
+    },
+    {
+        // 从终点线前出发，压线后连续跑3圈再停车，没有终点，圈速见日志
+        .name = "trace_laps", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 120, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval, .setup = setup_laps,
+        .time_limit_ms = 45000,
+    },
+    {
+        .name = "trace_button", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .buttons = g_speed_buttons, .button_count = 3,
+        .time_limit_ms = 60000,
+    },
+    {
+        .name = "trace_select", .mode = CAR_STOP_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .buttons = g_select_buttons, .button_count = 1,
+        .time_limit_ms = 60000,
+    },
+    {
+        // 电池接近亏电，车速按电压下降，固件应按电压补偿占空比
+        .name = "trace_low_batt", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .battery_v = 6.6f,
+        .time_limit_ms = 60000,
+    },
+    {
+        .name = "trace_full_batt", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .goal_x = 140, .goal_y = 60, .goal_radius = 8, .goal_min_path = 400,
+        .battery_v = 8.4f,
+        .time_limit_ms = 60000,
+    },
+    {
+        // 线上有障碍物，寻迹模式应在碰撞前停车，没有终点，跑满时间
+        .name = "trace_blocked", .mode = CAR_TRACE_STATUS,
+        .width_cm = 300, .height_cm = 200,
+        .start_x = 150, .start_y = 60, .start_heading = 0,
+        .draw_track = draw_oval,
+        .obstacles = g_oval_obstacles, .obstacle_count = 1,
+        .time_limit_ms = 15000,
+    },
+    {
+        .name = "avoid_corridor", .mode = CAR_OBSTACLE_AVOIDANCE_STATUS,
+        .width_cm = 420, .height_cm = 120,
+        .start_x = 30, .start_y = 60, .start_heading = 0,
+        .obstacles = g_corridor_obstacles, .obstacle_count = 3,
+        .goal_x = 390, .goal_y = 60, .goal_radius = 30,
+        .time_limit_ms = 90000,
+    },
+    {
+        .name = "avoid_wall", .mode = CAR_OBSTACLE_AVOIDANCE_STATUS,
+        .width_cm = 300, .height_cm = 300,
+        .start_x = 50, .start_y = 150, .start_heading = 0,
+        .obstacles = g_wall_obstacles, .obstacle_count = 2,
+        .goal_x = 250, .goal_y = 150, .goal_radius = 40,
+        .time_limit_ms = 120000,
+    },
+    {
+        .name = "avoid_approach", .mode = CAR_OBSTACLE_AVOIDANCE_STATUS,
+        .width_cm = 300, .height_cm = 120,
+        .start_x = 30, .start_y = 60, .start_heading = 0,
+        .obstacles = g_approach_obstacles, .obstacle_count = 1,
+        .expect_lookahead = 1,
+        .time_limit_ms = 8000,
+    },
+};
+
+#define SIM_SCENARIO_COUNT (sizeof(g_scenarios) / sizeof(g_scenarios[0]))
+
+/* ---------------- 运行 ---------------- */
+
+static void sim_hook(uint64_t now_us)
+{
+    world_advance(now_us);
+}
+
+static void sim_print_header(void)
+{
+    printf("%-16s %-6s %-8s %8s %10s %10s %9s %9s %9s %9s\n",
+           "scenario", "mode", "result", "time(s)", "collisions", "line-loss", "path(cm)", "react(ms)", "closing", "lookahead");
+}
+
+// 在子进程中运行单个场景并输出一行结果
+static int sim_run_scenario(const SimScenario *scenario, int verbose)
+{
+    SimReport report;
+    char line_losses[12] = "-";
+    char reaction[12] = "-";
+    char closing[12] = "-";
+    char lookahead[12] = "-";
+    int ret = 0;
+
+    sim_kernel_init(sim_hook);
+    sim_hal_init(verbose);
+    sim_button_init(scenario->buttons, scenario->button_count);
+    sim_battery_init(scenario->battery_v);
+    if (world_init(scenario) != 0) {
+        fprintf(stderr, "%s: world init failed\n", scenario->name);
+        return 1;
+    }
+
+    if (scenario->setup != NULL) {
+        scenario->setup();
+    }
+    g_car_status = (unsigned char)scenario->mode;
+    RobotCarDemo();
+    sim_kernel_run((uint64_t)scenario->time_limit_ms * 1000, world_finished);
+    world_get_report(&report);
+
+    // 切回停止模式，让固件执行退出流程并打印统计信息
+    g_car_status = CAR_STOP_STATUS;
+    sim_kernel_run(sim_now_us() + (uint64_t)SIM_EXIT_MS * 1000, NULL);
+    sched_report();
+
+    if (scenario->draw_track != NULL) {
+        snprintf(line_losses, sizeof(line_losses), "%d", report.line_losses);
+    }
+    const char *result = "timeout";
+    if (report.finished) {
+        result = "done";
+    } else if (scenario->goal_radius <= 0.0f) {
+        result = "limit";
+    }
+    if (scenario->mode == CAR_OBSTACLE_AVOIDANCE_STATUS) {
+        unsigned int latency = car_avoid_max_latency();
+        snprintf(reaction, sizeof(reaction), "%u", latency);
+        if (latency > SIM_AVOID_REACTION_MS) {
+            result = "slow";
+            ret = 1;
+        }
+        // 最大接近速度(cm/s)：为0说明0度分区的样本没能连成序列，按距离减速的预估不起作用
+        float max_closing = car_avoid_max_closing();
+        snprintf(closing, sizeof(closing), "%.1f", max_closing);
+        if (max_closing <= 0.0f) {
+            result = "no-ttc";
+            ret = 1;
+        }
+        // 预估生效的tick数：直线驶近障碍物时应比只看当前距离更早减速
+        unsigned int ahead_ticks = car_avoid_lookahead_ticks();
+        snprintf(lookahead, sizeof(lookahead), "%u", ahead_ticks);
+        if (scenario->expect_lookahead && ahead_ticks == 0) {
+            result = "no-ahead";
+            ret = 1;
+        }
+    }
+    printf("%-16s %-6s %-8s %8.2f %10d %10s %9.1f %9s %9s %9s\n", scenario->name,
+           (scenario->mode == CAR_OBSTACLE_AVOIDANCE_STATUS) ? "avoid" : "trace", result,
+           report.finished ? report.finish_s : scenario->time_limit_ms / 1000.0,
+           report.collisions, line_losses, report.path_cm, reaction, closing, lookahead);
+    return ret;
+}
+
+static void sim_usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-v] [scenario...]\n  scenarios:", prog);
+    for (unsigned int i = 0; i < SIM_SCENARIO_COUNT; i++) {
+        fprintf(stderr, " %s", g_scenarios[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+static int sim_selected(const SimScenario *scenario, int argc, char **argv, int first)
+{
+    if (first >= argc) {
+        return 1;
+    }
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], scenario->name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int verbose = 0;
+    int first = 1;
+    int failed = 0;
+
+    if (argc > 1 && strcmp(argv[1], "-v") == 0) {
+        verbose = 1;
+        first = 2;
+    } else if (argc > 1 && argv[1][0] == '-') {
+        sim_usage(argv[0]);
+        return 2;
+    }
+
+    sim_print_header();
+    fflush(stdout);
+    for (unsigned int i = 0; i < SIM_SCENARIO_COUNT; i++) {
+        const SimScenario *scenario = &g_scenarios[i];
+        int status = 0;
+
+        if (!sim_selected(scenario, argc, argv, first)) {
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            int ret = sim_run_scenario(scenario, verbose);
+            fflush(stdout);
+            _exit(ret);
+        }
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s: simulation failed\n", scenario->name);
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,165 @@
+/*
+ * 仿真OLED面板
+ * 功能：实现IoTI2cWrite()，按SSD1306的I2C协议解析控制字节、命令和显存数据，
+ *       维护一份面板显存，用来校验驱动实际送到屏上的内容；
+ *       每次传输按400kHz总线时间阻塞调用任务，并统计传输次数、字节数和总线占用
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iot_errno.h"
+#include "iot_i2c.h"
+
+#include "sim_kernel.h"
+#include "sim_oled.h"
+
+#define SIM_OLED_CTRL_CONT      (0x80)      // 控制字节Co位：后面只跟一个字节，然后是下一个控制字节
+#define SIM_OLED_CTRL_DATA      (0x40)      // 控制字节D/C#位：1-显存数据，0-命令
+
+typedef enum {
+    SIM_OLED_MODE_HORIZ = 0,    // 水平寻址：写满一列窗口换到下一页
+    SIM_OLED_MODE_VERT,         // 垂直寻址：固件不使用，按水平处理
+    SIM_OLED_MODE_PAGE          // 页寻址：上电默认，列地址在页内回绕
+} SimOledMode;
+
+static uint8_t g_ram[SIM_OLED_RAM_SIZE];
+static SimOledMode g_mode;
+static uint8_t g_col, g_col_start, g_col_end;
+static uint8_t g_page, g_page_start, g_page_end;
+static uint8_t g_cmd[3];            // 正在接收的命令及其参数
+static int g_cmd_len;
+static SimI2cStats g_stats;
+
+void sim_oled_init(void)
+{
+    srand(1);
+    for (int i = 0; i < SIM_OLED_RAM_SIZE; i++) {
+        g_ram[i] = (uint8_t)rand();
+    }
+    g_mode = SIM_OLED_MODE_PAGE;
+    g_col = g_col_start = 0;
+    g_col_end = SIM_OLED_WIDTH - 1;
+    g_page = g_page_start = 0;
+    g_page_end = SIM_OLED_PAGES - 1;
+    g_cmd_len = 0;
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+
+const uint8_t *sim_oled_ram(void)
+{
+    return g_ram;
+}
+
+void sim_oled_stats(SimI2cStats *stats)
+{
+    *stats = g_stats;
+}
+
+// 命令的参数个数，只列出固件用到的带参数命令
+static int sim_oled_cmd_args(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x21:  // 列地址窗口
+        case 0x22:  // 页地址窗口
+            return 2;
+        case 0x20:  // 寻址模式
+        case 0x81:  // 对比度
+        case 0x8D:  // 电荷泵
+        case 0xA8:  // 复用率
+        case 0xD3:  // 显示偏移
+        case 0xD5:  // 时钟分频
+        case 0xD9:  // 预充电周期
+        case 0xDA:  // COM引脚配置
+        case 0xDB:  // VCOMH
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void sim_oled_command(uint8_t byte)
+{
+    g_cmd[g_cmd_len++] = byte;
+    if (g_cmd_len <= sim_oled_cmd_args(g_cmd[0])) {
+        return;
+    }
+    g_cmd_len = 0;
+
+    uint8_t cmd = g_cmd[0];
+    if (cmd == 0x20) {
+        g_mode = (SimOledMode)(g_cmd[1] & 0x03);
+    } else if (cmd == 0x21) {
+        g_col_start = g_col = g_cmd[1] % SIM_OLED_WIDTH;
+        g_col_end = g_cmd[2] % SIM_OLED_WIDTH;
+    } else if (cmd == 0x22) {
+        g_page_start = g_page = g_cmd[1] % SIM_OLED_PAGES;
+        g_page_end = g_cmd[2] % SIM_OLED_PAGES;
+    } else if (cmd >= 0xB0 && cmd <= 0xB7) {
+        g_page = cmd & 0x07;
+    } else if (cmd <= 0x0F && g_mode == SIM_OLED_MODE_PAGE) {
+        g_col = (g_col & 0xF0) | cmd;
+    } else if (cmd >= 0x10 && cmd <= 0x1F && g_mode == SIM_OLED_MODE_PAGE) {
+        g_col = (uint8_t)(((cmd & 0x0F) << 4) | (g_col & 0x0F));
+    }
+}
+
+static void sim_oled_data(uint8_t byte)
+{
+    g_ram[g_page * SIM_OLED_WIDTH + g_col] = byte;
+    if (g_mode == SIM_OLED_MODE_PAGE) {
+        g_col = (g_col + 1) % SIM_OLED_WIDTH;
+        return;
+    }
+    if (g_col != g_col_end) {
+        g_col = (g_col + 1) % SIM_OLED_WIDTH;
+        return;
+    }
+    g_col = g_col_start;
+    g_page = (g_page == g_page_end) ? g_page_start : (g_page + 1) % SIM_OLED_PAGES;
+}
+
+static void sim_oled_byte(uint8_t ctrl, uint8_t byte)
+{
+    if (ctrl & SIM_OLED_CTRL_DATA) {
+        sim_oled_data(byte);
+    } else {
+        sim_oled_command(byte);
+    }
+}
+
+unsigned int IoTI2cInit(unsigned int id, unsigned int baudrate)
+{
+    (void)id;
+    (void)baudrate;
+    return IOT_SUCCESS;
+}
+
+unsigned int IoTI2cWrite(unsigned int id, unsigned short deviceAddr, const unsigned char *data, unsigned int dataLen)
+{
+    unsigned int i = 0;
+
+    (void)id;
+    (void)deviceAddr;
+    while (i < dataLen) {
+        uint8_t ctrl = data[i++];
+        if (ctrl & SIM_OLED_CTRL_CONT) {
+            // 单个字节，后面是下一个控制字节
+            if (i < dataLen) {
+                sim_oled_byte(ctrl, data[i++]);
+            }
+            continue;
+        }
+        // 最后一个控制字节，本次传输余下的都是同一类
+        for (; i < dataLen; i++) {
+            sim_oled_byte(ctrl, data[i]);
+        }
+    }
+
+    unsigned int us = (dataLen + 1) * SIM_I2C_BYTE_BITS * 1000000ULL / SIM_I2C_HZ + SIM_I2C_START_US;
+    g_stats.transfers++;
+    g_stats.bytes += dataLen + 1;
+    g_stats.busy_us += us;
+    sim_delay_us(us);
+    return IOT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+#ifndef SIM_OLED_H
+#define SIM_OLED_H
+
+#include <stdint.h>
+
+// SSD1306面板模型：128x64，8页，按I2C写入的命令和数据更新显存
+#define SIM_OLED_WIDTH      (128)
+#define SIM_OLED_PAGES      (8)
+#define SIM_OLED_RAM_SIZE   (SIM_OLED_WIDTH * SIM_OLED_PAGES)
+
+// I2C总线：400kHz，每字节8位数据加1位应答
+#define SIM_I2C_HZ          (400000)
+#define SIM_I2C_BYTE_BITS   (9)
+#define SIM_I2C_START_US    (20)        // 起始/停止条件和驱动调用开销
+
+typedef struct {
+    unsigned int transfers;     // IoTI2cWrite()次数
+    unsigned long long bytes;   // 上线字节数，含地址字节
+    unsigned long long busy_us; // 总线占用时间
+} SimI2cStats;
+
+/**
+ * @brief 复位面板：显存填入上电时的随机内容，清零总线统计
+ */
+void sim_oled_init(void);
+
+/**
+ * @brief 面板显存，按页排列，每页SIM_OLED_WIDTH字节，bit0为页内最上一行
+ */
+const uint8_t *sim_oled_ram(void);
+
+/**
+ * @brief 读取I2C总线统计
+ */
+void sim_oled_stats(SimI2cStats *stats);
+
+#endif // SIM_OLED_H
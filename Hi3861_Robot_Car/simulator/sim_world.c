@@ -0,0 +1,460 @@
+/*
+ * 仿真世界
+ * 功能：差速小车运动学、赛道位图、障碍物多边形和各传感器的物理模型，
+ *       同时统计碰撞、脱线、行驶路程和到达终点时间
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_hal.h"
+#include "sim_kernel.h"
+#include "sim_world.h"
+
+// 固件使用的GPIO
+#define SIM_GPIO_SERVO      (2)
+#define SIM_GPIO_TRIG       (7)
+#define SIM_GPIO_ECHO       (8)
+#define SIM_GPIO_IR_LEFT    (11)
+#define SIM_GPIO_IR_RIGHT   (12)
+
+#define SIM_MAX_EDGES       (256)
+#define SIM_DEG2RAD         (3.14159265f / 180.0f)
+
+typedef struct {
+    SimPoint a;
+    SimPoint b;
+} SimEdge;
+
+static const SimScenario *g_scenario = NULL;
+static SimEdge g_edges[SIM_MAX_EDGES];
+static int g_edge_count = 0;
+
+static unsigned char *g_track = NULL;   // 1-黑线
+static int g_track_w = 0;
+static int g_track_h = 0;
+
+// 小车状态
+static uint64_t g_world_us = 0;
+static float g_x = 0.0f;
+static float g_y = 0.0f;
+static float g_heading = 0.0f;          // 弧度
+static float g_left_duty = 0.0f;
+static float g_right_duty = 0.0f;
+static float g_left_speed = 0.0f;       // 实际轮速(cm/s)
+static float g_right_speed = 0.0f;
+static int g_in_contact = 0;
+
+// 舵机：按GPIO2脉宽解码目标角度，实际角度按固定转速追随
+static uint64_t g_servo_rise_us = 0;
+static float g_servo_target = 0.0f;
+static float g_servo_angle = 0.0f;
+
+// 超声波：触发下降沿时按当前位姿计算回响时间窗
+static uint64_t g_trig_rise_us = 0;
+static uint64_t g_echo_start_us = 0;
+static uint64_t g_echo_end_us = 0;
+static unsigned int g_noise_seed = 1;
+
+// 统计
+static SimReport g_report;
+static int g_line_lost = 0;
+static uint64_t g_line_check_us = 0;
+
+static void world_add_edge(float x0, float y0, float x1, float y1)
+{
+    if (g_edge_count >= SIM_MAX_EDGES) {
+        fprintf(stderr, "too many obstacle edges\n");
+        return;
+    }
+    g_edges[g_edge_count].a.x = x0;
+    g_edges[g_edge_count].a.y = y0;
+    g_edges[g_edge_count].b.x = x1;
+    g_edges[g_edge_count].b.y = y1;
+    g_edge_count++;
+}
+
+int world_init(const SimScenario *scenario)
+{
+    g_scenario = scenario;
+    g_edge_count = 0;
+    world_add_edge(0, 0, scenario->width_cm, 0);
+    world_add_edge(scenario->width_cm, 0, scenario->width_cm, scenario->height_cm);
+    world_add_edge(scenario->width_cm, scenario->height_cm, 0, scenario->height_cm);
+    world_add_edge(0, scenario->height_cm, 0, 0);
+    for (int i = 0; i < scenario->obstacle_count; i++) {
+        const SimPolygon *poly = &scenario->obstacles[i];
+        for (int j = 0; j < poly->count; j++) {
+            const SimPoint *a = &poly->points[j];
+            const SimPoint *b = &poly->points[(j + 1) % poly->count];
+            world_add_edge(a->x, a->y, b->x, b->y);
+        }
+    }
+
+    free(g_track);
+    g_track_w = (int)(scenario->width_cm * SIM_PX_PER_CM);
+    g_track_h = (int)(scenario->height_cm * SIM_PX_PER_CM);
+    g_track = calloc((size_t)g_track_w * g_track_h, 1);
+    if (g_track == NULL) {
+        return -1;
+    }
+    if (scenario->draw_track != NULL) {
+        scenario->draw_track();
+    }
+
+    g_world_us = 0;
+    g_x = scenario->start_x;
+    g_y = scenario->start_y;
+    g_heading = scenario->start_heading * SIM_DEG2RAD;
+    g_left_duty = g_right_duty = 0.0f;
+    g_left_speed = g_right_speed = 0.0f;
+    g_in_contact = 0;
+    g_servo_rise_us = 0;
+    g_servo_target = g_servo_angle = 0.0f;
+    g_trig_rise_us = g_echo_start_us = g_echo_end_us = 0;
+    g_noise_seed = 1;
+    memset(&g_report, 0, sizeof(g_report));
+    g_line_lost = 0;
+    g_line_check_us = 0;
+    return 0;
+}
+
+/* ---------------- 几何 ---------------- */
+
+static float world_segment_distance(float px, float py, const SimEdge *e)
+{
+    float dx = e->b.x - e->a.x;
+    float dy = e->b.y - e->a.y;
+    float len2 = dx * dx + dy * dy;
+    float t = (len2 > 0.0f) ? ((px - e->a.x) * dx + (py - e->a.y) * dy) / len2 : 0.0f;
+
+    if (t < 0.0f) {
+        t = 0.0f;
+    } else if (t > 1.0f) {
+        t = 1.0f;
+    }
+    float cx = e->a.x + t * dx - px;
+    float cy = e->a.y + t * dy - py;
+    return sqrtf(cx * cx + cy * cy);
+}
+
+static int world_collides(float x, float y)
+{
+    for (int i = 0; i < g_edge_count; i++) {
+        if (world_segment_distance(x, y, &g_edges[i]) < SIM_BODY_RADIUS_CM) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 射线与所有边求交，返回最近交点距离，没有交点时返回负值
+static float world_raycast(float ox, float oy, float angle)
+{
+    float dx = cosf(angle);
+    float dy = sinf(angle);
+    float best = -1.0f;
+
+    for (int i = 0; i < g_edge_count; i++) {
+        const SimEdge *e = &g_edges[i];
+        float ex = e->b.x - e->a.x;
+        float ey = e->b.y - e->a.y;
+        float denom = dx * ey - dy * ex;
+        if (fabsf(denom) < 1e-6f) {
+            continue;
+        }
+        float wx = e->a.x - ox;
+        float wy = e->a.y - oy;
+        float t = (wx * ey - wy * ex) / denom;     // 射线参数
+        float u = (wx * dy - wy * dx) / denom;     // 边参数
+        if (t >= 0.0f && u >= 0.0f && u <= 1.0f && (best < 0.0f || t < best)) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+/* ---------------- 赛道位图 ---------------- */
+
+static void world_track_set(int px, int py)
+{
+    if (px >= 0 && py >= 0 && px < g_track_w && py < g_track_h) {
+        g_track[(size_t)py * g_track_w + px] = 1;
+    }
+}
+
+static int world_track_black(float x, float y)
+{
+    int px = (int)(x * SIM_PX_PER_CM);
+    int py = (int)(y * SIM_PX_PER_CM);
+
+    if (px < 0 || py < 0 || px >= g_track_w || py >= g_track_h) {
+        return 0;
+    }
+    return g_track[(size_t)py * g_track_w + px];
+}
+
+void world_track_line(float x0, float y0, float x1, float y1, float width)
+{
+    SimEdge e = {{x0, y0}, {x1, y1}};
+    float half = width / 2.0f;
+    int px0 = (int)((fminf(x0, x1) - half) * SIM_PX_PER_CM);
+    int px1 = (int)((fmaxf(x0, x1) + half) * SIM_PX_PER_CM);
+    int py0 = (int)((fminf(y0, y1) - half) * SIM_PX_PER_CM);
+    int py1 = (int)((fmaxf(y0, y1) + half) * SIM_PX_PER_CM);
+
+    for (int py = py0; py <= py1; py++) {
+        for (int px = px0; px <= px1; px++) {
+            float cx = (px + 0.5f) / SIM_PX_PER_CM;
+            float cy = (py + 0.5f) / SIM_PX_PER_CM;
+            if (world_segment_distance(cx, cy, &e) <= half) {
+                world_track_set(px, py);
+            }
+        }
+    }
+}
+
+void world_track_arc(float cx, float cy, float radius, float from_deg, float to_deg, float width)
+{
+    float half = width / 2.0f;
+    float outer = radius + half;
+    float lo = fminf(from_deg, to_deg);
+    float hi = fmaxf(from_deg, to_deg);
+
+    for (int py = (int)((cy - outer) * SIM_PX_PER_CM); py <= (int)((cy + outer) * SIM_PX_PER_CM); py++) {
+        for (int px = (int)((cx - outer) * SIM_PX_PER_CM); px <= (int)((cx + outer) * SIM_PX_PER_CM); px++) {
+            float dx = (px + 0.5f) / SIM_PX_PER_CM - cx;
+            float dy = (py + 0.5f) / SIM_PX_PER_CM - cy;
+            if (fabsf(sqrtf(dx * dx + dy * dy) - radius) > half) {
+                continue;
+            }
+            // 角度归一化到[lo, lo+360)后判断是否在圆弧范围内
+            float deg = atan2f(dy, dx) / SIM_DEG2RAD;
+            while (deg < lo) {
+                deg += 360.0f;
+            }
+            while (deg >= lo + 360.0f) {
+                deg -= 360.0f;
+            }
+            if (deg <= hi) {
+                world_track_set(px, py);
+            }
+        }
+    }
+}
+
+/* ---------------- 物理推进 ---------------- */
+
+static float world_motor_speed(float duty)
+{
+    float magnitude = fabsf(duty);
+
+    if (magnitude <= SIM_MOTOR_DEADBAND) {
+        return 0.0f;
+    }
+    if (magnitude > SIM_DUTY_FULL) {
+        magnitude = SIM_DUTY_FULL;
+    }
+    float speed = (magnitude - SIM_MOTOR_DEADBAND) / (SIM_DUTY_FULL - SIM_MOTOR_DEADBAND) * SIM_MOTOR_SPEED_MAX;
+    return (duty > 0.0f) ? speed : -speed;
+}
+
+static void world_ir_position(int right, float *x, float *y)
+{
+    float side = right ? -SIM_IR_SPACING_CM / 2.0f : SIM_IR_SPACING_CM / 2.0f;
+    float c = cosf(g_heading);
+    float s = sinf(g_heading);
+
+    *x = g_x + c * SIM_IR_OFFSET_CM - s * side;
+    *y = g_y + s * SIM_IR_OFFSET_CM + c * side;
+}
+
+// 两红外传感器中点附近SIM_LINE_LOST_CM内没有黑线时视为脱线
+static void world_check_line(void)
+{
+    float x = g_x + cosf(g_heading) * SIM_IR_OFFSET_CM;
+    float y = g_y + sinf(g_heading) * SIM_IR_OFFSET_CM;
+    int r = (int)(SIM_LINE_LOST_CM * SIM_PX_PER_CM);
+    int cx = (int)(x * SIM_PX_PER_CM);
+    int cy = (int)(y * SIM_PX_PER_CM);
+    int near = 0;
+
+    for (int py = cy - r; py <= cy + r && !near; py++) {
+        for (int px = cx - r; px <= cx + r; px++) {
+            if (px >= 0 && py >= 0 && px < g_track_w && py < g_track_h &&
+                (px - cx) * (px - cx) + (py - cy) * (py - cy) <= r * r &&
+                g_track[(size_t)py * g_track_w + px]) {
+                near = 1;
+                break;
+            }
+        }
+    }
+    if (!near && !g_line_lost) {
+        g_report.line_losses++;
+        sim_printf("[sim] line lost at (%.1f, %.1f)\n", g_x, g_y);
+    }
+    g_line_lost = !near;
+}
+
+static void world_step(float dt)
+{
+    float k = dt * 1000.0f / SIM_MOTOR_TAU_MS;
+
+    if (k > 1.0f) {
+        k = 1.0f;
+    }
+    g_left_speed += (world_motor_speed(g_left_duty) - g_left_speed) * k;
+    g_right_speed += (world_motor_speed(g_right_duty) - g_right_speed) * k;
+
+    float v = (g_left_speed + g_right_speed) / 2.0f;
+    float w = (g_right_speed - g_left_speed) / SIM_WHEEL_TRACK_CM;
+    float heading = g_heading + w * dt;
+    float x = g_x + v * cosf(g_heading) * dt;
+    float y = g_y + v * sinf(g_heading) * dt;
+
+    // 碰撞时车身停在原位，电机堵转
+    if (world_collides(x, y)) {
+        if (!g_in_contact) {
+            g_report.collisions++;
+            g_in_contact = 1;
+        }
+        g_left_speed = g_right_speed = 0.0f;
+        g_heading = heading;
+    } else {
+        g_in_contact = 0;
+        g_x = x;
+        g_y = y;
+        g_heading = heading;
+        g_report.path_cm += fabsf(v) * dt;
+    }
+
+    float servo_step = SIM_SERVO_RATE * dt * 1000.0f;
+    if (fabsf(g_servo_target - g_servo_angle) <= servo_step) {
+        g_servo_angle = g_servo_target;
+    } else {
+        g_servo_angle += (g_servo_target > g_servo_angle) ? servo_step : -servo_step;
+    }
+}
+
+void world_advance(uint64_t now_us)
+{
+    while (g_world_us + SIM_STEP_US <= now_us) {
+        world_step(SIM_STEP_US / 1000000.0f);
+        g_world_us += SIM_STEP_US;
+
+        if (g_scenario->draw_track != NULL && g_world_us - g_line_check_us >= SIM_LINE_CHECK_US) {
+            g_line_check_us = g_world_us;
+            world_check_line();
+        }
+        if (!g_report.finished && g_scenario->goal_radius > 0.0f &&
+            g_report.path_cm >= g_scenario->goal_min_path &&
+            hypotf(g_x - g_scenario->goal_x, g_y - g_scenario->goal_y) <= g_scenario->goal_radius) {
+            g_report.finished = 1;
+            g_report.finish_s = g_world_us / 1000000.0;
+        }
+    }
+}
+
+void world_set_wheels(float left_duty, float right_duty)
+{
+    world_advance(sim_now_us());
+    g_left_duty = left_duty;
+    g_right_duty = right_duty;
+}
+
+/* ---------------- 传感器 ---------------- */
+
+static float world_noise(void)
+{
+    g_noise_seed = g_noise_seed * 1103515245u + 12345u;
+    return ((g_noise_seed >> 16) & 0x7FFF) / 16383.5f - 1.0f;
+}
+
+// 触发结束时按舵机实际角度计算回响时间窗
+static void world_sonar_trigger(uint64_t now)
+{
+    float angle = g_heading + g_servo_angle * SIM_DEG2RAD;
+    float ox = g_x + cosf(g_heading) * SIM_SONAR_OFFSET_CM;
+    float oy = g_y + sinf(g_heading) * SIM_SONAR_OFFSET_CM;
+    float best = -1.0f;
+    static const float cone[] = {0.0f, -SIM_SONAR_CONE_DEG, SIM_SONAR_CONE_DEG};
+
+    for (unsigned int i = 0; i < sizeof(cone) / sizeof(cone[0]); i++) {
+        float d = world_raycast(ox, oy, angle + cone[i] * SIM_DEG2RAD);
+        if (d >= 0.0f && (best < 0.0f || d < best)) {
+            best = d;
+        }
+    }
+
+    g_echo_start_us = now + SIM_SONAR_DELAY_US;
+    if (best < 0.0f || best > SIM_SONAR_RANGE_CM) {
+        g_echo_end_us = g_echo_start_us + SIM_SONAR_NO_ECHO_US;
+        return;
+    }
+    best += world_noise() * SIM_SONAR_NOISE_CM;
+    if (best < 2.0f) {
+        best = 2.0f;        // HC-SR04盲区
+    }
+    g_echo_end_us = g_echo_start_us + (uint64_t)(best * 2.0f / SIM_SOUND_CM_PER_US);
+}
+
+void world_gpio_write(unsigned int gpio, int level)
+{
+    uint64_t now = sim_now_us();
+
+    world_advance(now);
+    if (gpio == SIM_GPIO_TRIG) {
+        if (level) {
+            g_trig_rise_us = now;
+        } else if (g_trig_rise_us != 0 && now - g_trig_rise_us >= 10) {
+            world_sonar_trigger(now);
+            g_trig_rise_us = 0;
+        }
+    } else if (gpio == SIM_GPIO_SERVO) {
+        if (level) {
+            g_servo_rise_us = now;
+        } else if (g_servo_rise_us != 0) {
+            // 按SG90标称值解码：1500us居中，每度约11.1us，脉宽越小越向左
+            uint64_t width = now - g_servo_rise_us;
+            if (width >= 400 && width <= 2600) {
+                g_servo_target = (1500.0f - (float)width) * 90.0f / 1000.0f;
+            }
+            g_servo_rise_us = 0;
+        }
+    }
+}
+
+int world_gpio_read(unsigned int gpio)
+{
+    uint64_t now = sim_now_us();
+    float x;
+    float y;
+
+    world_advance(now);
+    switch (gpio) {
+        case SIM_GPIO_ECHO:
+            return now >= g_echo_start_us && now < g_echo_end_us;
+        case SIM_GPIO_IR_LEFT:
+        case SIM_GPIO_IR_RIGHT:
+            // 红外传感器在黑线上输出低电平
+            world_ir_position(gpio == SIM_GPIO_IR_RIGHT, &x, &y);
+            if (g_scenario->ir_flip_rate > 0.0f && (world_noise() + 1.0f) / 2.0f < g_scenario->ir_flip_rate) {
+                return world_track_black(x, y);
+            }
+            return !world_track_black(x, y);
+        default:
+            return 1;       // 按键等上拉输入默认高电平
+    }
+}
+
+int world_finished(void)
+{
+    return g_report.finished;
+}
+
+void world_get_report(SimReport *report)
+{
+    *report = g_report;
+}
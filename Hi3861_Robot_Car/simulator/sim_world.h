@@ -0,0 +1,125 @@
+#ifndef SIM_WORLD_H
+#define SIM_WORLD_H
+
+#include <stdint.h>
+
+// 小车几何参数(cm)，坐标系x向右、y向上，航向角逆时针为正
+#define SIM_WHEEL_TRACK_CM      (13.0f)     // 左右轮间距
+#define SIM_BODY_RADIUS_CM      (9.0f)      // 车身按圆形做碰撞检测
+#define SIM_SONAR_OFFSET_CM     (8.0f)      // 超声波模块在车身中心前方的距离
+#define SIM_IR_OFFSET_CM        (7.0f)      // 红外传感器在车身中心前方的距离
+#define SIM_IR_SPACING_CM       (3.0f)      // 左右红外传感器间距
+
+// 电机模型：稳定车速与占空比线性相关，低于死区不转，按一阶惯性响应
+// 参数是假设的模型，与robot_ttc.c对照表中同样未经实车测量的占位值一致：4000->22cm/s，6000->40cm/s，8000->55cm/s，
+// 仿真中的碰撞时间判定因此只验证了固件与自身假设的一致性，实车标定后两处需一起更新
+#define SIM_MOTOR_DEADBAND      (1500.0f)   // 死区占空比
+#define SIM_MOTOR_SPEED_MAX     (58.0f)     // 满占空比车速(cm/s)
+#define SIM_MOTOR_TAU_MS        (60.0f)     // 惯性时间常数
+#define SIM_DUTY_FULL           (8000.0f)
+
+// 传感器模型
+#define SIM_SONAR_RANGE_CM      (400.0f)    // 超出量程时回响保持高电平SIM_SONAR_NO_ECHO_US
+#define SIM_SONAR_NO_ECHO_US    (38000)
+#define SIM_SONAR_DELAY_US      (450)       // 触发到回响开始的延迟(发射8个40kHz脉冲)
+#define SIM_SONAR_CONE_DEG      (7.5f)      // 波束半角，按中心和两侧三条射线取最近值
+#define SIM_SONAR_NOISE_CM      (0.3f)      // 测距噪声幅度
+#define SIM_SOUND_CM_PER_US     (0.034f)
+#define SIM_SERVO_RATE          (0.5f)      // 舵机实际转速(度/ms)
+
+// 仿真步长和统计参数
+#define SIM_STEP_US             (1000)      // 物理积分步长
+#define SIM_PX_PER_CM           (4)         // 赛道位图分辨率
+#define SIM_LINE_CHECK_US       (10000)     // 脱线检查周期
+#define SIM_LINE_LOST_CM        (3.0f)      // 两红外传感器中点离黑线超过该距离视为脱线
+
+typedef struct {
+    float x;
+    float y;
+} SimPoint;
+
+// 障碍物多边形，首尾自动闭合
+typedef struct {
+    const SimPoint *points;
+    int count;
+} SimPolygon;
+
+// 一次按键：按下时触发GPIO5下降沿中断，按住期间ADC读数为adc_code
+typedef struct {
+    unsigned int at_ms;             // 按下时刻，按时间顺序排列
+    unsigned int hold_ms;           // 按住时长
+    unsigned short adc_code;        // 按住期间的ADC码字，码字 = 电压 * 4096 / (1.8 * 4)
+} SimButton;
+
+typedef struct {
+    const char *name;
+    int mode;                       // CarStatus，寻迹或避障
+    float width_cm;                 // 场地尺寸，四周自动加墙
+    float height_cm;
+    float start_x;
+    float start_y;
+    float start_heading;            // 初始航向(度)
+    void (*draw_track)(void);       // 在位图上绘制黑线，可为NULL
+    void (*setup)(void);            // 启动固件前调用，用于修改固件参数，可为NULL
+    const SimPolygon *obstacles;
+    int obstacle_count;
+    float goal_x;                   // 终点区域，半径为0表示没有终点，跑满时间上限
+    float goal_y;
+    float goal_radius;
+    float goal_min_path;            // 行驶距离超过该值后到达终点才算完成，用于绕圈赛道
+    float ir_flip_rate;             // 红外读数随机翻转的概率，模拟地面反光和杂色
+    const SimButton *buttons;       // 按键序列，可为NULL
+    float battery_v;                // 电池电压，车速按该电压/标称电压缩放；0表示没有接分压电路，车速不缩放
+    int button_count;
+    int expect_lookahead;           // 避障时直线驶向障碍物，要求按接近速度的预估提前减速过
+    unsigned int time_limit_ms;
+} SimScenario;
+
+typedef struct {
+    int finished;                   // 是否到达终点
+    double finish_s;                // 到达终点的时刻(s)
+    int collisions;                 // 碰撞次数
+    int line_losses;                // 脱线次数
+    double path_cm;                 // 车身中心行驶路程
+} SimReport;
+
+/**
+ * @brief 按场景初始化世界，包括赛道位图、障碍物和小车初始位姿
+ */
+int world_init(const SimScenario *scenario);
+
+/**
+ * @brief 把物理世界推进到指定时刻
+ */
+void world_advance(uint64_t now_us);
+
+/**
+ * @brief 设置左右轮占空比，正值前进，负值后退
+ */
+void world_set_wheels(float left_duty, float right_duty);
+
+/**
+ * @brief 固件输出GPIO电平，用于超声波触发和舵机脉冲
+ */
+void world_gpio_write(unsigned int gpio, int level);
+
+/**
+ * @brief 固件读取GPIO电平，用于超声波回响和红外传感器
+ */
+int world_gpio_read(unsigned int gpio);
+
+/**
+ * @brief 是否已到达终点
+ */
+int world_finished(void);
+
+/**
+ * @brief 获取统计结果
+ */
+void world_get_report(SimReport *report);
+
+// 赛道绘制工具，在draw_track回调中使用
+void world_track_line(float x0, float y0, float x1, float y1, float width);
+void world_track_arc(float cx, float cy, float radius, float from_deg, float to_deg, float width);
+
+#endif // SIM_WORLD_H